@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_BUFFER_CHAIN_HPP
+#define LESS_BUFFER_CHAIN_HPP
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "<less/buffer_chain.hpp> requires a POSIX system"
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <less/system_error.hpp>
+#include <less/vector.hpp>
+
+namespace less {
+
+// A sequence of byte buffers written out with a single `writev()` instead of
+// being concatenated first.
+//
+// Buffers are either owned, by moving a `less::vector<char>` in, or borrowed,
+// in which case the caller keeps them alive until they've been written. The
+// chain keeps an `iovec` for every unwritten buffer; `consume()` advances past
+// however many bytes a write took, trimming a partially written buffer in
+// place. Owned vectors that have been written out completely are cleared and
+// kept around so `acquire()` can hand their capacity back for the next
+// response.
+//
+struct buffer_chain {
+ public:
+  using size_type = unsigned_long_type;
+
+ private:
+  // `owned_[i]` backs `iov_[i]`, or is empty if that buffer is borrowed
+  //
+  vector<vector<char>> owned_;
+  vector<iovec>        iov_;
+  vector<vector<char>> spare_;
+
+  size_type head_  = 0u;
+  size_type bytes_ = 0u;
+
+  void drain_head() noexcept
+  {
+    auto& owned = owned_[head_];
+    if (owned.capacity() > 0 && spare_.size() < spare_.capacity()) {
+      owned.clear();
+      spare_.push_back(detail::move(owned));
+    }
+    else {
+      owned = vector<char>();
+    }
+    ++head_;
+  }
+
+  // Drops entries for buffers that were written out completely. Only done
+  // once they make up half of the chain so the cost is amortized.
+  //
+  void compact()
+  {
+    if (head_ == iov_.size()) {
+      iov_.clear();
+      owned_.clear();
+      head_ = 0u;
+      return;
+    }
+
+    if (head_ < 64u || 2 * head_ < iov_.size()) { return; }
+
+    iov_.erase(iov_.begin(), iov_.begin() + head_);
+    owned_.erase(owned_.begin(), owned_.begin() + head_);
+    head_ = 0u;
+  }
+
+  void push_iov(void const* p, size_type n)
+  {
+    auto io     = iovec();
+    io.iov_base = const_cast<void*>(p);
+    io.iov_len  = n;
+    iov_.push_back(io);
+  }
+
+ public:
+  // at most this many drained vectors are kept for `acquire()`
+  //
+  static constexpr size_type const max_spare = 16u;
+
+  buffer_chain()
+      : spare_(with_capacity, max_spare)
+  {
+  }
+
+  // Appends `v`, taking ownership of its storage. Empty vectors aren't
+  // written but their capacity is kept for `acquire()`.
+  //
+  void push_back(vector<char>&& v)
+  {
+    if (v.empty()) {
+      if (v.capacity() > 0 && spare_.size() < spare_.capacity()) {
+        spare_.push_back(detail::move(v));
+      }
+      return;
+    }
+
+    detail::grow_capacity(iov_, iov_.size() + 1);
+    detail::grow_capacity(owned_, owned_.size() + 1);
+
+    this->push_iov(v.data(), v.size());
+    owned_.push_back(detail::move(v));
+    bytes_ += owned_.back().size();
+  }
+
+  // Appends `n` bytes at `p` without copying them. They have to stay alive
+  // and unchanged until they've been consumed.
+  //
+  void borrow(void const* p, size_type n)
+  {
+    if (n == 0) { return; }
+
+    detail::grow_capacity(owned_, owned_.size() + 1);
+
+    this->push_iov(p, n);
+    owned_.push_back(vector<char>());
+    bytes_ += n;
+  }
+
+  void borrow(vector<char> const& v)
+  {
+    this->borrow(v.data(), v.size());
+  }
+
+  // An empty vector, reusing the capacity of a drained one when available.
+  //
+  auto acquire() noexcept -> vector<char>
+  {
+    if (spare_.empty()) { return vector<char>(); }
+
+    auto v = detail::move(spare_.back());
+    spare_.pop_back();
+    return v;
+  }
+
+  // Marks the first `n` unwritten bytes as written.
+  //
+  void consume(size_type n)
+  {
+    bytes_ -= n;
+    while (n > 0) {
+      auto& io = iov_[head_];
+      if (n < io.iov_len) {
+        io.iov_base = static_cast<char*>(io.iov_base) + n;
+        io.iov_len -= n;
+        break;
+      }
+
+      n -= io.iov_len;
+      this->drain_head();
+    }
+
+    this->compact();
+  }
+
+  // The unwritten buffers, ready to pass to `writev()` and friends. At most
+  // `IOV_MAX` of them can go into a single call.
+  //
+  auto iov() const noexcept -> iovec const*
+  {
+    return iov_.data() + head_;
+  }
+
+  auto iov_count() const noexcept -> size_type
+  {
+    return iov_.size() - head_;
+  }
+
+  // number of unwritten bytes
+  //
+  auto size() const noexcept -> size_type
+  {
+    return bytes_;
+  }
+
+  bool empty() const noexcept
+  {
+    return bytes_ == 0u;
+  }
+
+  // Writes as much as a single `writev()` takes and consumes it. Returns the
+  // number of bytes written, which is 0 if a non-blocking `fd` isn't ready.
+  //
+  auto write(int fd) -> size_type
+  {
+    return this->write_impl([&](iovec const* iov, int count) {
+      return ::writev(fd, iov, count);
+    });
+  }
+
+  // Same as `write()` using `pwritev()` at `offset`.
+  //
+  auto write(int fd, long_type offset) -> size_type
+  {
+    return this->write_impl([&](iovec const* iov, int count) {
+      return ::pwritev(fd, iov, count, static_cast<off_t>(offset));
+    });
+  }
+
+  // Drops every buffer, written or not. Owned ones are recycled.
+  //
+  void clear() noexcept
+  {
+    while (head_ < iov_.size()) {
+      this->drain_head();
+    }
+    iov_.clear();
+    owned_.clear();
+    head_  = 0u;
+    bytes_ = 0u;
+  }
+
+ private:
+  template <class F>
+  auto write_impl(F f) -> size_type
+  {
+    if (this->empty()) { return 0u; }
+
+    auto const count = this->iov_count();
+    auto const max   = static_cast<size_type>(IOV_MAX);
+
+    auto n = f(this->iov(), static_cast<int>(count < max ? count : max));
+    while (n < 0 && errno == EINTR) {
+      n = f(this->iov(), static_cast<int>(count < max ? count : max));
+    }
+
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) { return 0u; }
+      detail::throw_errno();
+    }
+
+    this->consume(static_cast<size_type>(n));
+    return static_cast<size_type>(n);
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_BUFFER_CHAIN_HPP
@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_CONCURRENT_VECTOR_HPP
+#define LESS_CONCURRENT_VECTOR_HPP
+
+#include <atomic>
+#include <mutex>
+
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+inline auto floor_log2(unsigned_long_type n) noexcept -> unsigned
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return 63u - static_cast<unsigned>(__builtin_clzll(n));
+#else
+  auto r = 0u;
+  while (n >>= 1) {
+    ++r;
+  }
+  return r;
+#endif
+}
+
+}    // namespace detail
+
+// A vector many threads can append to at once.
+//
+// Appending claims a range of indices with a single atomic `fetch_add()` and
+// constructs the elements in place, so threads never wait on each other.
+// Elements live in segments that double in size and are never moved once
+// allocated: segment `k` holds `first_segment_size << k` elements. A segment
+// is allocated by whichever thread first needs it; if several race, the
+// losers free their allocation and use the winner's.
+//
+// An element may be read from any thread once its `push_back()` or
+// `grow_by()` has returned and that is visible to the reader, e.g. because
+// the index was handed over through some other synchronization or the writers
+// were joined. `size()` counts claimed indices, which may include elements
+// still under construction while appends are in flight.
+//
+// Iteration, `clear()` and destruction must not race with appends. Elements
+// are reached one segment at a time through `segment()` or `for_each()`,
+// each segment being contiguous.
+//
+// If a constructor throws, the claimed indices stay empty. They're skipped on
+// destruction but must not be read, so such a vector shouldn't be iterated.
+//
+template <class T>
+struct concurrent_vector {
+ public:
+  using value_type      = T;
+  using size_type       = unsigned_long_type;
+  using difference_type = long_type;
+  using reference       = T&;
+  using const_reference = T const&;
+  using pointer         = T*;
+  using const_pointer   = T const*;
+
+ private:
+  static constexpr auto first_segment_shift() noexcept -> unsigned
+  {
+    auto shift = 0u;
+    while ((sizeof(T) << (shift + 1)) <= 4096u) {
+      ++shift;
+    }
+    return shift;
+  }
+
+ public:
+  // number of elements in segment 0; it spans up to a page
+  //
+  static constexpr size_type const first_segment_size =
+      size_type{1} << first_segment_shift();
+
+  static constexpr unsigned const max_segments = 64u - first_segment_shift();
+
+  struct span {
+    T*        first = nullptr;
+    size_type count = 0u;
+
+    auto begin() const noexcept -> T*
+    {
+      return first;
+    }
+
+    auto end() const noexcept -> T*
+    {
+      return first + count;
+    }
+
+    auto data() const noexcept -> T*
+    {
+      return first;
+    }
+
+    auto size() const noexcept -> size_type
+    {
+      return count;
+    }
+
+    bool empty() const noexcept
+    {
+      return count == 0u;
+    }
+  };
+
+ private:
+  alignas(64) std::atomic<size_type> size_{0u};
+  alignas(64) std::atomic<T*> segments_[max_segments] = {};
+
+  // ranges `[first, last)` whose construction threw
+  //
+  std::mutex        holes_m_;
+  vector<size_type> holes_;
+  std::atomic<bool> has_holes_{false};
+
+  static auto segment_of(size_type pos) noexcept -> unsigned
+  {
+    return detail::floor_log2((pos >> first_segment_shift()) + 1);
+  }
+
+  static auto segment_begin(unsigned k) noexcept -> size_type
+  {
+    return first_segment_size * ((size_type{1} << k) - 1);
+  }
+
+  static auto segment_size(unsigned k) noexcept -> size_type
+  {
+    return first_segment_size << k;
+  }
+
+  auto get_segment(unsigned k) -> T*
+  {
+    auto p = segments_[k].load(std::memory_order_acquire);
+    if (p) { return p; }
+
+    auto fresh =
+        static_cast<T*>(::operator new(segment_size(k) * sizeof(value_type)));
+    if (segments_[k].compare_exchange_strong(p, fresh,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_acquire)) {
+      return fresh;
+    }
+
+    ::operator delete(fresh);
+    return p;
+  }
+
+  auto slot(size_type pos) const noexcept -> T*
+  {
+    auto const k = segment_of(pos);
+    return segments_[k].load(std::memory_order_acquire) +
+           (pos - segment_begin(k));
+  }
+
+  void add_hole(size_type first, size_type last) noexcept
+  {
+    // losing track of a hole would later destroy garbage, so with no memory
+    // left to record it there's nothing sensible to do but terminate
+    //
+    auto lock = std::lock_guard<std::mutex>(holes_m_);
+    holes_.push_back(first);
+    holes_.push_back(last);
+    has_holes_.store(true, std::memory_order_relaxed);
+  }
+
+  // Constructs `[first, last)` with `f(T*)` one segment at a time, recording
+  // the whole range as a hole if a constructor throws.
+  //
+  template <class F>
+  void construct(size_type first, size_type last, F f)
+  {
+    if (first == last) { return; }
+
+    auto pos = first;
+    try {
+      auto k = segment_of(first);
+      while (pos < last) {
+        auto const seg = this->get_segment(k);
+        auto const end = segment_begin(k) + segment_size(k);
+        auto const n   = (last < end ? last : end);
+
+        for (; pos < n; ++pos) {
+          f(seg + (pos - segment_begin(k)));
+        }
+        ++k;
+      }
+    }
+    catch (...) {
+      for (auto i = first; i < pos; ++i) {
+        this->slot(i)->~T();
+      }
+      this->add_hole(first, last);
+      throw;
+    }
+  }
+
+  void destroy_all() noexcept
+  {
+    auto const size = size_.load(std::memory_order_relaxed);
+    if (!has_holes_.load(std::memory_order_relaxed)) {
+      this->for_each([](T& x) { x.~T(); });
+      return;
+    }
+
+    for (auto i = size_type{0}; i < size; ++i) {
+      auto hole = false;
+      for (auto j = size_type{0}; j < holes_.size(); j += 2) {
+        if (holes_[j] <= i && i < holes_[j + 1]) {
+          hole = true;
+          break;
+        }
+      }
+      if (!hole) { this->slot(i)->~T(); }
+    }
+  }
+
+ public:
+  concurrent_vector() noexcept
+  {
+  }
+
+  concurrent_vector(concurrent_vector const&) = delete;
+  auto operator=(concurrent_vector const&) -> concurrent_vector& = delete;
+
+  ~concurrent_vector()
+  {
+    this->destroy_all();
+    for (auto& s : segments_) {
+      ::operator delete(s.load(std::memory_order_relaxed));
+    }
+  }
+
+  // Element access
+
+  auto at(size_type const pos) -> reference
+  {
+    if (pos >= this->size()) { throw out_of_range{}; }
+
+    return *this->slot(pos);
+  }
+
+  auto at(size_type const pos) const -> const_reference
+  {
+    if (pos >= this->size()) { throw out_of_range{}; }
+
+    return *this->slot(pos);
+  }
+
+  auto operator[](size_type const pos) noexcept -> reference
+  {
+    return *this->slot(pos);
+  }
+
+  auto operator[](size_type const pos) const noexcept -> const_reference
+  {
+    return *this->slot(pos);
+  }
+
+  // Segments
+
+  // number of segments holding elements
+  //
+  auto segment_count() const noexcept -> unsigned
+  {
+    auto const size = this->size();
+    return size == 0u ? 0u : segment_of(size - 1) + 1;
+  }
+
+  // the elements of segment `k`; the last segment is usually partially used
+  //
+  auto segment(unsigned k) const noexcept -> span
+  {
+    auto const size  = this->size();
+    auto const first = segment_begin(k);
+    if (first >= size) { return span(); }
+
+    auto const last = first + segment_size(k);
+    return span{segments_[k].load(std::memory_order_acquire),
+                (size < last ? size : last) - first};
+  }
+
+  template <class F>
+  void for_each(F f) const
+  {
+    auto const count = this->segment_count();
+    for (auto k = 0u; k < count; ++k) {
+      for (auto& x : this->segment(k)) {
+        f(x);
+      }
+    }
+  }
+
+  // Capacity
+
+  bool empty() const noexcept
+  {
+    return this->size() == 0u;
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return size_.load(std::memory_order_acquire);
+  }
+
+  auto capacity() const noexcept -> size_type
+  {
+    auto cap = size_type{0};
+    for (auto k = 0u; k < max_segments; ++k) {
+      if (!segments_[k].load(std::memory_order_acquire)) { break; }
+      cap += segment_size(k);
+    }
+    return cap;
+  }
+
+  // Allocates the segments needed for `new_cap` elements up front so appends
+  // never have to. Safe to call concurrently with appends.
+  //
+  void reserve(size_type new_cap)
+  {
+    if (new_cap == 0u) { return; }
+
+    auto const last = segment_of(new_cap - 1);
+    for (auto k = 0u; k <= last; ++k) {
+      this->get_segment(k);
+    }
+  }
+
+  // Modifiers
+
+  // Destroys every element, keeping the segments for reuse.
+  //
+  void clear() noexcept
+  {
+    this->destroy_all();
+    size_.store(0u, std::memory_order_relaxed);
+    holes_.clear();
+    has_holes_.store(false, std::memory_order_relaxed);
+  }
+
+  // Appends and returns the new element's index.
+  //
+  auto push_back(T const& value) -> size_type
+  {
+    return this->emplace_back(value);
+  }
+
+  auto push_back(T&& value) -> size_type
+  {
+    return this->emplace_back(detail::move(value));
+  }
+
+  template <class... Args>
+  auto emplace_back(Args&&... args) -> size_type
+  {
+    auto const pos = size_.fetch_add(1u, std::memory_order_relaxed);
+    this->construct(pos, pos + 1, [&](T* p) {
+      new (p, detail::placement_tag_t{}) T(detail::forward<Args>(args)...);
+    });
+    return pos;
+  }
+
+  // Appends `count` value-initialized elements, contiguous in index space,
+  // and returns the index of the first.
+  //
+  auto grow_by(size_type count) -> size_type
+  {
+    auto const first = size_.fetch_add(count, std::memory_order_relaxed);
+    this->construct(first, first + count, [](T* p) {
+      new (p, detail::placement_tag_t{}) T();
+    });
+    return first;
+  }
+
+  auto grow_by(size_type count, T const& value) -> size_type
+  {
+    auto const first = size_.fetch_add(count, std::memory_order_relaxed);
+    this->construct(first, first + count, [&](T* p) {
+      new (p, detail::placement_tag_t{}) T(value);
+    });
+    return first;
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_CONCURRENT_VECTOR_HPP
@@ -0,0 +1,492 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_EXTERNAL_SORT_HPP
+#define LESS_EXTERNAL_SORT_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <less/external_vector.hpp>
+
+// Smallest buffer, in bytes, a run is read through while merging. Runs that
+// would get less of the memory budget are merged in several passes.
+//
+#ifndef LESS_EXTERNAL_SORT_MIN_BLOCK
+#define LESS_EXTERNAL_SORT_MIN_BLOCK (1u << 16)
+#endif
+
+namespace less {
+namespace detail {
+
+struct temp_file {
+  int fd = -1;
+
+  explicit temp_file(char const* dir)
+      : fd(open_temp_file(dir))
+  {
+  }
+
+  temp_file(temp_file const&) = delete;
+  auto operator=(temp_file const&) -> temp_file& = delete;
+
+  ~temp_file()
+  {
+    ::close(fd);
+  }
+};
+
+// Runs `pread()`s on a thread of its own, so merging carries on while the
+// next block of each run is read.
+//
+struct async_reader {
+  struct request {
+    int                fd     = -1;
+    void*              buf    = nullptr;
+    unsigned_long_type size   = 0u;
+    unsigned_long_type offset = 0u;
+    unsigned_long_type got    = 0u;
+    int                error  = 0;
+    bool               done   = true;
+    request*           next   = nullptr;
+  };
+
+ private:
+  std::mutex              m_;
+  std::condition_variable submitted_;
+  std::condition_variable completed_;
+  request*                head_ = nullptr;
+  request*                tail_ = nullptr;
+  bool                    stop_ = false;
+  std::thread             thread_;
+
+  void run()
+  {
+    auto lock = std::unique_lock<std::mutex>(m_);
+    while (true) {
+      submitted_.wait(lock, [&] { return stop_ || head_; });
+      if (!head_) { return; }
+
+      auto const r = head_;
+      head_        = r->next;
+      if (!head_) { tail_ = nullptr; }
+
+      lock.unlock();
+      auto       error = 0;
+      auto const got   = read_fully(r->fd, r->buf, r->size,
+                                    static_cast<long_type>(r->offset), error);
+      lock.lock();
+
+      r->got   = got;
+      r->error = error;
+      r->done  = true;
+      completed_.notify_all();
+    }
+  }
+
+ public:
+  async_reader()
+      : thread_([this] { this->run(); })
+  {
+  }
+
+  async_reader(async_reader const&) = delete;
+  auto operator=(async_reader const&) -> async_reader& = delete;
+
+  ~async_reader()
+  {
+    {
+      auto lock = std::lock_guard<std::mutex>(m_);
+      stop_     = true;
+    }
+    submitted_.notify_one();
+    thread_.join();
+  }
+
+  void submit(request& r)
+  {
+    {
+      auto lock = std::lock_guard<std::mutex>(m_);
+      r.done    = false;
+      r.error   = 0;
+      r.next    = nullptr;
+      if (tail_) { tail_->next = &r; }
+      else { head_ = &r; }
+      tail_ = &r;
+    }
+    submitted_.notify_one();
+  }
+
+  // waits for `r` to complete, throwing `less::system_error` if it failed
+  //
+  void wait(request& r)
+  {
+    auto lock = std::unique_lock<std::mutex>(m_);
+    completed_.wait(lock, [&] { return r.done; });
+    if (r.error != 0) { throw system_error{r.error}; }
+  }
+
+  // waits for `r` to complete, ignoring errors
+  //
+  void drain(request& r) noexcept
+  {
+    auto lock = std::unique_lock<std::mutex>(m_);
+    completed_.wait(lock, [&] { return r.done; });
+  }
+};
+
+// `count` sorted elements at byte `offset` of a run file
+//
+struct sorted_run {
+  unsigned_long_type offset = 0u;
+  unsigned_long_type count  = 0u;
+};
+
+// Reads a run through two buffers: while one is consumed, the next block is
+// read into the other.
+//
+template <class T>
+struct run_cursor {
+  async_reader*      reader = nullptr;
+  int                fd     = -1;
+  unsigned_long_type block  = 0u;
+
+  // byte offset and elements left of the part of the run not yet requested
+  //
+  unsigned_long_type next_offset = 0u;
+  unsigned_long_type left        = 0u;
+
+  vector<T>             bufs[2];
+  async_reader::request reqs[2];
+  T const*              cur    = nullptr;
+  T const*              end    = nullptr;
+  unsigned              active = 0u;
+
+  run_cursor() = default;
+
+  run_cursor(run_cursor const&) = delete;
+  auto operator=(run_cursor const&) -> run_cursor& = delete;
+
+  ~run_cursor()
+  {
+    if (reader) {
+      reader->drain(reqs[0]);
+      reader->drain(reqs[1]);
+    }
+  }
+
+  bool exhausted() const noexcept
+  {
+    return cur == end;
+  }
+
+  void request(unsigned i)
+  {
+    auto const n = (left < block ? left : block);
+    if (n == 0) { return; }
+
+    auto& r  = reqs[i];
+    r.fd     = fd;
+    r.buf    = bufs[i].data();
+    r.size   = n * sizeof(T);
+    r.offset = next_offset;
+    reader->submit(r);
+
+    next_offset += n * sizeof(T);
+    left -= n;
+  }
+
+  void start(async_reader& rd, int file, sorted_run run, unsigned_long_type b)
+  {
+    reader      = &rd;
+    fd          = file;
+    block       = b;
+    next_offset = run.offset;
+    left        = run.count;
+    bufs[0]     = vector<T>(default_init, block);
+    bufs[1]     = vector<T>(default_init, block);
+
+    this->request(0u);
+    this->request(1u);
+    this->take(0u);
+  }
+
+  // makes buffer `i` current once its read is done
+  //
+  void take(unsigned i)
+  {
+    // `size` is only ever written by this thread, and is 0 for a buffer with
+    // no read in flight
+    //
+    auto& r = reqs[i];
+    if (r.size == 0) {
+      cur = end = nullptr;
+      return;
+    }
+
+    reader->wait(r);
+    if (r.got != r.size) { throw format_error{}; }
+
+    active = i;
+    cur    = bufs[i].data();
+    end    = cur + r.size / sizeof(T);
+    r.size = 0u;
+  }
+
+  void advance()
+  {
+    if (++cur != end) { return; }
+
+    // the buffer just finished is free for the block after the next one
+    //
+    this->request(active);
+    this->take(active ^ 1u);
+  }
+};
+
+// Merges runs with a tree of losers: every inner node holds the run that lost
+// the comparison there, so replacing the winner replays only its path to the
+// root, log2(k) comparisons. Ties go to the lower run, which keeps the merge
+// stable.
+//
+template <class T, class Compare>
+struct loser_tree {
+  vector<run_cursor<T>>& runs;
+  Compare&               comp;
+  vector<unsigned>       tree;
+
+  loser_tree(vector<run_cursor<T>>& r, Compare& c)
+      : runs(r)
+      , comp(c)
+      , tree(r.size())
+  {
+    tree[0] = this->build(1u);
+  }
+
+  bool beats(unsigned a, unsigned b)
+  {
+    if (runs[a].exhausted()) { return false; }
+    if (runs[b].exhausted()) { return true; }
+    if (comp(*runs[b].cur, *runs[a].cur)) { return false; }
+    return comp(*runs[a].cur, *runs[b].cur) || a < b;
+  }
+
+  auto build(unsigned node) -> unsigned
+  {
+    auto const k = static_cast<unsigned>(runs.size());
+    if (node >= k) { return node - k; }
+
+    auto const a = this->build(2 * node);
+    auto const b = this->build(2 * node + 1);
+    if (this->beats(a, b)) {
+      tree[node] = b;
+      return a;
+    }
+    tree[node] = a;
+    return b;
+  }
+
+  auto winner() const noexcept -> unsigned
+  {
+    return tree[0];
+  }
+
+  bool empty() const noexcept
+  {
+    return runs[tree[0]].exhausted();
+  }
+
+  // advances the winning run and finds the new winner
+  //
+  void pop()
+  {
+    auto w = tree[0];
+    runs[w].advance();
+
+    auto const k = static_cast<unsigned>(runs.size());
+    for (auto node = (w + k) / 2; node > 0; node /= 2) {
+      if (this->beats(tree[node], w)) {
+        auto const t = tree[node];
+        tree[node]   = w;
+        w            = t;
+      }
+    }
+    tree[0] = w;
+  }
+};
+
+// Merges `runs[first, last)` of `fd`, handing every element to `out` in
+// order.
+//
+template <class T, class Compare, class Out>
+void merge_runs(async_reader& reader, int fd, sorted_run const* first,
+                sorted_run const* last, unsigned_long_type block,
+                Compare& comp, Out out)
+{
+  auto const k       = static_cast<unsigned_long_type>(last - first);
+  auto       cursors = vector<run_cursor<T>>(k);
+  for (auto i = 0u; first != last; ++first, ++i) {
+    cursors[i].start(reader, fd, *first, block);
+  }
+
+  auto tree = loser_tree<T, Compare>(cursors, comp);
+  while (!tree.empty()) {
+    out(*cursors[tree.winner()].cur);
+    tree.pop();
+  }
+}
+
+// Buffers elements into blocks written one after another from `offset`.
+//
+template <class T>
+struct run_writer {
+  int                fd;
+  unsigned_long_type offset;
+  vector<T>          buf;
+
+  void flush()
+  {
+    if (buf.empty()) { return; }
+
+    pwrite_fully(fd, buf.data(), buf.size() * sizeof(T), offset);
+    offset += buf.size() * sizeof(T);
+    buf.clear();
+  }
+
+  void push(T const& x)
+  {
+    buf.push_back(x);
+    if (buf.size() == buf.capacity()) { this->flush(); }
+  }
+};
+
+}    // namespace detail
+
+// Sorts `v` by `comp` using about `memory` bytes, however large `v` is.
+//
+// Runs of `memory / sizeof(T)` elements are read sequentially, sorted in
+// memory with `std::sort()` and written to an unnamed temporary file in `dir`
+// (or `$TMPDIR`, or `/tmp`). The runs are then merged k ways with a loser
+// tree into a new `less::external_vector` with `v`'s page settings, which is
+// swapped into `v` once complete, so `v` is left as it was if the sort
+// throws. Each run is read through two buffers, the next block of a run being
+// read on a background thread while the current one is merged, and the budget
+// is split evenly between those buffers. When that would give a run less than
+// `LESS_EXTERNAL_SORT_MIN_BLOCK` bytes, groups of runs are first merged into
+// longer ones in extra passes over a second temporary file.
+//
+// The merge is stable across runs but `std::sort()` isn't, so neither is the
+// sort. The pages `v` keeps resident, and those of the vector merged into,
+// come on top of `memory`.
+//
+template <class T, class Compare>
+void external_sort(external_vector<T>& v, unsigned_long_type memory,
+                   Compare comp, char const* dir = nullptr)
+{
+  using size_type = unsigned_long_type;
+
+  auto const n = v.size();
+  if (n < 2) { return; }
+
+  auto run_size = memory / sizeof(T);
+  if (run_size < 2) { run_size = 2; }
+  if (run_size > n) { run_size = n; }
+
+  auto files = detail::temp_file(dir);
+  auto spare = detail::temp_file(dir);
+
+  // sorted runs
+  //
+  auto runs = vector<detail::sorted_run>();
+  {
+    auto buf    = vector<T>(with_capacity, run_size);
+    auto offset = size_type{0};
+
+    auto write_run = [&] {
+      std::sort(buf.begin(), buf.end(), comp);
+      detail::pwrite_fully(files.fd, buf.data(), buf.size() * sizeof(T),
+                           offset);
+
+      detail::grow_capacity(runs, runs.size() + 1);
+      runs.push_back(detail::sorted_run{offset, buf.size()});
+      offset += buf.size() * sizeof(T);
+      buf.clear();
+    };
+
+    v.for_each([&](T const& x) {
+      buf.push_back(x);
+      if (buf.size() == run_size) { write_run(); }
+    });
+    if (!buf.empty()) { write_run(); }
+  }
+
+  // every run gets two buffers, plus one for the output
+  //
+  auto const min_block = (LESS_EXTERNAL_SORT_MIN_BLOCK + sizeof(T) - 1) /
+                         sizeof(T);
+
+  auto const budget    = (memory / sizeof(T) > 5 * min_block
+                               ? memory / sizeof(T)
+                               : 5 * min_block);
+  auto const fan_in    = (budget / min_block - 1) / 2;
+  auto const block_for = [&](size_type k) { return budget / (2 * k + 1); };
+
+  auto reader = detail::async_reader();
+
+  auto in  = files.fd;
+  auto out = spare.fd;
+  while (runs.size() > fan_in) {
+    auto merged = vector<detail::sorted_run>();
+    merged.reserve((runs.size() + fan_in - 1) / fan_in);
+
+    auto const block  = block_for(fan_in);
+    auto       writer = detail::run_writer<T>{out, 0u,
+                                        vector<T>(with_capacity, block)};
+    for (auto i = size_type{0}; i < runs.size(); i += fan_in) {
+      auto const last   = (i + fan_in < runs.size() ? i + fan_in : runs.size());
+      auto const offset = writer.offset;
+
+      auto count = size_type{0};
+      for (auto j = i; j < last; ++j) {
+        count += runs[j].count;
+      }
+
+      detail::merge_runs<T>(reader, in, runs.data() + i, runs.data() + last,
+                            block, comp,
+                            [&](T const& x) { writer.push(x); });
+      writer.flush();
+      merged.push_back(detail::sorted_run{offset, count});
+    }
+
+    runs = detail::move(merged);
+
+    auto const tmp = in;
+    in             = out;
+    out            = tmp;
+  }
+
+  auto sorted =
+      external_vector<T>(v.max_resident(), v.page_size() * sizeof(T), dir);
+  detail::merge_runs<T>(reader, in, runs.data(), runs.data() + runs.size(),
+                        block_for(runs.size()), comp,
+                        [&](T const& x) { sorted.push_back(x); });
+  v.swap(sorted);
+}
+
+template <class T>
+void external_sort(external_vector<T>& v, unsigned_long_type memory)
+{
+  less::external_sort(v, memory, std::less<>());
+}
+
+}    // namespace less
+
+#endif    // LESS_EXTERNAL_SORT_HPP
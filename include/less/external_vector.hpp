@@ -0,0 +1,506 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_EXTERNAL_VECTOR_HPP
+#define LESS_EXTERNAL_VECTOR_HPP
+
+#if !defined(__linux__)
+#error "<less/external_vector.hpp> is only supported on Linux"
+#endif
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#include <less/io.hpp>
+#include <less/system_error.hpp>
+#include <less/vector.hpp>
+
+// Size of a page of `less::external_vector` when none is given, in bytes.
+//
+#ifndef LESS_EXTERNAL_PAGE_SIZE
+#define LESS_EXTERNAL_PAGE_SIZE (1u << 20)
+#endif
+
+namespace less {
+namespace detail {
+
+// An unnamed temporary file in `dir`, or in `$TMPDIR` or `/tmp` when that's
+// null, which disappears with its last descriptor.
+//
+inline auto open_temp_file(char const* dir) -> int
+{
+  if (!dir) { dir = std::getenv("TMPDIR"); }
+  if (!dir || !*dir) { dir = "/tmp"; }
+
+  auto fd = ::open(dir, O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+  if (fd != -1) { return fd; }
+
+  // file systems without `O_TMPFILE` get a named file that's unlinked
+  // right away
+  //
+  auto const len  = std::strlen(dir);
+  auto       path = vector<char>(default_init, len + sizeof("/less_XXXXXX"));
+  std::memcpy(path.data(), dir, len);
+  std::memcpy(path.data() + len, "/less_XXXXXX", sizeof("/less_XXXXXX"));
+
+  fd = ::mkostemp(path.data(), O_CLOEXEC);
+  if (fd == -1) { detail::throw_errno(); }
+
+  ::unlink(path.data());
+  return fd;
+}
+
+}    // namespace detail
+
+// Counters of how an `external_vector`'s page cache is doing.
+//
+struct external_stats {
+  // accesses to a page that wasn't resident and had to be read back
+  //
+  std::uint64_t faults = 0;
+
+  // pages dropped from memory to make room, and how many of them had to be
+  // written out first
+  //
+  std::uint64_t evictions       = 0;
+  std::uint64_t dirty_evictions = 0;
+
+  // full pages written out early by `push_back()`
+  //
+  std::uint64_t write_behinds = 0;
+
+  // pages hinted to the kernel ahead of a sequential scan
+  //
+  std::uint64_t read_aheads = 0;
+};
+
+// A vector of trivially copyable `T` that can grow past the memory it's
+// allowed to use.
+//
+// Elements are kept in fixed-size pages. At most `max_resident` of them are in
+// memory at a time, in frames reused in least-recently-used order; the rest
+// live in an unnamed temporary file. Touching a page that isn't resident is a
+// fault: the least recently used frame is written out if it's dirty and the
+// page is read into it.
+//
+// `push_back()` writes every page it fills right away and starts the kernel's
+// writeback of it with `sync_file_range()`, so the frame is clean, and free to
+// evict, by the time it's needed again. Faulting pages in ascending order, as
+// `for_each()` does, is detected as a sequential scan and asks the kernel to
+// read the next pages ahead with `posix_fadvise()`.
+//
+// Element access returns copies, since any access may evict the page a
+// reference would point into.
+//
+template <class T>
+struct external_vector {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "less::external_vector requires a trivially copyable type");
+
+ public:
+  using value_type = T;
+  using size_type  = unsigned_long_type;
+
+  // pages read ahead once a scan is detected
+  //
+  static constexpr size_type const read_ahead_pages = 4u;
+
+ private:
+  static constexpr unsigned const  none    = ~0u;
+  static constexpr size_type const no_page = ~size_type{0};
+
+  struct frame {
+    vector<T> elems;
+    size_type page  = no_page;
+    unsigned  prev  = none;
+    unsigned  next  = none;
+    bool      dirty = false;
+  };
+
+  int       fd_           = -1;
+  size_type page_size_    = 0u;
+  size_type max_resident_ = 0u;
+  size_type size_         = 0u;
+
+  // pages that were written to the file at least once
+  //
+  size_type stored_pages_ = 0u;
+
+  vector<frame>    frames_;
+  vector<unsigned> page_table_;
+
+  // most and least recently used frames
+  //
+  unsigned mru_ = none;
+  unsigned lru_ = none;
+
+  // the last page faulted in, and the first one past those hinted for
+  // read-ahead
+  //
+  size_type      last_fault_ = ~size_type{0};
+  size_type      ahead_      = 0u;
+  external_stats stats_;
+
+  auto page_bytes() const noexcept -> size_type
+  {
+    return page_size_ * sizeof(T);
+  }
+
+  // elements in use on page `p`
+  //
+  auto page_count(size_type p) const noexcept -> size_type
+  {
+    auto const first = p * page_size_;
+    return (size_ - first < page_size_ ? size_ - first : page_size_);
+  }
+
+  void unlink(unsigned f) noexcept
+  {
+    auto& fr = frames_[f];
+    if (fr.prev != none) { frames_[fr.prev].next = fr.next; }
+    else { mru_ = fr.next; }
+    if (fr.next != none) { frames_[fr.next].prev = fr.prev; }
+    else { lru_ = fr.prev; }
+
+    fr.prev = none;
+    fr.next = none;
+  }
+
+  void link_front(unsigned f) noexcept
+  {
+    auto& fr = frames_[f];
+    fr.prev  = none;
+    fr.next  = mru_;
+    if (mru_ != none) { frames_[mru_].prev = f; }
+    mru_ = f;
+    if (lru_ == none) { lru_ = f; }
+  }
+
+  void touch(unsigned f) noexcept
+  {
+    if (mru_ == f) { return; }
+    this->unlink(f);
+    this->link_front(f);
+  }
+
+  void write_page(frame& fr)
+  {
+    detail::pwrite_fully(fd_, fr.elems.data(),
+                         this->page_count(fr.page) * sizeof(T),
+                         fr.page * this->page_bytes());
+    if (fr.page >= stored_pages_) { stored_pages_ = fr.page + 1; }
+    fr.dirty = false;
+  }
+
+  // a frame for page `p`, which the caller fills
+  //
+  auto take_frame(size_type p) -> unsigned
+  {
+    auto f = lru_;
+    if (frames_.size() < max_resident_) {
+      detail::grow_capacity(frames_, frames_.size() + 1);
+      frames_.push_back(frame{vector<T>(default_init, page_size_)});
+      f = static_cast<unsigned>(frames_.size() - 1);
+    }
+    else {
+      auto& victim = frames_[f];
+      if (victim.dirty && victim.page != no_page) {
+        this->write_page(victim);
+        ++stats_.dirty_evictions;
+      }
+      ++stats_.evictions;
+
+      if (victim.page != no_page) { page_table_[victim.page] = none; }
+      this->unlink(f);
+    }
+
+    frames_[f].page  = p;
+    frames_[f].dirty = false;
+    page_table_[p]   = f;
+    this->link_front(f);
+    return f;
+  }
+
+  // the frame holding page `p`, reading it in if needed
+  //
+  auto fault_in(size_type p) -> frame&
+  {
+    auto f = page_table_[p];
+    if (f != none) {
+      this->touch(f);
+      return frames_[f];
+    }
+
+    ++stats_.faults;
+    if (p == last_fault_ + 1) { this->read_ahead(p + 1); }
+    else { ahead_ = 0u; }
+    last_fault_ = p;
+
+    f        = this->take_frame(p);
+    auto& fr = frames_[f];
+    if (p < stored_pages_) {
+      auto const bytes = this->page_count(p) * sizeof(T);
+
+      auto       error = 0;
+      auto const n     = detail::read_fully(
+          fd_, fr.elems.data(), bytes,
+          static_cast<long_type>(p * this->page_bytes()), error);
+      if (error != 0) {
+        page_table_[p] = none;
+        this->unlink(f);
+        this->link_lru(f);
+        throw system_error{error};
+      }
+      if (n < bytes) {
+        std::memset(reinterpret_cast<unsigned char*>(fr.elems.data()) + n, 0,
+                    bytes - n);
+      }
+    }
+    return fr;
+  }
+
+  // puts a frame that no longer holds a page at the end of the LRU list,
+  // where it's reused first
+  //
+  void link_lru(unsigned f) noexcept
+  {
+    auto& fr = frames_[f];
+    fr.prev  = lru_;
+    fr.next  = none;
+    if (lru_ != none) { frames_[lru_].next = f; }
+    lru_ = f;
+    if (mru_ == none) { mru_ = f; }
+    fr.page  = no_page;
+    fr.dirty = false;
+  }
+
+  // keeps the `read_ahead_pages` after `first` hinted, skipping those an
+  // earlier call already covered
+  //
+  void read_ahead(size_type first)
+  {
+    if (first < ahead_) { first = ahead_; }
+
+    auto last = first + read_ahead_pages;
+    if (last > stored_pages_) { last = stored_pages_; }
+    if (first >= last) { return; }
+
+    ::posix_fadvise(fd_, static_cast<off_t>(first * this->page_bytes()),
+                    static_cast<off_t>((last - first) * this->page_bytes()),
+                    POSIX_FADV_WILLNEED);
+    stats_.read_aheads += last - first;
+    ahead_ = last;
+  }
+
+ public:
+  // Keeps up to `max_resident` pages of `page_size` bytes each in memory,
+  // spilling the rest to a temporary file in `dir`.
+  //
+  explicit external_vector(size_type max_resident,
+                           size_type page_size = LESS_EXTERNAL_PAGE_SIZE,
+                           char const* dir     = nullptr)
+      : fd_(detail::open_temp_file(dir))
+      , page_size_(page_size / sizeof(T) > 0 ? page_size / sizeof(T) : 1u)
+      , max_resident_(max_resident > 0 ? max_resident : 1u)
+  {
+  }
+
+  external_vector(external_vector const&) = delete;
+  auto operator=(external_vector const&) -> external_vector& = delete;
+
+  ~external_vector()
+  {
+    ::close(fd_);
+  }
+
+  // Element access
+
+  auto at(size_type const pos) -> T
+  {
+    if (pos >= size_) { throw out_of_range{}; }
+
+    return (*this)[pos];
+  }
+
+  auto operator[](size_type const pos) -> T
+  {
+    return this->fault_in(pos / page_size_).elems[pos % page_size_];
+  }
+
+  void set(size_type const pos, T const& value)
+  {
+    if (pos >= size_) { throw out_of_range{}; }
+
+    auto& fr                    = this->fault_in(pos / page_size_);
+    fr.elems[pos % page_size_] = value;
+    fr.dirty                    = true;
+  }
+
+  auto back() -> T
+  {
+    return (*this)[size_ - 1];
+  }
+
+  // Calls `f(x)` for every element in order, a page at a time.
+  //
+  template <class F>
+  void for_each(F f)
+  {
+    auto const pages = page_table_.size();
+    for (auto p = size_type{0}; p < pages; ++p) {
+      auto const& fr    = this->fault_in(p);
+      auto const  count = this->page_count(p);
+      for (auto i = size_type{0}; i < count; ++i) {
+        f(static_cast<T const&>(fr.elems[i]));
+      }
+    }
+  }
+
+  // Capacity
+
+  bool empty() const noexcept
+  {
+    return size_ == 0u;
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return size_;
+  }
+
+  // elements per page
+  //
+  auto page_size() const noexcept -> size_type
+  {
+    return page_size_;
+  }
+
+  auto max_resident() const noexcept -> size_type
+  {
+    return max_resident_;
+  }
+
+  // pages currently in memory
+  //
+  auto resident() const noexcept -> size_type
+  {
+    auto n = size_type{0};
+    for (auto const& fr : frames_) {
+      if (fr.page != no_page) { ++n; }
+    }
+    return n;
+  }
+
+  auto stats() const noexcept -> external_stats
+  {
+    return stats_;
+  }
+
+  // Modifiers
+
+  void push_back(T const& value)
+  {
+    auto const p   = size_ / page_size_;
+    auto const off = size_ % page_size_;
+
+    frame* fr = nullptr;
+    if (off == 0) {
+      // `value` may live in a frame that's about to be reused
+      //
+      auto const copy = value;
+
+      detail::grow_capacity(page_table_, page_table_.size() + 1);
+      page_table_.push_back(none);
+      try {
+        fr = &frames_[this->take_frame(p)];
+      }
+      catch (...) {
+        page_table_.pop_back();
+        throw;
+      }
+      fr->elems[0] = copy;
+    }
+    else {
+      fr             = &this->fault_in(p);
+      fr->elems[off] = value;
+    }
+
+    fr->dirty = true;
+    ++size_;
+
+    if (off + 1 == page_size_) {
+      this->write_page(*fr);
+      ::sync_file_range(fd_, static_cast<off_t>(p * this->page_bytes()),
+                        static_cast<off_t>(this->page_bytes()),
+                        SYNC_FILE_RANGE_WRITE);
+      ++stats_.write_behinds;
+    }
+  }
+
+  // Writes every dirty resident page to the file.
+  //
+  void flush()
+  {
+    for (auto& fr : frames_) {
+      if (fr.dirty && fr.page != no_page) { this->write_page(fr); }
+    }
+  }
+
+  // Exchanges elements, files and cache settings with `other`.
+  //
+  void swap(external_vector& other) noexcept
+  {
+    auto const exchange = [](auto& a, auto& b) {
+      auto tmp = a;
+      a        = b;
+      b        = tmp;
+    };
+
+    exchange(fd_, other.fd_);
+    exchange(page_size_, other.page_size_);
+    exchange(max_resident_, other.max_resident_);
+    exchange(size_, other.size_);
+    exchange(stored_pages_, other.stored_pages_);
+    frames_.swap(other.frames_);
+    page_table_.swap(other.page_table_);
+    exchange(mru_, other.mru_);
+    exchange(lru_, other.lru_);
+    exchange(last_fault_, other.last_fault_);
+    exchange(ahead_, other.ahead_);
+    exchange(stats_, other.stats_);
+  }
+
+  // Drops every element and empties the file, keeping the frames.
+  //
+  void clear()
+  {
+    if (ftruncate(fd_, 0) != 0) { detail::throw_errno(); }
+
+    for (auto f = 0u; f < frames_.size(); ++f) {
+      this->unlink(f);
+    }
+    for (auto f = 0u; f < frames_.size(); ++f) {
+      this->link_lru(f);
+    }
+
+    page_table_.clear();
+    size_         = 0u;
+    stored_pages_ = 0u;
+    last_fault_   = ~size_type{0};
+    ahead_        = 0u;
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_EXTERNAL_VECTOR_HPP
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_EYTZINGER_INDEX_HPP
+#define LESS_EYTZINGER_INDEX_HPP
+
+#include <cstdint>
+#include <functional>
+
+#include <less/vector.hpp>
+
+#ifndef LESS_EYTZINGER_BATCH
+#define LESS_EYTZINGER_BATCH 16
+#endif
+
+namespace less {
+namespace detail {
+
+inline auto eytzinger_log2(unsigned_long_type k) noexcept -> unsigned
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return 63u - static_cast<unsigned>(__builtin_clzll(k));
+#else
+  auto d = 0u;
+  while (k >>= 1) {
+    ++d;
+  }
+  return d;
+#endif
+}
+
+inline auto eytzinger_ctz(unsigned_long_type k) noexcept -> unsigned
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctzll(k));
+#else
+  auto n = 0u;
+  while (!(k & 1u)) {
+    k >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+// Where the search ends up after walking off the bottom of the tree: the
+// last node it went left at, or 0 if it only ever went right.
+//
+inline auto eytzinger_settle(unsigned_long_type k) noexcept
+    -> unsigned_long_type
+{
+  return k >> (eytzinger_ctz(~k) + 1);
+}
+
+inline void eytzinger_prefetch(void const* p) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(p);
+#else
+  (void)p;
+#endif
+}
+
+}    // namespace detail
+
+// A static search index over a sorted range, stored in Eytzinger (BFS) order:
+// the root at 1 and the children of `k` at `2k` and `2k + 1`. The top levels
+// that every search walks are packed into the first few cache lines. Storage
+// is aligned so that, for elements whose size divides 64, the 64 / sizeof(T)
+// descendants a few levels below any node share one cache line. The searches
+// prefetch that line while they compare the current node, so each memory
+// access overlaps with the next few levels. The descent has no data-dependent
+// branches.
+//
+// Searches return ranks in the original sorted order, so they can index
+// parallel arrays kept alongside. The batch `lower_bound()` walks up to
+// LESS_EYTZINGER_BATCH searches in lockstep, which keeps that many misses in
+// flight at once.
+//
+template <class T, class Compare = std::less<T>>
+struct eytzinger_index {
+ public:
+  using value_type = T;
+  using size_type  = unsigned_long_type;
+
+ private:
+  static constexpr size_type const cache_line = 64;
+
+  // stride between nodes whose descendants are prefetched; the children of a
+  // node at the very least
+  //
+  static constexpr size_type const block =
+      (sizeof(T) <= cache_line / 2 && cache_line % sizeof(T) == 0)
+          ? cache_line / sizeof(T)
+          : 2;
+
+  vector<T> storage_;
+  T*        base_   = nullptr;
+  size_type n_      = 0;
+  unsigned  levels_ = 0;
+  Compare   comp_;
+
+  // In-order position of node `k` as if the tree were perfect, less the
+  // missing bottom-level nodes that would come before it.
+  //
+  auto rank(size_type k) const noexcept -> size_type
+  {
+    auto const depth   = detail::eytzinger_log2(k);
+    auto const perfect = (((k - (size_type{1} << depth)) * 2 + 1)
+                          << (levels_ - 1 - depth)) -
+                         1;
+
+    auto const bottom = size_type{1} << (levels_ - 1);
+    auto const before = (perfect + 1) / 2;
+    auto const last   = (bottom + before < 2 * bottom ? bottom + before
+                                                      : 2 * bottom);
+    return perfect - (last > n_ + 1 ? last - (n_ + 1) : 0);
+  }
+
+  void prefetch(size_type k) const noexcept
+  {
+    detail::eytzinger_prefetch(reinterpret_cast<char const*>(
+        reinterpret_cast<std::uintptr_t>(base_) + k * block * sizeof(T)));
+  }
+
+  template <class Less>
+  auto search(T const& x, Less less) const noexcept -> size_type
+  {
+    auto k = size_type{1};
+    while (k <= n_) {
+      this->prefetch(k);
+      k = 2 * k + (less(base_[k], x) ? 1u : 0u);
+    }
+    return detail::eytzinger_settle(k);
+  }
+
+  auto to_rank(size_type k) const noexcept -> size_type
+  {
+    return k == 0 ? n_ : this->rank(k);
+  }
+
+ public:
+  eytzinger_index() = default;
+
+  // `[first, last)` has to be sorted by `comp`.
+  //
+  eytzinger_index(T const* first, T const* last,
+                  Compare const& comp = Compare())
+      : n_(static_cast<size_type>(last - first))
+      , comp_(comp)
+  {
+    if (n_ == 0) { return; }
+
+    levels_ = detail::eytzinger_log2(n_) + 1;
+
+    // room to slide the tree onto a cache line boundary
+    //
+    auto const slack = (cache_line % sizeof(T) == 0) ? cache_line / sizeof(T)
+                                                     : size_type{0};
+    storage_ = vector<T>(default_init, n_ + 1 + slack);
+
+    auto const misalign =
+        reinterpret_cast<std::uintptr_t>(storage_.data()) % cache_line;
+    auto const offset =
+        (slack == 0 || misalign == 0) ? 0 : (cache_line - misalign) / sizeof(T);
+    base_ = storage_.data() + offset;
+
+    for (auto k = size_type{1}; k <= n_; ++k) {
+      base_[k] = first[this->rank(k)];
+    }
+  }
+
+  explicit eytzinger_index(vector<T> const& sorted,
+                           Compare const&   comp = Compare())
+      : eytzinger_index(sorted.data(), sorted.data() + sorted.size(), comp)
+  {
+  }
+
+  eytzinger_index(eytzinger_index const&) = delete;
+  auto operator=(eytzinger_index const&) -> eytzinger_index& = delete;
+
+  eytzinger_index(eytzinger_index&& other) noexcept
+      : storage_(detail::move(other.storage_))
+      , base_(other.base_)
+      , n_(other.n_)
+      , levels_(other.levels_)
+      , comp_(other.comp_)
+  {
+    other.base_   = nullptr;
+    other.n_      = 0;
+    other.levels_ = 0;
+  }
+
+  auto operator=(eytzinger_index&& other) noexcept -> eytzinger_index&
+  {
+    if (this != &other) {
+      storage_      = detail::move(other.storage_);
+      base_         = other.base_;
+      n_            = other.n_;
+      levels_       = other.levels_;
+      comp_         = other.comp_;
+      other.base_   = nullptr;
+      other.n_      = 0;
+      other.levels_ = 0;
+    }
+    return *this;
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return n_;
+  }
+
+  bool empty() const noexcept
+  {
+    return n_ == 0;
+  }
+
+  // Rank of the first element not less than `x`, or size() if there's none.
+  //
+  auto lower_bound(T const& x) const -> size_type
+  {
+    return this->to_rank(this->search(
+        x, [this](T const& a, T const& b) { return comp_(a, b); }));
+  }
+
+  // Rank of the first element greater than `x`, or size() if there's none.
+  //
+  auto upper_bound(T const& x) const -> size_type
+  {
+    return this->to_rank(this->search(
+        x, [this](T const& a, T const& b) { return !comp_(b, a); }));
+  }
+
+  bool contains(T const& x) const
+  {
+    auto const k = this->search(
+        x, [this](T const& a, T const& b) { return comp_(a, b); });
+    return k != 0 && !comp_(x, base_[k]);
+  }
+
+  // Writes the `lower_bound()` of each of `queries[0, count)` to `ranks`.
+  //
+  // Every level but the last is complete, so all searches in a batch take
+  // the same number of steps and only the last step needs a bounds check.
+  //
+  void lower_bound(T const* queries, size_type count, size_type* ranks) const
+  {
+    constexpr size_type const batch = LESS_EYTZINGER_BATCH;
+
+    if (n_ == 0) {
+      for (auto i = size_type{0}; i < count; ++i) {
+        ranks[i] = 0;
+      }
+      return;
+    }
+
+    size_type k[batch];
+    for (auto first = size_type{0}; first < count; first += batch) {
+      auto const g = (count - first < batch ? count - first : batch);
+      auto const q = queries + first;
+
+      for (auto j = size_type{0}; j < g; ++j) {
+        k[j] = 1;
+      }
+
+      for (auto level = 1u; level < levels_; ++level) {
+        for (auto j = size_type{0}; j < g; ++j) {
+          this->prefetch(k[j]);
+          k[j] = 2 * k[j] + (comp_(base_[k[j]], q[j]) ? 1u : 0u);
+        }
+      }
+
+      for (auto j = size_type{0}; j < g; ++j) {
+        if (k[j] <= n_) {
+          k[j] = 2 * k[j] + (comp_(base_[k[j]], q[j]) ? 1u : 0u);
+        }
+        ranks[first + j] = this->to_rank(detail::eytzinger_settle(k[j]));
+      }
+    }
+  }
+
+  auto lower_bound(vector<T> const& queries) const -> vector<size_type>
+  {
+    auto ranks = vector<size_type>(default_init, queries.size());
+    this->lower_bound(queries.data(), queries.size(), ranks.data());
+    return ranks;
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_EYTZINGER_INDEX_HPP
@@ -0,0 +1,872 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_FLAT_HASH_MAP_HPP
+#define LESS_FLAT_HASH_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)) &&           \
+    !defined(LESS_FLAT_HASH_MAP_NO_SSE2)
+#define LESS_FLAT_HASH_MAP_SSE2
+#include <emmintrin.h>
+#endif
+
+#include <less/vector.hpp>
+
+namespace less {
+
+template <class Key, class T, class Hash, class KeyEqual>
+struct flat_hash_map;
+
+namespace detail {
+
+// Each slot has a control byte: the top bit is set for empty and deleted
+// slots, and full slots store the low 7 bits of their hash, so 16 of them can
+// be matched against a lookup at once before any key is compared.
+//
+inline constexpr signed char hash_ctrl_empty   = -128;
+inline constexpr signed char hash_ctrl_deleted = -2;
+
+inline constexpr unsigned_long_type hash_group_width = 16;
+
+inline auto hash_ctz(std::uint32_t mask) noexcept -> unsigned
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+  auto n = 0u;
+  while (!(mask & 1u)) {
+    mask >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+// 16 control bytes, loaded with one SSE2 load where available. Each match
+// returns a bitmask with bit `i` set for every matching byte.
+//
+struct hash_group {
+#ifdef LESS_FLAT_HASH_MAP_SSE2
+  __m128i ctrl;
+
+  explicit hash_group(signed char const* p) noexcept
+      : ctrl(_mm_loadu_si128(reinterpret_cast<__m128i const*>(p)))
+  {
+  }
+
+  auto match(signed char h2) const noexcept -> std::uint32_t
+  {
+    return static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+  }
+
+  auto match_empty() const noexcept -> std::uint32_t
+  {
+    return this->match(hash_ctrl_empty);
+  }
+
+  auto match_free() const noexcept -> std::uint32_t
+  {
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl));
+  }
+#else
+  signed char const* ctrl;
+
+  explicit hash_group(signed char const* p) noexcept
+      : ctrl(p)
+  {
+  }
+
+  auto match(signed char h2) const noexcept -> std::uint32_t
+  {
+    auto mask = std::uint32_t{0};
+    for (auto i = 0u; i < hash_group_width; ++i) {
+      mask |= std::uint32_t{ctrl[i] == h2} << i;
+    }
+    return mask;
+  }
+
+  auto match_empty() const noexcept -> std::uint32_t
+  {
+    return this->match(hash_ctrl_empty);
+  }
+
+  auto match_free() const noexcept -> std::uint32_t
+  {
+    auto mask = std::uint32_t{0};
+    for (auto i = 0u; i < hash_group_width; ++i) {
+      mask |= std::uint32_t{ctrl[i] < 0} << i;
+    }
+    return mask;
+  }
+#endif
+};
+
+// `std::hash` is the identity for integers, so the bits are mixed before
+// they're split into a group index and the 7-bit control tag.
+//
+inline auto hash_mix(unsigned_long_type h) noexcept -> std::uint64_t
+{
+  auto x = static_cast<std::uint64_t>(h);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  return x;
+}
+
+template <class T>
+struct hash_slot {
+  alignas(T) unsigned char bytes[sizeof(T)];
+
+  auto get() noexcept -> T*
+  {
+    return reinterpret_cast<T*>(bytes);
+  }
+
+  auto get() const noexcept -> T const*
+  {
+    return reinterpret_cast<T const*>(bytes);
+  }
+};
+
+template <class Hash, class KeyEqual, class = void>
+struct hash_is_transparent : std::false_type {};
+
+template <class Hash, class KeyEqual>
+struct hash_is_transparent<Hash, KeyEqual,
+                           std::void_t<typename Hash::is_transparent,
+                                       typename KeyEqual::is_transparent>>
+    : std::true_type {};
+
+template <class Value, bool Const>
+struct flat_hash_map_iterator {
+ public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = Value;
+  using difference_type   = std::ptrdiff_t;
+  using pointer   = std::conditional_t<Const, Value const*, Value*>;
+  using reference = std::conditional_t<Const, Value const&, Value&>;
+
+ private:
+  using slot_pointer = std::conditional_t<Const, hash_slot<Value> const*,
+                                          hash_slot<Value>*>;
+
+  signed char const* ctrl_ = nullptr;
+  signed char const* end_  = nullptr;
+  slot_pointer       slot_ = nullptr;
+
+  template <class, bool>
+  friend struct flat_hash_map_iterator;
+
+  template <class, class, class, class>
+  friend struct less::flat_hash_map;
+
+  void skip_free() noexcept
+  {
+    while (ctrl_ != end_ && *ctrl_ < 0) {
+      ++ctrl_;
+      ++slot_;
+    }
+  }
+
+  flat_hash_map_iterator(signed char const* ctrl, signed char const* end,
+                         slot_pointer slot) noexcept
+      : ctrl_(ctrl)
+      , end_(end)
+      , slot_(slot)
+  {
+  }
+
+ public:
+  flat_hash_map_iterator() = default;
+
+  template <bool C = Const, class = std::enable_if_t<C>>
+  flat_hash_map_iterator(
+      flat_hash_map_iterator<Value, false> const& other) noexcept
+      : ctrl_(other.ctrl_)
+      , end_(other.end_)
+      , slot_(other.slot_)
+  {
+  }
+
+  auto operator*() const noexcept -> reference
+  {
+    return *slot_->get();
+  }
+
+  auto operator->() const noexcept -> pointer
+  {
+    return slot_->get();
+  }
+
+  auto operator++() noexcept -> flat_hash_map_iterator&
+  {
+    ++ctrl_;
+    ++slot_;
+    this->skip_free();
+    return *this;
+  }
+
+  auto operator++(int) noexcept -> flat_hash_map_iterator
+  {
+    auto it = *this;
+    ++*this;
+    return it;
+  }
+
+  friend bool operator==(flat_hash_map_iterator const& lhs,
+                         flat_hash_map_iterator const& rhs) noexcept
+  {
+    return lhs.ctrl_ == rhs.ctrl_;
+  }
+
+  friend bool operator!=(flat_hash_map_iterator const& lhs,
+                         flat_hash_map_iterator const& rhs) noexcept
+  {
+    return lhs.ctrl_ != rhs.ctrl_;
+  }
+};
+
+}    // namespace detail
+
+// Open-addressing hash map in the style of SwissTable. Control bytes and slots
+// live in two `less::vector`s; slots are built with `less::default_init`, so
+// growing the table never touches memory that isn't about to be filled.
+//
+// Lookups probe one group of 16 control bytes at a time, with SSE2 where the
+// target has it (define `LESS_FLAT_HASH_MAP_NO_SSE2` for the portable loop),
+// and only compare keys whose 7-bit tag matched. Groups are probed
+// triangularly, so every group is visited once before any repeats. The table
+// grows at 7/8 full. Erasing leaves a tombstone only when the slot's group has
+// no empty byte, since otherwise no probe continues past it.
+//
+// Iterators and references are invalidated when the table grows. Hashers and
+// key comparisons that define `is_transparent` enable lookups by any type they
+// accept.
+//
+template <class Key, class T, class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+struct flat_hash_map {
+ public:
+  using key_type        = Key;
+  using mapped_type     = T;
+  using value_type      = std::pair<Key const, T>;
+  using size_type       = unsigned_long_type;
+  using hasher          = Hash;
+  using key_equal       = KeyEqual;
+  using iterator        = detail::flat_hash_map_iterator<value_type, false>;
+  using const_iterator  = detail::flat_hash_map_iterator<value_type, true>;
+
+ private:
+  using slot_type = detail::hash_slot<value_type>;
+
+  static constexpr size_type const group_width = detail::hash_group_width;
+  static constexpr size_type const npos        = size_type(-1);
+
+  template <class K>
+  using enable_if_transparent = std::enable_if_t<
+      detail::hash_is_transparent<Hash, KeyEqual>::value &&
+          !std::is_convertible_v<K, iterator> &&
+          !std::is_convertible_v<K, const_iterator>,
+      int>;
+
+  vector<signed char> ctrl_;
+  vector<slot_type>   slots_;
+  size_type           size_        = 0u;
+  size_type           growth_left_ = 0u;
+  Hash                hash_;
+  KeyEqual            eq_;
+
+  static auto growth_limit(size_type capacity) noexcept -> size_type
+  {
+    return capacity - capacity / 8;
+  }
+
+  // the smallest power-of-two number of groups that holds `n` elements below
+  // the load limit
+  //
+  static auto capacity_for(size_type n) noexcept -> size_type
+  {
+    auto capacity = group_width;
+    while (growth_limit(capacity) < n) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  template <class K>
+  auto hash_of(K const& key) const -> std::uint64_t
+  {
+    return detail::hash_mix(static_cast<unsigned_long_type>(hash_(key)));
+  }
+
+  static auto h2(std::uint64_t h) noexcept -> signed char
+  {
+    return static_cast<signed char>(h & 0x7f);
+  }
+
+  auto group_mask() const noexcept -> size_type
+  {
+    return ctrl_.size() / group_width - 1;
+  }
+
+  template <class K>
+  auto find_index(K const& key, std::uint64_t h) const -> size_type
+  {
+    if (ctrl_.empty()) { return npos; }
+
+    auto const mask = this->group_mask();
+    auto const tag  = h2(h);
+
+    auto g = static_cast<size_type>(h >> 7) & mask;
+    for (auto step = size_type{1};; ++step) {
+      auto const base  = g * group_width;
+      auto const group = detail::hash_group(ctrl_.data() + base);
+
+      for (auto m = group.match(tag); m != 0; m &= m - 1) {
+        auto const i = base + detail::hash_ctz(m);
+        if (eq_(slots_[i].get()->first, key)) { return i; }
+      }
+      if (group.match_empty()) { return npos; }
+
+      g = (g + step) & mask;
+    }
+  }
+
+  // first empty or deleted slot along the probe sequence of `h`
+  //
+  auto find_free(std::uint64_t h) const noexcept -> size_type
+  {
+    auto const mask = this->group_mask();
+
+    auto g = static_cast<size_type>(h >> 7) & mask;
+    for (auto step = size_type{1};; ++step) {
+      auto const base = g * group_width;
+      auto const m = detail::hash_group(ctrl_.data() + base).match_free();
+      if (m) { return base + detail::hash_ctz(m); }
+
+      g = (g + step) & mask;
+    }
+  }
+
+  void destroy_all() noexcept
+  {
+    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+      for (auto i = size_type{0}; i < ctrl_.size(); ++i) {
+        if (ctrl_[i] >= 0) { slots_[i].get()->~value_type(); }
+      }
+    }
+  }
+
+  // Moves everything into a table of `capacity` slots. Every key is hashed
+  // before anything is moved, so a throwing hasher leaves the table as it
+  // was. Keys are const, so they're copied; if that can throw, the mapped
+  // values are copied as well and the old table stays intact until the new
+  // one is complete.
+  //
+  void rehash_to(size_type capacity)
+  {
+    constexpr bool const nothrow =
+        std::is_nothrow_copy_constructible_v<Key> &&
+        detail::is_nothrow_move_constructible_v<T>;
+
+    auto ctrl   = vector<signed char>(capacity, detail::hash_ctrl_empty);
+    auto slots  = vector<slot_type>(default_init, capacity);
+    auto hashes = vector<size_type>(with_capacity, size_);
+    for (auto i = size_type{0}; i < ctrl_.size(); ++i) {
+      if (ctrl_[i] >= 0) {
+        hashes.push_back(this->hash_of(slots_[i].get()->first));
+      }
+    }
+
+    auto const mask = capacity / group_width - 1;
+
+    auto place = [&](value_type& x, size_type h) -> size_type {
+      auto g = static_cast<size_type>(h >> 7) & mask;
+      for (auto step = size_type{1};; ++step) {
+        auto const base = g * group_width;
+        auto const m = detail::hash_group(ctrl.data() + base).match_empty();
+        if (m) {
+          auto const i = base + detail::hash_ctz(m);
+          if constexpr (nothrow) {
+            new (slots[i].get(), detail::placement_tag_t{})
+                value_type(x.first, detail::move(x.second));
+          }
+          else {
+            new (slots[i].get(), detail::placement_tag_t{}) value_type(x);
+          }
+          ctrl[i] = h2(h);
+          return i;
+        }
+        g = (g + step) & mask;
+      }
+    };
+
+    auto moved = vector<size_type>();
+    if constexpr (!nothrow) { moved.reserve(size_); }
+
+    try {
+      auto n = size_type{0};
+      for (auto i = size_type{0}; i < ctrl_.size(); ++i) {
+        if (ctrl_[i] < 0) { continue; }
+
+        auto const j = place(*slots_[i].get(), hashes[n++]);
+        if constexpr (!nothrow) { moved.push_back(j); }
+      }
+    }
+    catch (...) {
+      for (auto j : moved) {
+        slots[j].get()->~value_type();
+      }
+      throw;
+    }
+
+    this->destroy_all();
+    ctrl_.swap(ctrl);
+    slots_.swap(slots);
+    growth_left_ = growth_limit(capacity) - size_;
+  }
+
+  // Makes room for one more element. Tables mostly full of tombstones are
+  // rebuilt at the same size instead of doubling.
+  //
+  void grow()
+  {
+    auto const capacity = ctrl_.size();
+    if (capacity != 0 && size_ < growth_limit(capacity) / 2) {
+      this->rehash_to(capacity);
+    }
+    else {
+      this->rehash_to(capacity == 0 ? group_width : 2 * capacity);
+    }
+  }
+
+  auto it(size_type i) noexcept -> iterator
+  {
+    return {ctrl_.data() + i, ctrl_.data() + ctrl_.size(), slots_.data() + i};
+  }
+
+  auto it(size_type i) const noexcept -> const_iterator
+  {
+    return {ctrl_.data() + i, ctrl_.data() + ctrl_.size(), slots_.data() + i};
+  }
+
+  template <class K, class... Args>
+  auto emplace_impl(K&& key, Args&&... args) -> std::pair<iterator, bool>
+  {
+    auto const h = this->hash_of(key);
+
+    auto const found = this->find_index(key, h);
+    if (found != npos) { return {this->it(found), false}; }
+
+    if (growth_left_ == 0) { this->grow(); }
+
+    auto const i = this->find_free(h);
+    new (slots_[i].get(), detail::placement_tag_t{})
+        value_type(std::piecewise_construct,
+                   std::forward_as_tuple(detail::forward<K>(key)),
+                   std::forward_as_tuple(detail::forward<Args>(args)...));
+
+    if (ctrl_[i] == detail::hash_ctrl_empty) { --growth_left_; }
+    ctrl_[i] = h2(h);
+    ++size_;
+
+    return {this->it(i), true};
+  }
+
+  void erase_at(size_type i) noexcept
+  {
+    slots_[i].get()->~value_type();
+    --size_;
+
+    auto const base = i - i % group_width;
+    if (detail::hash_group(ctrl_.data() + base).match_empty()) {
+      ctrl_[i] = detail::hash_ctrl_empty;
+      ++growth_left_;
+    }
+    else {
+      ctrl_[i] = detail::hash_ctrl_deleted;
+    }
+  }
+
+ public:
+  flat_hash_map() = default;
+
+  explicit flat_hash_map(Hash const& hash, KeyEqual const& eq = KeyEqual())
+      : hash_(hash)
+      , eq_(eq)
+  {
+  }
+
+  // Sized so that `capacity` elements fit without rehashing.
+  //
+  flat_hash_map(with_capacity_t, size_type capacity, Hash const& hash = Hash(),
+                KeyEqual const& eq = KeyEqual())
+      : hash_(hash)
+      , eq_(eq)
+  {
+    this->reserve(capacity);
+  }
+
+  template <class InputIt>
+  flat_hash_map(InputIt first, InputIt last, Hash const& hash = Hash(),
+                KeyEqual const& eq = KeyEqual())
+      : hash_(hash)
+      , eq_(eq)
+  {
+    this->insert(first, last);
+  }
+
+  flat_hash_map(std::initializer_list<value_type> ilist,
+                Hash const& hash = Hash(), KeyEqual const& eq = KeyEqual())
+      : hash_(hash)
+      , eq_(eq)
+  {
+    this->insert(ilist.begin(), ilist.end());
+  }
+
+  // Builds the table from parallel vectors in one sizing step; later
+  // duplicates of a key are dropped. Throws `less::out_of_range` if the
+  // vectors differ in size.
+  //
+  flat_hash_map(vector<Key> keys, vector<T> values, Hash const& hash = Hash(),
+                KeyEqual const& eq = KeyEqual())
+      : hash_(hash)
+      , eq_(eq)
+  {
+    if (keys.size() != values.size()) { throw out_of_range{}; }
+
+    this->reserve(keys.size());
+    for (auto i = size_type{0}; i < keys.size(); ++i) {
+      this->emplace_impl(detail::move(keys[i]), detail::move(values[i]));
+    }
+  }
+
+  flat_hash_map(flat_hash_map const& other)
+      : hash_(other.hash_)
+      , eq_(other.eq_)
+  {
+    this->reserve(other.size_);
+    for (auto const& kv : other) {
+      this->emplace_impl(kv.first, kv.second);
+    }
+  }
+
+  flat_hash_map(flat_hash_map&& other) noexcept
+      : ctrl_(detail::move(other.ctrl_))
+      , slots_(detail::move(other.slots_))
+      , size_(other.size_)
+      , growth_left_(other.growth_left_)
+      , hash_(other.hash_)
+      , eq_(other.eq_)
+  {
+    other.ctrl_.clear();
+    other.size_        = 0;
+    other.growth_left_ = 0;
+  }
+
+  ~flat_hash_map()
+  {
+    this->destroy_all();
+  }
+
+  auto operator=(flat_hash_map const& other) -> flat_hash_map&
+  {
+    if (this != &other) {
+      auto copy = other;
+      this->swap(copy);
+    }
+    return *this;
+  }
+
+  auto operator=(flat_hash_map&& other) noexcept -> flat_hash_map&
+  {
+    if (this != &other) {
+      auto tmp = detail::move(other);
+      this->swap(tmp);
+    }
+    return *this;
+  }
+
+  auto begin() noexcept -> iterator
+  {
+    auto it = this->it(0);
+    it.skip_free();
+    return it;
+  }
+
+  auto end() noexcept -> iterator
+  {
+    return this->it(ctrl_.size());
+  }
+
+  auto begin() const noexcept -> const_iterator
+  {
+    auto it = this->it(0);
+    it.skip_free();
+    return it;
+  }
+
+  auto end() const noexcept -> const_iterator
+  {
+    return this->it(ctrl_.size());
+  }
+
+  auto hash_function() const -> hasher
+  {
+    return hash_;
+  }
+
+  auto key_eq() const -> key_equal
+  {
+    return eq_;
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return size_;
+  }
+
+  bool empty() const noexcept
+  {
+    return size_ == 0;
+  }
+
+  // Number of slots; at most 7/8 of them are used before the table grows.
+  //
+  auto capacity() const noexcept -> size_type
+  {
+    return ctrl_.size();
+  }
+
+  void reserve(size_type n)
+  {
+    if (n <= size_ + growth_left_) { return; }
+    this->rehash_to(capacity_for(n));
+  }
+
+  void clear() noexcept
+  {
+    this->destroy_all();
+    for (auto& c : ctrl_) {
+      c = detail::hash_ctrl_empty;
+    }
+    size_        = 0;
+    growth_left_ = growth_limit(ctrl_.size());
+  }
+
+  auto find(Key const& key) -> iterator
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    return i == npos ? this->end() : this->it(i);
+  }
+
+  auto find(Key const& key) const -> const_iterator
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    return i == npos ? this->end() : this->it(i);
+  }
+
+  template <class K, enable_if_transparent<K> = 0>
+  auto find(K const& key) -> iterator
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    return i == npos ? this->end() : this->it(i);
+  }
+
+  template <class K, enable_if_transparent<K> = 0>
+  auto find(K const& key) const -> const_iterator
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    return i == npos ? this->end() : this->it(i);
+  }
+
+  bool contains(Key const& key) const
+  {
+    return this->find_index(key, this->hash_of(key)) != npos;
+  }
+
+  template <class K, enable_if_transparent<K> = 0>
+  bool contains(K const& key) const
+  {
+    return this->find_index(key, this->hash_of(key)) != npos;
+  }
+
+  auto count(Key const& key) const -> size_type
+  {
+    return this->contains(key) ? 1u : 0u;
+  }
+
+  template <class K, enable_if_transparent<K> = 0>
+  auto count(K const& key) const -> size_type
+  {
+    return this->contains(key) ? 1u : 0u;
+  }
+
+  auto at(Key const& key) -> T&
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    if (i == npos) { throw out_of_range{}; }
+    return slots_[i].get()->second;
+  }
+
+  auto at(Key const& key) const -> T const&
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    if (i == npos) { throw out_of_range{}; }
+    return slots_[i].get()->second;
+  }
+
+  template <class K, enable_if_transparent<K> = 0>
+  auto at(K const& key) -> T&
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    if (i == npos) { throw out_of_range{}; }
+    return slots_[i].get()->second;
+  }
+
+  template <class K, enable_if_transparent<K> = 0>
+  auto at(K const& key) const -> T const&
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    if (i == npos) { throw out_of_range{}; }
+    return slots_[i].get()->second;
+  }
+
+  auto operator[](Key const& key) -> T&
+  {
+    return this->emplace_impl(key).first->second;
+  }
+
+  auto operator[](Key&& key) -> T&
+  {
+    return this->emplace_impl(detail::move(key)).first->second;
+  }
+
+  template <class... Args>
+  auto try_emplace(Key const& key, Args&&... args) -> std::pair<iterator, bool>
+  {
+    return this->emplace_impl(key, detail::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  auto try_emplace(Key&& key, Args&&... args) -> std::pair<iterator, bool>
+  {
+    return this->emplace_impl(detail::move(key),
+                              detail::forward<Args>(args)...);
+  }
+
+  auto insert(value_type const& kv) -> std::pair<iterator, bool>
+  {
+    return this->emplace_impl(kv.first, kv.second);
+  }
+
+  auto insert(value_type&& kv) -> std::pair<iterator, bool>
+  {
+    return this->emplace_impl(detail::move(kv.first), detail::move(kv.second));
+  }
+
+  template <class M>
+  auto insert_or_assign(Key const& key, M&& value) -> std::pair<iterator, bool>
+  {
+    auto r = this->emplace_impl(key, detail::forward<M>(value));
+    if (!r.second) { r.first->second = detail::forward<M>(value); }
+    return r;
+  }
+
+  // Forward ranges size the table once up front, so the inserts never
+  // rehash.
+  //
+  template <class InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+      this->reserve(size_ +
+                    static_cast<size_type>(std::distance(first, last)));
+    }
+
+    for (; first != last; ++first) {
+      auto&& kv = *first;
+      this->emplace_impl(kv.first, kv.second);
+    }
+  }
+
+  void insert(std::initializer_list<value_type> ilist)
+  {
+    this->insert(ilist.begin(), ilist.end());
+  }
+
+  // Returns an iterator to the element after `pos`.
+  //
+  auto erase(const_iterator pos) noexcept -> iterator
+  {
+    auto const i = static_cast<size_type>(pos.ctrl_ - ctrl_.data());
+    this->erase_at(i);
+
+    auto next = this->it(i + 1);
+    next.skip_free();
+    return next;
+  }
+
+  auto erase(Key const& key) -> size_type
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    if (i == npos) { return 0u; }
+    this->erase_at(i);
+    return 1u;
+  }
+
+  template <class K, enable_if_transparent<K> = 0>
+  auto erase(K const& key) -> size_type
+  {
+    auto const i = this->find_index(key, this->hash_of(key));
+    if (i == npos) { return 0u; }
+    this->erase_at(i);
+    return 1u;
+  }
+
+  void swap(flat_hash_map& other) noexcept
+  {
+    using std::swap;
+    ctrl_.swap(other.ctrl_);
+    slots_.swap(other.slots_);
+    swap(size_, other.size_);
+    swap(growth_left_, other.growth_left_);
+    swap(hash_, other.hash_);
+    swap(eq_, other.eq_);
+  }
+
+  friend bool operator==(flat_hash_map const& lhs, flat_hash_map const& rhs)
+  {
+    if (lhs.size_ != rhs.size_) { return false; }
+    for (auto const& kv : lhs) {
+      auto const it = rhs.find(kv.first);
+      if (it == rhs.end() || !(it->second == kv.second)) { return false; }
+    }
+    return true;
+  }
+
+  friend bool operator!=(flat_hash_map const& lhs, flat_hash_map const& rhs)
+  {
+    return !(lhs == rhs);
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_FLAT_HASH_MAP_HPP
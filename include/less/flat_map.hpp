@@ -0,0 +1,574 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_FLAT_MAP_HPP
+#define LESS_FLAT_MAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include <less/flat_set.hpp>
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+// Walks the key and value vectors side by side. Dereferencing gives a pair of
+// references, so it behaves like a random access iterator everywhere except
+// that `reference` isn't a real reference.
+//
+template <class Key, class T, bool Const>
+struct flat_map_iterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type        = std::pair<Key, T>;
+  using difference_type   = std::ptrdiff_t;
+  using mapped_pointer    = std::conditional_t<Const, T const*, T*>;
+  using mapped_ref        = std::conditional_t<Const, T const&, T&>;
+  using reference         = std::pair<Key const&, mapped_ref>;
+
+  struct pointer {
+    reference ref;
+
+    auto operator->() noexcept -> reference*
+    {
+      return &ref;
+    }
+  };
+
+ private:
+  Key const*     k_ = nullptr;
+  mapped_pointer v_ = nullptr;
+
+  template <class, class, bool>
+  friend struct flat_map_iterator;
+
+ public:
+  flat_map_iterator() = default;
+
+  flat_map_iterator(Key const* k, mapped_pointer v) noexcept
+      : k_(k)
+      , v_(v)
+  {
+  }
+
+  template <bool C = Const, class = std::enable_if_t<C>>
+  flat_map_iterator(flat_map_iterator<Key, T, false> const& other) noexcept
+      : k_(other.k_)
+      , v_(other.v_)
+  {
+  }
+
+  auto key() const noexcept -> Key const&
+  {
+    return *k_;
+  }
+
+  auto value() const noexcept -> mapped_ref
+  {
+    return *v_;
+  }
+
+  auto operator*() const noexcept -> reference
+  {
+    return {*k_, *v_};
+  }
+
+  auto operator->() const noexcept -> pointer
+  {
+    return {**this};
+  }
+
+  auto operator[](difference_type n) const noexcept -> reference
+  {
+    return {k_[n], v_[n]};
+  }
+
+  auto operator++() noexcept -> flat_map_iterator&
+  {
+    ++k_;
+    ++v_;
+    return *this;
+  }
+
+  auto operator++(int) noexcept -> flat_map_iterator
+  {
+    auto it = *this;
+    ++*this;
+    return it;
+  }
+
+  auto operator--() noexcept -> flat_map_iterator&
+  {
+    --k_;
+    --v_;
+    return *this;
+  }
+
+  auto operator--(int) noexcept -> flat_map_iterator
+  {
+    auto it = *this;
+    --*this;
+    return it;
+  }
+
+  auto operator+=(difference_type n) noexcept -> flat_map_iterator&
+  {
+    k_ += n;
+    v_ += n;
+    return *this;
+  }
+
+  auto operator-=(difference_type n) noexcept -> flat_map_iterator&
+  {
+    return *this += -n;
+  }
+
+  friend auto operator+(flat_map_iterator it, difference_type n) noexcept
+      -> flat_map_iterator
+  {
+    return it += n;
+  }
+
+  friend auto operator+(difference_type n, flat_map_iterator it) noexcept
+      -> flat_map_iterator
+  {
+    return it += n;
+  }
+
+  friend auto operator-(flat_map_iterator it, difference_type n) noexcept
+      -> flat_map_iterator
+  {
+    return it -= n;
+  }
+
+  friend auto operator-(flat_map_iterator const& lhs,
+                        flat_map_iterator const& rhs) noexcept
+      -> difference_type
+  {
+    return lhs.k_ - rhs.k_;
+  }
+
+  friend bool operator==(flat_map_iterator const& lhs,
+                         flat_map_iterator const& rhs) noexcept
+  {
+    return lhs.k_ == rhs.k_;
+  }
+
+  friend bool operator!=(flat_map_iterator const& lhs,
+                         flat_map_iterator const& rhs) noexcept
+  {
+    return lhs.k_ != rhs.k_;
+  }
+
+  friend bool operator<(flat_map_iterator const& lhs,
+                        flat_map_iterator const& rhs) noexcept
+  {
+    return lhs.k_ < rhs.k_;
+  }
+
+  friend bool operator>(flat_map_iterator const& lhs,
+                        flat_map_iterator const& rhs) noexcept
+  {
+    return rhs.k_ < lhs.k_;
+  }
+
+  friend bool operator<=(flat_map_iterator const& lhs,
+                         flat_map_iterator const& rhs) noexcept
+  {
+    return !(rhs.k_ < lhs.k_);
+  }
+
+  friend bool operator>=(flat_map_iterator const& lhs,
+                         flat_map_iterator const& rhs) noexcept
+  {
+    return !(lhs.k_ < rhs.k_);
+  }
+};
+
+}    // namespace detail
+
+// Sorted map keeping keys and values in two parallel `less::vector`s, so a
+// lookup only touches the keys and the value is read once at the end.
+// `flat_map` keeps unique keys and `flat_multimap` keeps duplicates in
+// insertion order. Iterators are invalidated by any insert or erase.
+//
+template <class Key, class T, class Compare, bool Multi>
+struct basic_flat_map {
+ public:
+  using key_type       = Key;
+  using mapped_type    = T;
+  using value_type     = std::pair<Key, T>;
+  using key_compare    = Compare;
+  using size_type      = unsigned_long_type;
+  using iterator       = detail::flat_map_iterator<Key, T, false>;
+  using const_iterator = detail::flat_map_iterator<Key, T, true>;
+
+  using insert_return_type =
+      std::conditional_t<Multi, iterator, std::pair<iterator, bool>>;
+
+ private:
+  vector<Key> keys_;
+  vector<T>   values_;
+  Compare     comp_;
+
+  auto lower(Key const& key) const -> size_type
+  {
+    return detail::flat_lower_bound(keys_.data(), keys_.size(), key, comp_);
+  }
+
+  auto upper(Key const& key) const -> size_type
+  {
+    return detail::flat_upper_bound(keys_.data(), keys_.size(), key, comp_);
+  }
+
+  // index of `key`, or size() if it's not there
+  //
+  auto index_of(Key const& key) const -> size_type
+  {
+    auto const pos = this->lower(key);
+    if (pos < keys_.size() && !comp_(key, keys_[pos])) { return pos; }
+    return keys_.size();
+  }
+
+  auto it(size_type pos) noexcept -> iterator
+  {
+    return {keys_.data() + pos, values_.data() + pos};
+  }
+
+  auto it(size_type pos) const noexcept -> const_iterator
+  {
+    return {keys_.data() + pos, values_.data() + pos};
+  }
+
+  template <class K, class... Args>
+  auto insert_at(size_type pos, K&& key, Args&&... args) -> iterator
+  {
+    keys_.insert(keys_.begin() + pos, detail::forward<K>(key));
+    try {
+      values_.emplace(values_.begin() + pos, detail::forward<Args>(args)...);
+    }
+    catch (...) {
+      keys_.erase(keys_.begin() + pos);
+      throw;
+    }
+    return this->it(pos);
+  }
+
+  template <class K, class... Args>
+  auto emplace_impl(K&& key, Args&&... args) -> insert_return_type
+  {
+    if constexpr (Multi) {
+      return this->insert_at(this->upper(key), detail::forward<K>(key),
+                             detail::forward<Args>(args)...);
+    }
+    else {
+      auto const pos = this->lower(key);
+      if (pos < keys_.size() && !comp_(key, keys_[pos])) {
+        return {this->it(pos), false};
+      }
+      return {this->insert_at(pos, detail::forward<K>(key),
+                              detail::forward<Args>(args)...),
+              true};
+    }
+  }
+
+ public:
+  basic_flat_map() = default;
+
+  explicit basic_flat_map(Compare const& comp)
+      : comp_(comp)
+  {
+  }
+
+  // Takes over `keys` and `values` and sorts them by key. Throws
+  // `less::out_of_range` if they differ in size.
+  //
+  basic_flat_map(vector<Key> keys, vector<T> values,
+                 Compare const& comp = Compare())
+      : keys_(detail::move(keys))
+      , values_(detail::move(values))
+      , comp_(comp)
+  {
+    if (keys_.size() != values_.size()) { throw out_of_range{}; }
+
+    detail::flat_merge(keys_, 0u, comp_, !Multi, values_);
+  }
+
+  template <class InputIt>
+  basic_flat_map(InputIt first, InputIt last, Compare const& comp = Compare())
+      : comp_(comp)
+  {
+    this->insert(first, last);
+  }
+
+  basic_flat_map(std::initializer_list<value_type> ilist,
+                 Compare const&                    comp = Compare())
+      : basic_flat_map(ilist.begin(), ilist.end(), comp)
+  {
+  }
+
+  auto begin() noexcept -> iterator
+  {
+    return this->it(0);
+  }
+
+  auto end() noexcept -> iterator
+  {
+    return this->it(keys_.size());
+  }
+
+  auto begin() const noexcept -> const_iterator
+  {
+    return this->it(0);
+  }
+
+  auto end() const noexcept -> const_iterator
+  {
+    return this->it(keys_.size());
+  }
+
+  auto cbegin() const noexcept -> const_iterator
+  {
+    return this->begin();
+  }
+
+  auto cend() const noexcept -> const_iterator
+  {
+    return this->end();
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return keys_.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return keys_.empty();
+  }
+
+  void reserve(size_type capacity)
+  {
+    keys_.reserve(capacity);
+    values_.reserve(capacity);
+  }
+
+  void clear() noexcept
+  {
+    keys_.clear();
+    values_.clear();
+  }
+
+  auto key_comp() const -> Compare
+  {
+    return comp_;
+  }
+
+  // The sorted keys, and the values in the same order.
+  //
+  auto keys() const noexcept -> vector<Key> const&
+  {
+    return keys_;
+  }
+
+  auto values() const noexcept -> vector<T> const&
+  {
+    return values_;
+  }
+
+  auto lower_bound(Key const& key) -> iterator
+  {
+    return this->it(this->lower(key));
+  }
+
+  auto lower_bound(Key const& key) const -> const_iterator
+  {
+    return this->it(this->lower(key));
+  }
+
+  auto upper_bound(Key const& key) -> iterator
+  {
+    return this->it(this->upper(key));
+  }
+
+  auto upper_bound(Key const& key) const -> const_iterator
+  {
+    return this->it(this->upper(key));
+  }
+
+  auto equal_range(Key const& key) -> std::pair<iterator, iterator>
+  {
+    return {this->lower_bound(key), this->upper_bound(key)};
+  }
+
+  auto equal_range(Key const& key) const
+      -> std::pair<const_iterator, const_iterator>
+  {
+    return {this->lower_bound(key), this->upper_bound(key)};
+  }
+
+  auto find(Key const& key) -> iterator
+  {
+    return this->it(this->index_of(key));
+  }
+
+  auto find(Key const& key) const -> const_iterator
+  {
+    return this->it(this->index_of(key));
+  }
+
+  bool contains(Key const& key) const
+  {
+    return this->index_of(key) != keys_.size();
+  }
+
+  auto count(Key const& key) const -> size_type
+  {
+    if constexpr (Multi) {
+      return this->upper(key) - this->lower(key);
+    }
+    else {
+      return this->contains(key) ? 1u : 0u;
+    }
+  }
+
+  auto at(Key const& key) -> T&
+  {
+    auto const pos = this->index_of(key);
+    if (pos == keys_.size()) { throw out_of_range{}; }
+    return values_[pos];
+  }
+
+  auto at(Key const& key) const -> T const&
+  {
+    auto const pos = this->index_of(key);
+    if (pos == keys_.size()) { throw out_of_range{}; }
+    return values_[pos];
+  }
+
+  auto operator[](Key const& key) -> T&
+  {
+    static_assert(!Multi, "less::flat_multimap has no operator[]");
+    return this->emplace_impl(key).first.value();
+  }
+
+  auto operator[](Key&& key) -> T&
+  {
+    static_assert(!Multi, "less::flat_multimap has no operator[]");
+    return this->emplace_impl(detail::move(key)).first.value();
+  }
+
+  template <class... Args>
+  auto emplace(Key const& key, Args&&... args) -> insert_return_type
+  {
+    return this->emplace_impl(key, detail::forward<Args>(args)...);
+  }
+
+  template <class... Args>
+  auto emplace(Key&& key, Args&&... args) -> insert_return_type
+  {
+    return this->emplace_impl(detail::move(key),
+                              detail::forward<Args>(args)...);
+  }
+
+  auto insert(value_type const& kv) -> insert_return_type
+  {
+    return this->emplace_impl(kv.first, kv.second);
+  }
+
+  auto insert(value_type&& kv) -> insert_return_type
+  {
+    return this->emplace_impl(detail::move(kv.first), detail::move(kv.second));
+  }
+
+  template <class M>
+  auto insert_or_assign(Key const& key, M&& value) -> std::pair<iterator, bool>
+  {
+    static_assert(!Multi, "less::flat_multimap has no insert_or_assign()");
+    auto r = this->emplace_impl(key, detail::forward<M>(value));
+    if (!r.second) { r.first.value() = detail::forward<M>(value); }
+    return r;
+  }
+
+  // Appends the whole range of key/value pairs, then sorts and merges it in
+  // one go, which is O(n + m log m) instead of m separate O(n) inserts.
+  //
+  template <class InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    auto const mid = keys_.size();
+    try {
+      for (; first != last; ++first) {
+        auto&& kv = *first;
+        keys_.emplace_back(kv.first);
+        values_.emplace_back(kv.second);
+      }
+    }
+    catch (...) {
+      keys_.erase(keys_.begin() + mid, keys_.end());
+      values_.erase(values_.begin() + mid, values_.end());
+      throw;
+    }
+    detail::flat_merge(keys_, mid, comp_, !Multi, values_);
+  }
+
+  void insert(std::initializer_list<value_type> ilist)
+  {
+    this->insert(ilist.begin(), ilist.end());
+  }
+
+  auto erase(const_iterator pos) -> iterator
+  {
+    auto const i = static_cast<size_type>(pos - this->cbegin());
+    keys_.erase(keys_.begin() + i);
+    values_.erase(values_.begin() + i);
+    return this->it(i);
+  }
+
+  auto erase(Key const& key) -> size_type
+  {
+    auto const first = this->lower(key);
+    auto const last  = this->upper(key);
+    keys_.erase(keys_.begin() + first, keys_.begin() + last);
+    values_.erase(values_.begin() + first, values_.begin() + last);
+    return last - first;
+  }
+
+  void swap(basic_flat_map& other) noexcept
+  {
+    using std::swap;
+    keys_.swap(other.keys_);
+    values_.swap(other.values_);
+    swap(comp_, other.comp_);
+  }
+
+  friend bool operator==(basic_flat_map const& lhs, basic_flat_map const& rhs)
+  {
+    return lhs.keys_ == rhs.keys_ && lhs.values_ == rhs.values_;
+  }
+
+  friend bool operator!=(basic_flat_map const& lhs, basic_flat_map const& rhs)
+  {
+    return !(lhs == rhs);
+  }
+};
+
+template <class Key, class T, class Compare = std::less<Key>>
+using flat_map = basic_flat_map<Key, T, Compare, false>;
+
+template <class Key, class T, class Compare = std::less<Key>>
+using flat_multimap = basic_flat_map<Key, T, Compare, true>;
+
+}    // namespace less
+
+#endif    // LESS_FLAT_MAP_HPP
@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_FLAT_SET_HPP
+#define LESS_FLAT_SET_HPP
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+// Binary search without a data-dependent branch: the range only ever halves,
+// and which half is kept compiles to a conditional move, so a lookup costs
+// log2(n) comparisons and no mispredictions.
+//
+template <class Key, class K, class Compare>
+auto flat_lower_bound(Key const* first, unsigned_long_type n, K const& key,
+                      Compare const& comp) -> unsigned_long_type
+{
+  if (n == 0) { return 0; }
+
+  auto base = first;
+  while (n > 1) {
+    auto const half = n / 2;
+    base            = comp(base[half], key) ? base + half : base;
+    n -= half;
+  }
+  return static_cast<unsigned_long_type>(base - first) +
+         (comp(*base, key) ? 1u : 0u);
+}
+
+template <class Key, class K, class Compare>
+auto flat_upper_bound(Key const* first, unsigned_long_type n, K const& key,
+                      Compare const& comp) -> unsigned_long_type
+{
+  if (n == 0) { return 0; }
+
+  auto base = first;
+  while (n > 1) {
+    auto const half = n / 2;
+    base            = comp(key, base[half]) ? base : base + half;
+    n -= half;
+  }
+  return static_cast<unsigned_long_type>(base - first) +
+         (comp(key, *base) ? 0u : 1u);
+}
+
+// Sorts `keys[mid, size)` and merges it into the sorted `keys[0, mid)`,
+// applying the same moves to each of `values`. Equivalent keys keep their
+// insertion order; with `unique` only the first of them survives, so keys
+// already present win over new ones.
+//
+// The tail is sorted through an index permutation and moved out to a buffer
+// once, then merged from the back so nothing in front of the first new key
+// moves at all.
+//
+template <class Key, class Compare, class... Values>
+void flat_merge(vector<Key>& keys, unsigned_long_type mid, Compare const& comp,
+                bool unique, vector<Values>&... values)
+{
+  using size_type = unsigned_long_type;
+
+  auto const n = keys.size();
+  auto const m = n - mid;
+  if (m == 0) { return; }
+
+  auto order = vector<size_type>(default_init, m);
+  for (auto i = size_type{0}; i < m; ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](size_type a, size_type b) {
+    auto const& x = keys[mid + a];
+    auto const& y = keys[mid + b];
+    return comp(x, y) || (!comp(y, x) && a < b);
+  });
+
+  auto tail_keys = vector<Key>(with_capacity, m);
+  auto tails     = std::make_tuple(vector<Values>(with_capacity, m)...);
+  for (auto i = size_type{0}; i < m; ++i) {
+    tail_keys.emplace_back(detail::move(keys[mid + order[i]]));
+    std::apply(
+        [&](auto&... tail) {
+          (tail.emplace_back(detail::move(values[mid + order[i]])), ...);
+        },
+        tails);
+  }
+
+  // on ties the new key goes further back, behind the existing one
+  //
+  auto i   = mid;
+  auto j   = m;
+  auto out = n;
+  while (j > 0) {
+    --out;
+    if (i > 0 && comp(tail_keys[j - 1], keys[i - 1])) {
+      --i;
+      keys[out] = detail::move(keys[i]);
+      ((values[out] = detail::move(values[i])), ...);
+    }
+    else {
+      --j;
+      keys[out] = detail::move(tail_keys[j]);
+      std::apply(
+          [&](auto&... tail) {
+            ((values[out] = detail::move(tail[j])), ...);
+          },
+          tails);
+    }
+  }
+
+  if (!unique) { return; }
+
+  // `out` is the first slot the merge wrote, and everything before it was
+  // already unique
+  //
+  auto w = (out == 0 ? size_type{1} : out);
+  for (auto r = w; r < n; ++r) {
+    if (comp(keys[w - 1], keys[r])) {
+      if (w != r) {
+        keys[w] = detail::move(keys[r]);
+        ((values[w] = detail::move(values[r])), ...);
+      }
+      ++w;
+    }
+  }
+  keys.erase(keys.begin() + w, keys.end());
+  ((values.erase(values.begin() + w, values.end())), ...);
+}
+
+}    // namespace detail
+
+// Sorted set over a single `less::vector<Key>`; `flat_set` keeps unique keys
+// and `flat_multiset` keeps duplicates in insertion order. Iterators are
+// pointers into the vector and are invalidated by any insert or erase.
+//
+template <class Key, class Compare, bool Multi>
+struct basic_flat_set {
+ public:
+  using key_type       = Key;
+  using value_type     = Key;
+  using key_compare    = Compare;
+  using size_type      = unsigned_long_type;
+  using iterator       = Key const*;
+  using const_iterator = Key const*;
+
+  using insert_return_type =
+      std::conditional_t<Multi, iterator, std::pair<iterator, bool>>;
+
+ private:
+  vector<Key> keys_;
+  Compare     comp_;
+
+  auto lower(Key const& key) const -> size_type
+  {
+    return detail::flat_lower_bound(keys_.data(), keys_.size(), key, comp_);
+  }
+
+  auto upper(Key const& key) const -> size_type
+  {
+    return detail::flat_upper_bound(keys_.data(), keys_.size(), key, comp_);
+  }
+
+  template <class K>
+  auto insert_impl(K&& key) -> insert_return_type
+  {
+    if constexpr (Multi) {
+      auto const pos = this->upper(key);
+      keys_.insert(keys_.begin() + pos, detail::forward<K>(key));
+      return keys_.data() + pos;
+    }
+    else {
+      auto const pos = this->lower(key);
+      if (pos < keys_.size() && !comp_(key, keys_[pos])) {
+        return {keys_.data() + pos, false};
+      }
+      keys_.insert(keys_.begin() + pos, detail::forward<K>(key));
+      return {keys_.data() + pos, true};
+    }
+  }
+
+ public:
+  basic_flat_set() = default;
+
+  explicit basic_flat_set(Compare const& comp)
+      : comp_(comp)
+  {
+  }
+
+  // Takes over `keys` and sorts them.
+  //
+  explicit basic_flat_set(vector<Key> keys, Compare const& comp = Compare())
+      : keys_(detail::move(keys))
+      , comp_(comp)
+  {
+    detail::flat_merge(keys_, 0u, comp_, !Multi);
+  }
+
+  template <class InputIt>
+  basic_flat_set(InputIt first, InputIt last, Compare const& comp = Compare())
+      : comp_(comp)
+  {
+    this->insert(first, last);
+  }
+
+  basic_flat_set(std::initializer_list<Key> ilist,
+                 Compare const&             comp = Compare())
+      : basic_flat_set(ilist.begin(), ilist.end(), comp)
+  {
+  }
+
+  auto begin() const noexcept -> const_iterator
+  {
+    return keys_.data();
+  }
+
+  auto end() const noexcept -> const_iterator
+  {
+    return keys_.data() + keys_.size();
+  }
+
+  auto cbegin() const noexcept -> const_iterator
+  {
+    return this->begin();
+  }
+
+  auto cend() const noexcept -> const_iterator
+  {
+    return this->end();
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return keys_.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return keys_.empty();
+  }
+
+  auto capacity() const noexcept -> size_type
+  {
+    return keys_.capacity();
+  }
+
+  void reserve(size_type capacity)
+  {
+    keys_.reserve(capacity);
+  }
+
+  void clear() noexcept
+  {
+    keys_.clear();
+  }
+
+  auto key_comp() const -> Compare
+  {
+    return comp_;
+  }
+
+  // The sorted keys.
+  //
+  auto keys() const noexcept -> vector<Key> const&
+  {
+    return keys_;
+  }
+
+  // Moves the sorted keys out, leaving the set empty.
+  //
+  auto extract() -> vector<Key>
+  {
+    auto keys = detail::move(keys_);
+    keys_.clear();
+    return keys;
+  }
+
+  auto lower_bound(Key const& key) const -> const_iterator
+  {
+    return keys_.data() + this->lower(key);
+  }
+
+  auto upper_bound(Key const& key) const -> const_iterator
+  {
+    return keys_.data() + this->upper(key);
+  }
+
+  auto equal_range(Key const& key) const
+      -> std::pair<const_iterator, const_iterator>
+  {
+    return {this->lower_bound(key), this->upper_bound(key)};
+  }
+
+  auto find(Key const& key) const -> const_iterator
+  {
+    auto const pos = this->lower(key);
+    if (pos < keys_.size() && !comp_(key, keys_[pos])) {
+      return keys_.data() + pos;
+    }
+    return this->end();
+  }
+
+  bool contains(Key const& key) const
+  {
+    return this->find(key) != this->end();
+  }
+
+  auto count(Key const& key) const -> size_type
+  {
+    if constexpr (Multi) {
+      return this->upper(key) - this->lower(key);
+    }
+    else {
+      return this->contains(key) ? 1u : 0u;
+    }
+  }
+
+  auto insert(Key const& key) -> insert_return_type
+  {
+    return this->insert_impl(key);
+  }
+
+  auto insert(Key&& key) -> insert_return_type
+  {
+    return this->insert_impl(detail::move(key));
+  }
+
+  // Appends the whole range, then sorts and merges it in one go, which is
+  // O(n + m log m) instead of m separate O(n) inserts.
+  //
+  template <class InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    auto const mid = keys_.size();
+    try {
+      for (; first != last; ++first) {
+        keys_.emplace_back(*first);
+      }
+    }
+    catch (...) {
+      keys_.erase(keys_.begin() + mid, keys_.end());
+      throw;
+    }
+    detail::flat_merge(keys_, mid, comp_, !Multi);
+  }
+
+  void insert(std::initializer_list<Key> ilist)
+  {
+    this->insert(ilist.begin(), ilist.end());
+  }
+
+  auto erase(const_iterator pos) -> iterator
+  {
+    return keys_.erase(pos);
+  }
+
+  auto erase(const_iterator first, const_iterator last) -> iterator
+  {
+    return keys_.erase(first, last);
+  }
+
+  auto erase(Key const& key) -> size_type
+  {
+    auto const first = this->lower(key);
+    auto const last  = this->upper(key);
+    keys_.erase(keys_.begin() + first, keys_.begin() + last);
+    return last - first;
+  }
+
+  void swap(basic_flat_set& other) noexcept
+  {
+    using std::swap;
+    keys_.swap(other.keys_);
+    swap(comp_, other.comp_);
+  }
+
+  friend bool operator==(basic_flat_set const& lhs, basic_flat_set const& rhs)
+  {
+    return lhs.keys_ == rhs.keys_;
+  }
+
+  friend bool operator!=(basic_flat_set const& lhs, basic_flat_set const& rhs)
+  {
+    return !(lhs == rhs);
+  }
+};
+
+template <class Key, class Compare = std::less<Key>>
+using flat_set = basic_flat_set<Key, Compare, false>;
+
+template <class Key, class Compare = std::less<Key>>
+using flat_multiset = basic_flat_set<Key, Compare, true>;
+
+}    // namespace less
+
+#endif    // LESS_FLAT_SET_HPP
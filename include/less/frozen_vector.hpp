@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_FROZEN_VECTOR_HPP
+#define LESS_FROZEN_VECTOR_HPP
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+struct frozen_header {
+  std::atomic<unsigned_long_type> refs{1u};
+
+  // of the buffer, in elements, so `thaw()` can hand all of it back
+  //
+  unsigned_long_type capacity = 0u;
+};
+
+}    // namespace detail
+
+// An immutable, reference-counted `less::vector`.
+//
+// `vector::freeze()` turns a vector into one. The elements and the reference
+// count share a single allocation: the count is placed in the vector's unused
+// capacity when there's room for it, making the freeze O(1), and otherwise the
+// elements are moved once into a buffer just large enough for both.
+//
+// Copies share the buffer and only bump the count, so handing the same
+// elements to any number of tasks costs nothing per copy. The count is atomic
+// and copies can be made and dropped on any thread.
+//
+// `thaw()` turns it back into a `less::vector`, taking the buffer over when
+// this is its only owner and copying the elements otherwise.
+//
+template <class T>
+struct frozen_vector {
+ public:
+  using value_type      = T;
+  using size_type       = unsigned_long_type;
+  using difference_type = long_type;
+  using reference       = T const&;
+  using const_reference = T const&;
+  using pointer         = T const*;
+  using const_pointer   = T const*;
+  using iterator        = const_pointer;
+  using const_iterator  = const_pointer;
+
+ private:
+  using header = detail::frozen_header;
+
+  T*        p_    = nullptr;
+  size_type size_ = 0u;
+  header*   h_    = nullptr;
+
+  // where the header goes in a buffer holding `size` elements
+  //
+  static constexpr auto header_offset(size_type size) noexcept -> size_type
+  {
+    constexpr auto const align = alignof(header);
+    return (size * sizeof(T) + align - 1) / align * align;
+  }
+
+  // takes over `v`'s buffer, which must have room for the header
+  //
+  void adopt(vector<T>& v) noexcept
+  {
+    auto const bytes = reinterpret_cast<char*>(v.p_);
+
+    p_    = v.p_;
+    size_ = v.size_;
+    h_    = new (bytes + header_offset(v.size_), detail::placement_tag_t{})
+        header();
+    h_->capacity = v.capacity_;
+
+    v.p_        = nullptr;
+    v.size_     = 0u;
+    v.capacity_ = 0u;
+  }
+
+  void release() noexcept
+  {
+    if (!h_) { return; }
+
+    if (h_->refs.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+      for (auto i = size_type{0}; i < size_; ++i) {
+        p_[i].~T();
+      }
+      h_->~header();
+      ::operator delete(p_);
+    }
+
+    p_    = nullptr;
+    size_ = 0u;
+    h_    = nullptr;
+  }
+
+ public:
+  frozen_vector() noexcept
+  {
+  }
+
+  explicit frozen_vector(vector<T>&& v)
+  {
+    if (!v.p_) { return; }
+
+    auto const needed = header_offset(v.size_) + sizeof(header);
+    if (needed <= v.capacity_ * sizeof(T)) {
+      this->adopt(v);
+      return;
+    }
+
+    auto buf = vector<T>(with_capacity, (needed + sizeof(T) - 1) / sizeof(T));
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (v.size_ > 0) { std::memcpy(buf.p_, v.p_, v.size_ * sizeof(T)); }
+      buf.size_ = v.size_;
+    }
+    else {
+      for (auto& x : v) {
+        buf.emplace_back(detail::move_if_noexcept(x));
+      }
+    }
+
+    v = vector<T>();
+    this->adopt(buf);
+  }
+
+  frozen_vector(frozen_vector const& rhs) noexcept
+      : p_(rhs.p_)
+      , size_(rhs.size_)
+      , h_(rhs.h_)
+  {
+    if (h_) { h_->refs.fetch_add(1u, std::memory_order_relaxed); }
+  }
+
+  frozen_vector(frozen_vector&& rhs) noexcept
+      : p_(rhs.p_)
+      , size_(rhs.size_)
+      , h_(rhs.h_)
+  {
+    rhs.p_    = nullptr;
+    rhs.size_ = 0u;
+    rhs.h_    = nullptr;
+  }
+
+  ~frozen_vector()
+  {
+    this->release();
+  }
+
+  auto operator=(frozen_vector const& rhs) noexcept -> frozen_vector&
+  {
+    auto tmp = frozen_vector(rhs);
+    this->swap(tmp);
+    return *this;
+  }
+
+  auto operator=(frozen_vector&& rhs) noexcept -> frozen_vector&
+  {
+    auto tmp = frozen_vector(detail::move(rhs));
+    this->swap(tmp);
+    return *this;
+  }
+
+  // Element access
+
+  auto at(size_type const pos) const -> const_reference
+  {
+    if (pos >= size_) { throw out_of_range{}; }
+
+    return p_[pos];
+  }
+
+  auto operator[](size_type const pos) const -> const_reference
+  {
+    return p_[pos];
+  }
+
+  auto front() const -> const_reference
+  {
+    return p_[0];
+  }
+
+  auto back() const -> const_reference
+  {
+    return p_[size_ - 1];
+  }
+
+  auto data() const noexcept -> T const*
+  {
+    return p_;
+  }
+
+  // Iterators
+
+  auto begin() const noexcept -> const_iterator
+  {
+    return p_;
+  }
+
+  auto cbegin() const noexcept -> const_iterator
+  {
+    return p_;
+  }
+
+  auto end() const noexcept -> const_iterator
+  {
+    return p_ + size_;
+  }
+
+  auto cend() const noexcept -> const_iterator
+  {
+    return p_ + size_;
+  }
+
+  // Capacity
+
+  bool empty() const noexcept
+  {
+    return size_ == 0u;
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return size_;
+  }
+
+  // number of `frozen_vector`s sharing the buffer, 0 when there's none; only
+  // a hint while other threads copy or drop theirs
+  //
+  auto use_count() const noexcept -> size_type
+  {
+    return h_ ? h_->refs.load(std::memory_order_relaxed) : 0u;
+  }
+
+  // Modifiers
+
+  // Returns the elements as a `less::vector`, leaving this empty. The buffer
+  // is handed over as is when nothing else shares it and copied otherwise.
+  //
+  auto thaw() -> vector<T>
+  {
+    auto v = vector<T>();
+    if (!h_) { return v; }
+
+    if (h_->refs.load(std::memory_order_acquire) == 1u) {
+      v.p_        = p_;
+      v.size_     = size_;
+      v.capacity_ = h_->capacity;
+      h_->~header();
+
+      p_    = nullptr;
+      size_ = 0u;
+      h_    = nullptr;
+      return v;
+    }
+
+    v = vector<T>(p_, p_ + size_);
+    this->release();
+    return v;
+  }
+
+  void swap(frozen_vector& other) noexcept
+  {
+    auto const p    = other.p_;
+    auto const size = other.size_;
+    auto const h    = other.h_;
+
+    other.p_    = p_;
+    other.size_ = size_;
+    other.h_    = h_;
+
+    p_    = p;
+    size_ = size;
+    h_    = h;
+  }
+};
+
+template <class T>
+bool operator==(frozen_vector<T> const& lhs, frozen_vector<T> const& rhs)
+{
+  if (lhs.size() != rhs.size()) { return false; }
+  if (lhs.data() == rhs.data()) { return true; }
+
+  for (auto i = 0u; i < lhs.size(); ++i) {
+    if (!(lhs[i] == rhs[i])) { return false; }
+  }
+  return true;
+}
+
+template <class T>
+bool operator!=(frozen_vector<T> const& lhs, frozen_vector<T> const& rhs)
+{
+  return !(lhs == rhs);
+}
+
+}    // namespace less
+
+#endif    // LESS_FROZEN_VECTOR_HPP
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_IO_HPP
+#define LESS_IO_HPP
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "<less/io.hpp> requires a POSIX system"
+#endif
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <less/system_error.hpp>
+#include <less/vector.hpp>
+
+// Regular files of at least two of these chunks are read with concurrent
+// `pread()` calls when `<less/thread_pool.hpp>` was included before this
+// header.
+//
+#ifndef LESS_PARALLEL_READ_GRAIN
+#define LESS_PARALLEL_READ_GRAIN (1u << 24)
+#endif
+
+namespace less {
+namespace detail {
+
+// Reads until `size` bytes arrived or the end of the file is hit, returning
+// the number of bytes read. A negative `offset` reads from the current file
+// position so pipes and sockets work too. On failure `error` is set to `errno`
+// and the bytes read so far are returned.
+//
+inline auto read_fully(int fd, void* buf, unsigned_long_type size,
+                       long_type offset, int& error) noexcept
+    -> unsigned_long_type
+{
+  auto const p = static_cast<unsigned char*>(buf);
+
+  auto total = unsigned_long_type{0};
+  while (total < size) {
+    auto const n =
+        (offset < 0 ? ::read(fd, p + total, size - total)
+                    : ::pread(fd, p + total, size - total,
+                              static_cast<off_t>(offset + total)));
+    if (n == 0) { break; }
+    if (n < 0) {
+      if (errno == EINTR) { continue; }
+      error = errno;
+      break;
+    }
+    total += static_cast<unsigned_long_type>(n);
+  }
+  return total;
+}
+
+// Writes all of `buf` at `offset`, throwing `less::system_error` on failure.
+//
+inline void pwrite_fully(int fd, void const* buf, unsigned_long_type size,
+                         unsigned_long_type offset)
+{
+  auto p = static_cast<char const*>(buf);
+  while (size > 0) {
+    auto const n = ::pwrite(fd, p, size, static_cast<off_t>(offset));
+    if (n == -1) {
+      if (errno == EINTR) { continue; }
+      detail::throw_errno();
+    }
+
+    p += n;
+    size -= static_cast<unsigned_long_type>(n);
+    offset += static_cast<unsigned_long_type>(n);
+  }
+}
+
+// Appends to `out` until the end of the file, growing the capacity
+// geometrically. `offset` is the file position matching `out.size()` or
+// negative to use `read()`.
+//
+template <class T>
+void read_stream(int fd, vector<T>& out, long_type offset, int& error)
+{
+  constexpr unsigned_long_type const min_chunk = 1u << 16;
+
+  auto const start = out.size();
+  while (true) {
+    auto const size = out.size();
+    auto const cap  = out.capacity();
+
+    auto const pos =
+        (offset < 0 ? offset : offset + static_cast<long_type>(size - start));
+
+    // a full buffer is often full because we read exactly to the end, so we
+    // peek before paying for a reallocation
+    //
+    if (size == cap) {
+      T    peek[512];
+      auto got = read_fully(fd, peek, sizeof(peek), pos, error);
+      if (error != 0 || got == 0) { return; }
+
+      out.reserve(cap + (cap < min_chunk ? min_chunk : cap));
+      out.insert(out.end(), peek, peek + got);
+      if (got < sizeof(peek)) { return; }
+      continue;
+    }
+
+    auto target = cap;
+    if (target - size < min_chunk) {
+      target = (2 * cap < size + min_chunk ? size + min_chunk : 2 * cap);
+    }
+
+    auto got = unsigned_long_type{0};
+    out.resize_and_overwrite(target, [&](T* p, unsigned_long_type n) {
+      got = read_fully(fd, p + size, n - size, pos, error);
+      return size + got;
+    });
+
+    if (error != 0 || got < target - size) { return; }
+  }
+}
+
+#ifdef LESS_THREAD_POOL_HPP
+// Reads `count` bytes at `offset` with one `pread()` per chunk spread over the
+// thread pool. Returns false without doing anything if the range is too small
+// to be worth it.
+//
+template <class T>
+auto read_parallel(int fd, vector<T>& out, unsigned_long_type count,
+                   long_type offset, int& error) -> bool
+{
+  constexpr unsigned_long_type const grain = LESS_PARALLEL_READ_GRAIN;
+  if (count < 2 * grain) { return false; }
+
+  auto const size = out.size();
+
+  // the first short chunk marks where the file ended, if it shrank
+  //
+  auto m   = std::mutex();
+  auto end = count;
+  out.resize_and_overwrite(size + count, [&](T* p, unsigned_long_type) {
+    detail::parallel_chunks(
+        count, grain,
+        [&](unsigned_long_type first, unsigned_long_type last) {
+          auto e   = 0;
+          auto got = read_fully(fd, p + size + first, last - first,
+                                offset + static_cast<long_type>(first), e);
+          if (e == 0 && got == last - first) { return; }
+
+          auto lock = std::lock_guard<std::mutex>(m);
+          if (e != 0 && error == 0) { error = e; }
+          if (first + got < end) { end = first + got; }
+        },
+        [](unsigned_long_type, unsigned_long_type) {});
+    return size + end;
+  });
+
+  return true;
+}
+#endif
+
+}    // namespace detail
+
+// Appends everything that can be read from `fd` to `out`, leaving the file
+// offset at the end of the data.
+//
+// Regular files are sized up front with `fstat()` and read with `pread()`,
+// split into concurrent chunks when `<less/thread_pool.hpp>` was included
+// first and the file spans at least two `LESS_PARALLEL_READ_GRAIN` chunks.
+// Anything else, like pipes, sockets or procfs files that report a size of
+// zero, is read with `read()` into geometrically growing capacity.
+//
+// Throws `less::system_error` if a read fails, in which case `out` holds its
+// original elements again.
+//
+template <class T>
+void read_all(int fd, vector<T>& out)
+{
+  static_assert(sizeof(T) == 1, "less::read_all reads into byte vectors");
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) { detail::throw_errno(); }
+
+  auto offset = long_type{-1};
+  if (S_ISREG(st.st_mode)) {
+    auto const pos = lseek(fd, 0, SEEK_CUR);
+    if (pos >= 0) { offset = static_cast<long_type>(pos); }
+  }
+
+  auto const start = out.size();
+  auto       error = 0;
+
+  if (offset >= 0 && st.st_size > offset) {
+    auto const count = static_cast<unsigned_long_type>(st.st_size - offset);
+
+    out.reserve(start + count);
+
+#ifdef LESS_THREAD_POOL_HPP
+    auto const done = detail::read_parallel(fd, out, count, offset, error);
+#else
+    auto const done = false;
+#endif
+
+    if (!done) {
+      out.resize_and_overwrite(start + count, [&](T* p, unsigned_long_type) {
+        return start + detail::read_fully(fd, p + start, count, offset, error);
+      });
+    }
+  }
+
+  // even a sized file could have grown since `fstat()`, so we always read on
+  // until we hit the end
+  //
+  auto const read_so_far = [&] {
+    return static_cast<long_type>(out.size() - start);
+  };
+
+  if (error == 0) {
+    detail::read_stream(fd, out, offset < 0 ? offset : offset + read_so_far(),
+                        error);
+  }
+
+  if (error != 0) {
+    out.resize(start);
+    throw system_error{error};
+  }
+
+  if (offset >= 0) {
+    lseek(fd, static_cast<off_t>(offset + read_so_far()), SEEK_SET);
+  }
+}
+
+template <class T = char>
+auto read_all(int fd) -> vector<T>
+{
+  auto out = vector<T>();
+  less::read_all(fd, out);
+  return out;
+}
+
+template <class T = char>
+auto read_file(char const* path) -> vector<T>
+{
+  auto const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) { detail::throw_errno(); }
+
+  try {
+    auto out = less::read_all<T>(fd);
+    ::close(fd);
+    return out;
+  }
+  catch (...) {
+    ::close(fd);
+    throw;
+  }
+}
+
+}    // namespace less
+
+#endif    // LESS_IO_HPP
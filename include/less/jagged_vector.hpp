@@ -0,0 +1,433 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_JAGGED_VECTOR_HPP
+#define LESS_JAGGED_VECTOR_HPP
+
+#include <initializer_list>
+
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+// a row of a `less::jagged_vector`: a pointer and a length
+//
+template <class T>
+struct jagged_span {
+ public:
+  using value_type = T;
+  using size_type  = unsigned_long_type;
+  using iterator   = T*;
+
+ private:
+  T*        p_ = nullptr;
+  size_type n_ = 0;
+
+ public:
+  jagged_span() = default;
+
+  jagged_span(T* p, size_type n) noexcept
+      : p_(p)
+      , n_(n)
+  {
+  }
+
+  auto data() const noexcept -> T*
+  {
+    return p_;
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return n_;
+  }
+
+  bool empty() const noexcept
+  {
+    return n_ == 0;
+  }
+
+  auto begin() const noexcept -> iterator
+  {
+    return p_;
+  }
+
+  auto end() const noexcept -> iterator
+  {
+    return p_ + n_;
+  }
+
+  auto operator[](size_type i) const noexcept -> T&
+  {
+    return p_[i];
+  }
+
+  auto front() const noexcept -> T&
+  {
+    return p_[0];
+  }
+
+  auto back() const noexcept -> T&
+  {
+    return p_[n_ - 1];
+  }
+};
+
+template <class T>
+struct is_jagged_span : false_type {};
+
+template <class T>
+struct is_jagged_span<jagged_span<T>> : true_type {};
+
+}    // namespace detail
+
+// A vector of variable-length rows in compressed sparse row (CSR) form: all
+// values in one `less::vector<T>` and row `i` spanning
+// `[offsets[i], offsets[i + 1])` of it. That's two allocations in total
+// instead of one per row, and rows are adjacent in memory.
+//
+// Shrinking a row that isn't last leaves a gap after it. The first such edit
+// starts tracking each row's end separately, and `compact()` closes the gaps
+// and goes back to plain offsets, so a batch of edits costs one pass.
+//
+template <class T>
+struct jagged_vector {
+ public:
+  using value_type     = T;
+  using size_type      = unsigned_long_type;
+  using row_type       = detail::jagged_span<T>;
+  using const_row_type = detail::jagged_span<T const>;
+
+ private:
+  vector<T>         values_;
+  vector<size_type> offsets_;
+
+  // empty while there are no gaps
+  //
+  vector<size_type> ends_;
+
+  auto row_end(size_type i) const noexcept -> size_type
+  {
+    return ends_.empty() ? offsets_[i + 1] : ends_[i];
+  }
+
+  void track_ends()
+  {
+    if (!ends_.empty() || this->rows() == 0) { return; }
+    ends_ = vector<size_type>(offsets_.begin() + 1, offsets_.end());
+  }
+
+  // Shrinks row `i` to `n` values. The last row gives its space back right
+  // away, so appends always land directly after it.
+  //
+  void shrink_row(size_type i, size_type n)
+  {
+    auto const first = offsets_[i];
+    if (i + 1 == this->rows()) {
+      values_.erase(values_.begin() + first + n, values_.end());
+      offsets_[i + 1] = values_.size();
+      if (!ends_.empty()) { ends_[i] = values_.size(); }
+      return;
+    }
+
+    this->track_ends();
+    ends_[i] = first + n;
+  }
+
+ public:
+  jagged_vector()
+      : offsets_(1u, size_type{0})
+  {
+  }
+
+  // Groups `(row, value)` pairs into `rows` rows with a counting sort: one
+  // pass counts each row, the next places every value. Values keep their
+  // input order within a row.
+  //
+  template <class ForwardIt>
+  static auto build(size_type rows, ForwardIt first, ForwardIt last)
+      -> jagged_vector
+  {
+    auto v     = jagged_vector();
+    v.offsets_ = vector<size_type>(rows + 1, size_type{0});
+
+    auto n = size_type{0};
+    for (auto it = first; it != last; ++it) {
+      auto const row = static_cast<size_type>((*it).first);
+      if (row >= rows) { throw out_of_range{}; }
+      ++v.offsets_[row + 1];
+      ++n;
+    }
+
+    for (auto i = size_type{0}; i < rows; ++i) {
+      v.offsets_[i + 1] += v.offsets_[i];
+    }
+
+    auto cursor = vector<size_type>(v.offsets_.begin(), v.offsets_.end() - 1);
+    v.values_   = vector<T>(default_init, n);
+    for (auto it = first; it != last; ++it) {
+      auto const row = static_cast<size_type>((*it).first);
+      v.values_[cursor[row]++] = (*it).second;
+    }
+
+    return v;
+  }
+
+  auto rows() const noexcept -> size_type
+  {
+    return offsets_.size() - 1;
+  }
+
+  bool empty() const noexcept
+  {
+    return this->rows() == 0;
+  }
+
+  // Total number of values in all rows.
+  //
+  auto value_count() const noexcept -> size_type
+  {
+    return values_.size() - this->slack();
+  }
+
+  // Number of unused slots left behind by shrinking rows.
+  //
+  auto slack() const noexcept -> size_type
+  {
+    if (ends_.empty()) { return 0; }
+
+    auto n = size_type{0};
+    for (auto i = size_type{0}; i < this->rows(); ++i) {
+      n += offsets_[i + 1] - ends_[i];
+    }
+    return n;
+  }
+
+  void reserve(size_type rows, size_type values)
+  {
+    offsets_.reserve(rows + 1);
+    values_.reserve(values);
+  }
+
+  void clear() noexcept
+  {
+    values_.clear();
+    offsets_.erase(offsets_.begin() + 1, offsets_.end());
+    ends_.clear();
+  }
+
+  auto operator[](size_type i) noexcept -> row_type
+  {
+    return {values_.data() + offsets_[i], this->row_end(i) - offsets_[i]};
+  }
+
+  auto operator[](size_type i) const noexcept -> const_row_type
+  {
+    return {values_.data() + offsets_[i], this->row_end(i) - offsets_[i]};
+  }
+
+  auto at(size_type i) -> row_type
+  {
+    if (i >= this->rows()) { throw out_of_range{}; }
+    return (*this)[i];
+  }
+
+  auto at(size_type i) const -> const_row_type
+  {
+    if (i >= this->rows()) { throw out_of_range{}; }
+    return (*this)[i];
+  }
+
+  auto back() noexcept -> row_type
+  {
+    return (*this)[this->rows() - 1];
+  }
+
+  auto back() const noexcept -> const_row_type
+  {
+    return (*this)[this->rows() - 1];
+  }
+
+  // The raw CSR arrays. Without slack, row `i` is
+  // `values()[offsets()[i], offsets()[i + 1])`.
+  //
+  auto values() const noexcept -> vector<T> const&
+  {
+    return values_;
+  }
+
+  auto offsets() const noexcept -> vector<size_type> const&
+  {
+    return offsets_;
+  }
+
+  template <class InputIt>
+  void push_back_row(InputIt first, InputIt last)
+  {
+    auto const mid = values_.size();
+    try {
+      for (; first != last; ++first) {
+        values_.emplace_back(*first);
+      }
+      offsets_.push_back(values_.size());
+      if (!ends_.empty()) {
+        try {
+          ends_.push_back(values_.size());
+        }
+        catch (...) {
+          offsets_.pop_back();
+          throw;
+        }
+      }
+    }
+    catch (...) {
+      values_.erase(values_.begin() + mid, values_.end());
+      throw;
+    }
+  }
+
+  void push_back_row(std::initializer_list<T> ilist)
+  {
+    this->push_back_row(ilist.begin(), ilist.end());
+  }
+
+  // Any range with begin() and end(), including a row of this vector.
+  //
+  template <class Range>
+  void push_back_row(Range const& range)
+  {
+    if constexpr (detail::is_jagged_span<Range>::value) {
+      // the row may be in `values_` itself, which is about to grow
+      //
+      auto const copy = vector<T>(range.begin(), range.end());
+      this->push_back_row(copy.begin(), copy.end());
+    }
+    else {
+      this->push_back_row(range.begin(), range.end());
+    }
+  }
+
+  // An empty row.
+  //
+  void push_back_row()
+  {
+    offsets_.push_back(values_.size());
+    if (!ends_.empty()) { ends_.push_back(values_.size()); }
+  }
+
+  // Appends to the last row, which has to exist.
+  //
+  void push_back(T const& value)
+  {
+    this->emplace_back(value);
+  }
+
+  void push_back(T&& value)
+  {
+    this->emplace_back(detail::move(value));
+  }
+
+  template <class... Args>
+  auto emplace_back(Args&&... args) -> T&
+  {
+    auto& x = values_.emplace_back(detail::forward<Args>(args)...);
+    offsets_.back() = values_.size();
+    if (!ends_.empty()) { ends_.back() = values_.size(); }
+    return x;
+  }
+
+  // Also gives back any slack of the row that becomes last, so appends to it
+  // land right after its values.
+  //
+  void pop_back_row()
+  {
+    offsets_.pop_back();
+    if (!ends_.empty()) { ends_.pop_back(); }
+
+    auto const end = this->rows() == 0 ? size_type{0}
+                                       : this->row_end(this->rows() - 1);
+    values_.erase(values_.begin() + end, values_.end());
+    offsets_.back() = values_.size();
+    if (!ends_.empty()) { ends_.back() = values_.size(); }
+  }
+
+  // Keeps the first `n` values of row `i`.
+  //
+  void truncate_row(size_type i, size_type n)
+  {
+    if (n < this->row_end(i) - offsets_[i]) { this->shrink_row(i, n); }
+  }
+
+  void clear_row(size_type i)
+  {
+    this->truncate_row(i, 0);
+  }
+
+  // Removes the values of row `i` that match `pred`, keeping the order of
+  // the rest. Returns how many were removed.
+  //
+  template <class Pred>
+  auto erase_row_if(size_type i, Pred pred) -> size_type
+  {
+    auto const first = offsets_[i];
+    auto const last  = this->row_end(i);
+
+    auto w = first;
+    for (auto r = first; r < last; ++r) {
+      if (pred(values_[r])) { continue; }
+      if (w != r) { values_[w] = detail::move(values_[r]); }
+      ++w;
+    }
+    if (w != last) { this->shrink_row(i, w - first); }
+    return last - w;
+  }
+
+  // Slides every row down over the gaps in front of it, in one pass.
+  //
+  void compact()
+  {
+    if (ends_.empty()) { return; }
+
+    auto w = size_type{0};
+    for (auto i = size_type{0}; i < this->rows(); ++i) {
+      auto const first = offsets_[i];
+      auto const last  = ends_[i];
+      offsets_[i]      = w;
+      for (auto r = first; r < last; ++r, ++w) {
+        if (w != r) { values_[w] = detail::move(values_[r]); }
+      }
+    }
+    offsets_.back() = w;
+    values_.erase(values_.begin() + w, values_.end());
+    ends_.clear();
+  }
+
+  friend bool operator==(jagged_vector const& lhs, jagged_vector const& rhs)
+  {
+    if (lhs.rows() != rhs.rows()) { return false; }
+    for (auto i = size_type{0}; i < lhs.rows(); ++i) {
+      auto const a = lhs[i];
+      auto const b = rhs[i];
+      if (a.size() != b.size()) { return false; }
+      for (auto j = size_type{0}; j < a.size(); ++j) {
+        if (!(a[j] == b[j])) { return false; }
+      }
+    }
+    return true;
+  }
+
+  friend bool operator!=(jagged_vector const& lhs, jagged_vector const& rhs)
+  {
+    return !(lhs == rhs);
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_JAGGED_VECTOR_HPP
@@ -0,0 +1,792 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_MAPPED_VECTOR_HPP
+#define LESS_MAPPED_VECTOR_HPP
+
+#if !defined(__linux__)
+#error "<less/mapped_vector.hpp> is only supported on Linux"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <less/io.hpp>
+#include <less/system_error.hpp>
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+// Every file backing a `less::mapped_vector` starts with this header. The
+// elements follow at `mapped_header_size` so the mapping's page alignment
+// carries over to them. Everything past `size` elements is spare capacity.
+//
+struct mapped_header {
+  char          magic[8];
+  std::uint32_t version;
+  std::uint32_t value_size;
+  std::uint64_t size;
+};
+
+inline constexpr char const mapped_magic[8] = {'l', 'e', 's', 's',
+                                               'v', 'e', 'c', '\0'};
+
+inline constexpr std::uint32_t const mapped_version = 1;
+
+inline constexpr unsigned_long_type const mapped_header_size = 64;
+
+static_assert(sizeof(mapped_header) <= mapped_header_size);
+
+// shared by a memfd-backed `less::mapped_vector` and the snapshots of its
+// current file; the writer holds one reference and each snapshot another
+//
+struct snapshot_refs {
+  std::atomic<unsigned_long_type> count{1u};
+};
+
+inline void release(snapshot_refs* refs) noexcept
+{
+  if (refs && refs->count.fetch_sub(1u, std::memory_order_acq_rel) == 1u) {
+    delete refs;
+  }
+}
+
+}    // namespace detail
+
+// Selects the anonymous, `memfd_create()`-backed storage of
+// `less::mapped_vector`.
+//
+struct memfd_t {};
+inline constexpr memfd_t memfd;
+
+// A vector of trivially copyable `T` stored in a memory-mapped file. Opening an
+// existing file maps it and is ready for use immediately, there's nothing to
+// parse or copy. Growing extends the file with `ftruncate()` and the mapping
+// with `mremap()`, which may move it, so growth invalidates pointers the same
+// way reallocation does for `less::vector`.
+//
+// Changes reach the file through the page cache whenever the kernel writes the
+// pages back; `flush()` forces them out synchronously.
+//
+// Constructed with `less::memfd`, the elements live in an anonymous
+// `memfd_create()` file instead, and `snapshot()` takes O(1) read-only
+// snapshots of them through the kernel's copy-on-write. The snapshot maps the
+// file shared while the vector's own mapping is replaced, at the same address,
+// by a private one, so the first write to a page afterwards gives the vector a
+// copy of it and leaves the file, and the snapshot, as they were.
+//
+// The next snapshot first writes the pages copied since the last one back to
+// the file, found through `/proc/self/pagemap` (every page is written when
+// that can't be read), and so costs a copy of what changed in between. If an
+// older snapshot is still alive the file can't change under it, and the
+// vector moves to a new file holding a full copy of its elements instead.
+//
+template <class T>
+struct mapped_vector {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "less::mapped_vector requires a trivially copyable type");
+  static_assert(alignof(T) <= detail::mapped_header_size);
+
+ public:
+  using value_type      = T;
+  using size_type       = unsigned_long_type;
+  using difference_type = long_type;
+  using reference       = T&;
+  using const_reference = T const&;
+  using pointer         = T*;
+  using const_pointer   = T const*;
+  using iterator        = pointer;
+  using const_iterator  = const_pointer;
+
+ private:
+  int            fd_   = -1;
+  unsigned char* base_ = nullptr;
+  size_type      len_  = 0u;
+
+  // the size of the file, which can exceed the mapping while `private_`
+  //
+  size_type file_len_ = 0u;
+
+  // only set for the memfd storage
+  //
+  detail::snapshot_refs* refs_ = nullptr;
+
+  // whether the mapping is private, i.e. a snapshot of the file was taken
+  //
+  bool private_ = false;
+
+  auto header() const noexcept -> detail::mapped_header*
+  {
+    return reinterpret_cast<detail::mapped_header*>(base_);
+  }
+
+  static auto file_size_for(size_type capacity) noexcept -> size_type
+  {
+    return detail::mapped_header_size + capacity * sizeof(value_type);
+  }
+
+  static auto page_size() noexcept -> size_type
+  {
+    return static_cast<size_type>(sysconf(_SC_PAGESIZE));
+  }
+
+  // a new file's length, a page's worth of elements
+  //
+  static auto initial_length() noexcept -> size_type
+  {
+    return file_size_for((page_size() - detail::mapped_header_size) /
+                         sizeof(value_type));
+  }
+
+  void truncate(size_type len)
+  {
+    if (ftruncate(fd_, static_cast<off_t>(len)) != 0) {
+      detail::throw_errno();
+    }
+    file_len_ = len;
+  }
+
+  void init_header() noexcept
+  {
+    auto const h = this->header();
+    std::memcpy(h->magic, detail::mapped_magic, sizeof(h->magic));
+    h->version    = detail::mapped_version;
+    h->value_size = sizeof(value_type);
+    h->size       = 0u;
+  }
+
+  // resizes the file and the mapping to hold exactly `capacity` elements
+  //
+  void remap(size_type capacity)
+  {
+    auto const len = file_size_for(capacity);
+
+    // the file has to cover the whole mapping before we touch the new pages
+    // and can only lose its tail once nothing maps it anymore, which for a
+    // private mapping includes snapshots
+    //
+    if (len > file_len_) { this->truncate(len); }
+
+    auto const p = mremap(base_, len_, len, MREMAP_MAYMOVE);
+    if (p == MAP_FAILED) { detail::throw_errno(); }
+
+    base_ = static_cast<unsigned char*>(p);
+    len_  = len;
+
+    if (len < file_len_ && !private_) { this->truncate(len); }
+  }
+
+  // maps `fd_` privately in place of the current mapping
+  //
+  void map_private()
+  {
+    auto const p = mmap(base_, len_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_FIXED, fd_, 0);
+    if (p == MAP_FAILED) { detail::throw_errno(); }
+
+    private_ = true;
+  }
+
+  // Writes the pages copied on write since the mapping became private back to
+  // the file. Such a page is anonymous memory now, every other one is either
+  // not present or still the file's own.
+  //
+  void write_back_copied_pages()
+  {
+    auto const page  = page_size();
+    auto const pages = (len_ + page - 1) / page;
+
+    auto write_pages = [&](size_type first, size_type last) {
+      auto const offset = first * page;
+      auto const end    = (last * page < len_ ? last * page : len_);
+      detail::pwrite_fully(fd_, base_ + offset, end - offset, offset);
+    };
+
+    auto const pagemap = ::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+    if (pagemap == -1) {
+      write_pages(0u, pages);
+      return;
+    }
+
+    try {
+      constexpr size_type const batch = 512u;
+
+      std::uint64_t entries[batch];
+
+      auto const first_page = reinterpret_cast<std::uintptr_t>(base_) / page;
+      auto       run        = pages;
+      for (auto i = size_type{0}; i < pages; i += batch) {
+        auto const n     = (pages - i < batch ? pages - i : batch);
+        auto const bytes = static_cast<long_type>(n * sizeof(std::uint64_t));
+        if (::pread(pagemap, entries, n * sizeof(std::uint64_t),
+                    static_cast<off_t>((first_page + i) *
+                                       sizeof(std::uint64_t))) != bytes) {
+          write_pages(run < i ? run : i, pages);
+          run = pages;
+          break;
+        }
+
+        for (auto j = size_type{0}; j < n; ++j) {
+          auto const e       = entries[j];
+          auto const present = (e >> 63) & 1u;
+          auto const swapped = (e >> 62) & 1u;
+          auto const file    = (e >> 61) & 1u;
+          auto const copied  = swapped || (present && !file);
+
+          if (copied && run == pages) { run = i + j; }
+          if (!copied && run != pages) {
+            write_pages(run, i + j);
+            run = pages;
+          }
+        }
+      }
+
+      if (run != pages) { write_pages(run, pages); }
+    }
+    catch (...) {
+      ::close(pagemap);
+      throw;
+    }
+
+    ::close(pagemap);
+  }
+
+  // Moves the elements to a fresh memfd, leaving the current file to the
+  // snapshots still using it.
+  //
+  void move_to_new_file()
+  {
+    auto const refs = new detail::snapshot_refs();
+
+    auto const fd = memfd_create("less::mapped_vector", MFD_CLOEXEC);
+    if (fd == -1) {
+      delete refs;
+      detail::throw_errno();
+    }
+
+    try {
+      if (ftruncate(fd, static_cast<off_t>(len_)) != 0) {
+        detail::throw_errno();
+      }
+      detail::pwrite_fully(fd, base_, len_, 0u);
+
+      auto const p = mmap(base_, len_, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_FIXED, fd, 0);
+      if (p == MAP_FAILED) { detail::throw_errno(); }
+    }
+    catch (...) {
+      delete refs;
+      ::close(fd);
+      throw;
+    }
+
+    ::close(fd_);
+    detail::release(refs_);
+
+    fd_       = fd;
+    file_len_ = len_;
+    refs_     = refs;
+  }
+
+  void grow_for(size_type count)
+  {
+    auto const cap = this->capacity();
+    if (count <= cap) { return; }
+
+    auto const doubled = 2 * cap;
+    this->remap(count < doubled ? doubled : count);
+  }
+
+  void close() noexcept
+  {
+    if (base_) { munmap(base_, len_); }
+    if (fd_ != -1) { ::close(fd_); }
+    detail::release(refs_);
+
+    fd_       = -1;
+    base_     = nullptr;
+    len_      = 0u;
+    file_len_ = 0u;
+    refs_     = nullptr;
+    private_  = false;
+  }
+
+ public:
+  // A read-only view of a memfd-backed vector as it was when `snapshot()` was
+  // called, unaffected by later changes to the vector. It keeps its own
+  // mapping, so it may outlive the vector and be read from any thread.
+  //
+  struct snapshot_view {
+   private:
+    unsigned char const*   base_ = nullptr;
+    size_type              len_  = 0u;
+    detail::snapshot_refs* refs_ = nullptr;
+
+    friend struct mapped_vector;
+
+    auto header() const noexcept -> detail::mapped_header const*
+    {
+      return reinterpret_cast<detail::mapped_header const*>(base_);
+    }
+
+   public:
+    snapshot_view() noexcept
+    {
+    }
+
+    snapshot_view(snapshot_view const&) = delete;
+    auto operator=(snapshot_view const&) -> snapshot_view& = delete;
+
+    snapshot_view(snapshot_view&& rhs) noexcept
+        : base_(rhs.base_)
+        , len_(rhs.len_)
+        , refs_(rhs.refs_)
+    {
+      rhs.base_ = nullptr;
+      rhs.len_  = 0u;
+      rhs.refs_ = nullptr;
+    }
+
+    auto operator=(snapshot_view&& rhs) noexcept -> snapshot_view&
+    {
+      if (this == &rhs) { return *this; }
+
+      this->~snapshot_view();
+
+      base_ = rhs.base_;
+      len_  = rhs.len_;
+      refs_ = rhs.refs_;
+
+      rhs.base_ = nullptr;
+      rhs.len_  = 0u;
+      rhs.refs_ = nullptr;
+      return *this;
+    }
+
+    ~snapshot_view()
+    {
+      if (base_) { munmap(const_cast<unsigned char*>(base_), len_); }
+      detail::release(refs_);
+
+      base_ = nullptr;
+      refs_ = nullptr;
+    }
+
+    auto at(size_type const pos) const -> const_reference
+    {
+      if (pos >= this->size()) { throw out_of_range{}; }
+
+      return this->data()[pos];
+    }
+
+    auto operator[](size_type const pos) const -> const_reference
+    {
+      return this->data()[pos];
+    }
+
+    auto front() const -> const_reference
+    {
+      return *this->data();
+    }
+
+    auto back() const -> const_reference
+    {
+      return this->data()[this->size() - 1];
+    }
+
+    auto data() const noexcept -> T const*
+    {
+      return base_ ? reinterpret_cast<T const*>(base_ +
+                                                detail::mapped_header_size)
+                   : nullptr;
+    }
+
+    auto begin() const noexcept -> const_iterator
+    {
+      return this->data();
+    }
+
+    auto end() const noexcept -> const_iterator
+    {
+      return this->data() + this->size();
+    }
+
+    bool empty() const noexcept
+    {
+      return this->size() == 0u;
+    }
+
+    auto size() const noexcept -> size_type
+    {
+      return base_ ? static_cast<size_type>(this->header()->size) : 0u;
+    }
+  };
+
+  // Opens the file at `path`, creating it if it doesn't exist. Throws
+  // `less::format_error` if the file holds something other than a
+  // `less::mapped_vector` of a type with the same size as `T`.
+  //
+  explicit mapped_vector(char const* path)
+  {
+    fd_ = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ == -1) { detail::throw_errno(); }
+
+    try {
+      struct stat st;
+      if (fstat(fd_, &st) != 0) { detail::throw_errno(); }
+
+      auto       len     = static_cast<size_type>(st.st_size);
+      auto const created = (len == 0);
+      if (created) {
+        len = initial_length();
+        this->truncate(len);
+      }
+      else if (len < detail::mapped_header_size) {
+        throw format_error{};
+      }
+
+      auto const p =
+          mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+      if (p == MAP_FAILED) { detail::throw_errno(); }
+
+      base_     = static_cast<unsigned char*>(p);
+      len_      = len;
+      file_len_ = len;
+
+      auto const h = this->header();
+      if (created) { this->init_header(); }
+      else if (std::memcmp(h->magic, detail::mapped_magic, sizeof(h->magic)) !=
+                   0 ||
+               h->version != detail::mapped_version ||
+               h->value_size != sizeof(value_type) ||
+               h->size > this->capacity()) {
+        throw format_error{};
+      }
+    }
+    catch (...) {
+      this->close();
+      throw;
+    }
+  }
+
+  // An empty vector in an anonymous file of its own, which supports
+  // `snapshot()`.
+  //
+  explicit mapped_vector(memfd_t)
+  {
+    fd_ = memfd_create("less::mapped_vector", MFD_CLOEXEC);
+    if (fd_ == -1) { detail::throw_errno(); }
+
+    try {
+      auto const len = initial_length();
+      this->truncate(len);
+
+      auto const p =
+          mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+      if (p == MAP_FAILED) { detail::throw_errno(); }
+
+      base_ = static_cast<unsigned char*>(p);
+      len_  = len;
+      this->init_header();
+
+      refs_ = new detail::snapshot_refs();
+    }
+    catch (...) {
+      this->close();
+      throw;
+    }
+  }
+
+  mapped_vector(mapped_vector const&) = delete;
+  auto operator=(mapped_vector const&) -> mapped_vector& = delete;
+
+  mapped_vector(mapped_vector&& rhs) noexcept
+  {
+    this->swap(rhs);
+  }
+
+  auto operator=(mapped_vector&& rhs) noexcept -> mapped_vector&
+  {
+    if (this == &rhs) { return *this; }
+
+    this->close();
+    this->swap(rhs);
+    return *this;
+  }
+
+  ~mapped_vector()
+  {
+    this->close();
+  }
+
+  // Element access
+
+  auto at(size_type const pos) -> reference
+  {
+    if (pos >= this->size()) { throw out_of_range{}; }
+
+    return this->data()[pos];
+  }
+
+  auto at(size_type const pos) const -> const_reference
+  {
+    if (pos >= this->size()) { throw out_of_range{}; }
+
+    return this->data()[pos];
+  }
+
+  auto operator[](size_type const pos) -> reference
+  {
+    return this->data()[pos];
+  }
+
+  auto operator[](size_type const pos) const -> const_reference
+  {
+    return this->data()[pos];
+  }
+
+  auto front() -> reference
+  {
+    return *this->begin();
+  }
+
+  auto front() const -> const_reference
+  {
+    return *this->begin();
+  }
+
+  auto back() -> reference
+  {
+    return this->data()[this->size() - 1];
+  }
+
+  auto back() const -> const_reference
+  {
+    return this->data()[this->size() - 1];
+  }
+
+  auto data() noexcept -> T*
+  {
+    return base_ ? reinterpret_cast<T*>(base_ + detail::mapped_header_size)
+                 : nullptr;
+  }
+
+  auto data() const noexcept -> T const*
+  {
+    return base_ ? reinterpret_cast<T const*>(base_ +
+                                              detail::mapped_header_size)
+                 : nullptr;
+  }
+
+  // Iterators
+
+  auto begin() noexcept -> iterator
+  {
+    return this->data();
+  }
+
+  auto begin() const noexcept -> const_iterator
+  {
+    return this->data();
+  }
+
+  auto cbegin() const noexcept -> const_iterator
+  {
+    return this->data();
+  }
+
+  auto end() noexcept -> iterator
+  {
+    return this->data() + this->size();
+  }
+
+  auto end() const noexcept -> const_iterator
+  {
+    return this->data() + this->size();
+  }
+
+  auto cend() const noexcept -> const_iterator
+  {
+    return this->data() + this->size();
+  }
+
+  // Capacity
+
+  bool empty() const noexcept
+  {
+    return this->size() == 0u;
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return base_ ? static_cast<size_type>(this->header()->size) : 0u;
+  }
+
+  auto capacity() const noexcept -> size_type
+  {
+    return base_ ? (len_ - detail::mapped_header_size) / sizeof(value_type)
+                 : 0u;
+  }
+
+  void reserve(size_type new_cap)
+  {
+    if (new_cap <= this->capacity()) { return; }
+    this->remap(new_cap);
+  }
+
+  void shrink_to_fit()
+  {
+    if (this->size() == this->capacity()) { return; }
+    this->remap(this->size());
+  }
+
+  // Modifiers
+
+  void clear() noexcept
+  {
+    if (base_) { this->header()->size = 0u; }
+  }
+
+  void push_back(T const& value)
+  {
+    auto const size = this->size();
+    if (size == this->capacity()) {
+      // `value` may live in our own mapping which `remap()` can move
+      //
+      auto const copy = value;
+      this->grow_for(size + 1);
+      this->data()[size] = copy;
+    }
+    else {
+      this->data()[size] = value;
+    }
+
+    this->header()->size = size + 1;
+  }
+
+  template <class... Args>
+  auto emplace_back(Args&&... args) -> reference
+  {
+    auto const size = this->size();
+    this->grow_for(size + 1);
+
+    auto* const p = new (this->data() + size, detail::placement_tag_t{})
+        T(detail::forward<Args>(args)...);
+    this->header()->size = size + 1;
+    return *p;
+  }
+
+  void pop_back() noexcept
+  {
+    --this->header()->size;
+  }
+
+  void resize(size_type count)
+  {
+    this->resize(count, value_type());
+  }
+
+  void resize(size_type count, value_type const& value)
+  {
+    auto const size = this->size();
+    if (count > size) {
+      auto const copy = value;
+      this->grow_for(count);
+
+      auto const p = this->data();
+      for (auto i = size; i < count; ++i) {
+        p[i] = copy;
+      }
+    }
+    this->header()->size = count;
+  }
+
+  // grows without writing the new elements, which leaves whatever the file
+  // held there (zeroes for a freshly extended file) and avoids touching pages
+  //
+  void resize(default_init_t, size_type count)
+  {
+    this->grow_for(count);
+    this->header()->size = count;
+  }
+
+  // Synchronously writes every modified page of the mapping back to the file.
+  //
+  void flush()
+  {
+    if (!base_) { return; }
+    if (msync(base_, len_, MS_SYNC) != 0) { detail::throw_errno(); }
+  }
+
+  // Takes an O(1) snapshot of the current elements; see above for what it
+  // costs the next one. Throws `less::system_error` with `EINVAL` unless the
+  // vector was constructed with `less::memfd`.
+  //
+  auto snapshot() -> snapshot_view
+  {
+    if (!refs_) { throw system_error{EINVAL}; }
+
+    if (!private_) {
+      this->map_private();
+    }
+    else if (refs_->count.load(std::memory_order_acquire) == 1u) {
+      this->write_back_copied_pages();
+      this->map_private();
+    }
+    else {
+      this->move_to_new_file();
+    }
+
+    auto const p = mmap(nullptr, len_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (p == MAP_FAILED) { detail::throw_errno(); }
+
+    refs_->count.fetch_add(1u, std::memory_order_relaxed);
+
+    auto s  = snapshot_view();
+    s.base_ = static_cast<unsigned char const*>(p);
+    s.len_  = len_;
+    s.refs_ = refs_;
+    return s;
+  }
+
+  void swap(mapped_vector& other) noexcept
+  {
+    auto const fd       = other.fd_;
+    auto const base     = other.base_;
+    auto const len      = other.len_;
+    auto const file_len = other.file_len_;
+    auto const refs     = other.refs_;
+    auto const priv     = other.private_;
+
+    other.fd_       = fd_;
+    other.base_     = base_;
+    other.len_      = len_;
+    other.file_len_ = file_len_;
+    other.refs_     = refs_;
+    other.private_  = private_;
+
+    fd_       = fd;
+    base_     = base;
+    len_      = len;
+    file_len_ = file_len;
+    refs_     = refs;
+    private_  = priv;
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_MAPPED_VECTOR_HPP
@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_NUMA_HPP
+#define LESS_NUMA_HPP
+
+#if !defined(__linux__)
+#error "<less/numa.hpp> is only supported on Linux"
+#endif
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include <less/system_error.hpp>
+#include <less/vector.hpp>
+
+// NUMA placement for `less::vector` storage, talking to the kernel's memory
+// policy syscalls directly so there's no dependency on libnuma.
+//
+// A policy only affects pages when they're faulted in, so the cheapest way to
+// place a vector is to apply the policy to its capacity before the elements are
+// constructed:
+//
+//   auto v = less::vector<double>(less::with_capacity, n);
+//   less::numa::apply(v, less::numa::policy::interleave());
+//   v.resize(n);
+//
+// Applying a policy to a vector whose pages already exist migrates them.
+//
+namespace less {
+namespace numa {
+
+namespace detail {
+
+// <linux/mempolicy.h>
+//
+inline constexpr int const mpol_default    = 0;
+inline constexpr int const mpol_preferred  = 1;
+inline constexpr int const mpol_bind       = 2;
+inline constexpr int const mpol_interleave = 3;
+
+inline constexpr unsigned const mpol_mf_move = 1u << 1;
+
+inline constexpr unsigned long const mpol_f_mems_allowed = 1u << 2;
+
+inline auto page_size() noexcept -> unsigned_long_type
+{
+  static auto const size = static_cast<unsigned_long_type>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+}    // namespace detail
+
+inline constexpr unsigned_long_type const max_nodes = 1024;
+
+struct node_mask {
+ private:
+  static constexpr unsigned_long_type const bits_per_word =
+      8 * sizeof(unsigned long);
+
+  unsigned long words_[max_nodes / bits_per_word] = {};
+
+  bool bit(unsigned_long_type node) const noexcept
+  {
+    return words_[node / bits_per_word] & (1ul << (node % bits_per_word));
+  }
+
+ public:
+  // Throws `less::out_of_range` for `node >= max_nodes`.
+  //
+  void set(unsigned_long_type node)
+  {
+    if (node >= max_nodes) { throw out_of_range{}; }
+    words_[node / bits_per_word] |= 1ul << (node % bits_per_word);
+  }
+
+  bool test(unsigned_long_type node) const
+  {
+    if (node >= max_nodes) { throw out_of_range{}; }
+    return this->bit(node);
+  }
+
+  auto count() const noexcept -> unsigned_long_type
+  {
+    auto n = unsigned_long_type{0};
+    for (auto node = 0u; node < max_nodes; ++node) {
+      n += this->bit(node);
+    }
+    return n;
+  }
+
+  bool empty() const noexcept
+  {
+    return this->count() == 0;
+  }
+
+  auto data() noexcept -> unsigned long*
+  {
+    return words_;
+  }
+
+  auto data() const noexcept -> unsigned long const*
+  {
+    return words_;
+  }
+};
+
+// the nodes the calling thread is allowed to allocate from
+//
+inline auto allowed_nodes() -> node_mask
+{
+  auto mask = node_mask();
+  if (syscall(SYS_get_mempolicy, nullptr, mask.data(), max_nodes, nullptr,
+              detail::mpol_f_mems_allowed) != 0) {
+    less::detail::throw_errno();
+  }
+  return mask;
+}
+
+inline auto node_count() -> unsigned_long_type
+{
+  return allowed_nodes().count();
+}
+
+struct policy {
+ private:
+  int       mode_ = detail::mpol_default;
+  node_mask nodes_;
+
+  policy(int mode, node_mask nodes) noexcept
+      : mode_(mode)
+      , nodes_(nodes)
+  {
+  }
+
+ public:
+  // the system default: allocate on the node of the thread touching the page
+  //
+  static auto local() noexcept -> policy
+  {
+    return policy(detail::mpol_default, node_mask());
+  }
+
+  // allocate strictly from `node`
+  //
+  static auto bind(unsigned_long_type node) -> policy
+  {
+    auto mask = node_mask();
+    mask.set(node);
+    return policy(detail::mpol_bind, mask);
+  }
+
+  // prefer `node` but fall back to others when it runs out of memory
+  //
+  static auto preferred(unsigned_long_type node) -> policy
+  {
+    auto mask = node_mask();
+    mask.set(node);
+    return policy(detail::mpol_preferred, mask);
+  }
+
+  // spread pages round-robin over `nodes`
+  //
+  static auto interleave(node_mask const& nodes) noexcept -> policy
+  {
+    return policy(detail::mpol_interleave, nodes);
+  }
+
+  // spread pages round-robin over every node we're allowed to use
+  //
+  static auto interleave() -> policy
+  {
+    return policy(detail::mpol_interleave, allowed_nodes());
+  }
+
+  auto mode() const noexcept -> int
+  {
+    return mode_;
+  }
+
+  auto nodes() const noexcept -> node_mask const&
+  {
+    return nodes_;
+  }
+};
+
+// Sets the memory policy of the page-aligned range covering `v`'s capacity and
+// migrates pages that were already faulted in. The range is rounded out to
+// whole pages so small vectors sharing a page with other heap allocations take
+// those along with them.
+//
+template <class T>
+void apply(vector<T>& v, policy const& p)
+{
+  if (v.capacity() == 0) { return; }
+
+  auto const page  = detail::page_size();
+  auto const first = reinterpret_cast<unsigned_long_type>(v.data());
+  auto const last  = first + v.capacity() * sizeof(T);
+
+  auto const begin = first / page * page;
+  auto const end   = (last + page - 1) / page * page;
+
+  auto const mode = p.mode();
+  auto const mask = (mode == detail::mpol_default ? nullptr : p.nodes().data());
+
+  if (syscall(SYS_mbind, reinterpret_cast<void*>(begin), end - begin, mode,
+              mask, mask ? max_nodes : 0ul, detail::mpol_mf_move) != 0) {
+    less::detail::throw_errno();
+  }
+}
+
+// Sets the policy used for every page the calling thread faults in until the
+// guard goes out of scope, at which point the previous policy is restored.
+// Worker threads, including those of `less::thread_pool`, are not affected.
+//
+struct scoped_policy {
+ private:
+  int       old_mode_ = detail::mpol_default;
+  node_mask old_nodes_;
+
+ public:
+  explicit scoped_policy(policy const& p)
+  {
+    if (syscall(SYS_get_mempolicy, &old_mode_, old_nodes_.data(), max_nodes,
+                nullptr, 0ul) != 0) {
+      less::detail::throw_errno();
+    }
+
+    auto const mode = p.mode();
+    auto const mask =
+        (mode == detail::mpol_default ? nullptr : p.nodes().data());
+
+    if (syscall(SYS_set_mempolicy, mode, mask, mask ? max_nodes : 0ul) != 0) {
+      less::detail::throw_errno();
+    }
+  }
+
+  scoped_policy(scoped_policy const&) = delete;
+  auto operator=(scoped_policy const&) -> scoped_policy& = delete;
+
+  ~scoped_policy()
+  {
+    auto const mask =
+        (old_mode_ == detail::mpol_default ? nullptr : old_nodes_.data());
+    syscall(SYS_set_mempolicy, old_mode_, mask, mask ? max_nodes : 0ul);
+  }
+};
+
+struct page_distribution {
+  // `pages_per_node[n]` is the number of pages of the vector resident on node
+  // `n`, sized to the highest node that holds any of them
+  //
+  less::vector<unsigned_long_type> pages_per_node;
+
+  // pages that haven't been faulted in yet
+  //
+  unsigned_long_type not_present = 0;
+
+  // pages the kernel reported any other error for, such as `-EFAULT`
+  //
+  unsigned_long_type failed = 0;
+};
+
+// Reports which nodes the pages backing `v`'s elements currently live on.
+//
+template <class T>
+auto distribution(vector<T> const& v) -> page_distribution
+{
+  auto dist = page_distribution();
+  if (v.empty()) { return dist; }
+
+  auto const page  = detail::page_size();
+  auto const first = reinterpret_cast<unsigned_long_type>(v.data()) / page;
+  auto const last =
+      (reinterpret_cast<unsigned_long_type>(v.data() + v.size()) + page - 1) /
+      page;
+
+  constexpr unsigned_long_type const batch = 1024;
+
+  void* pages[batch];
+  int   status[batch];
+
+  for (auto pos = first; pos < last; pos += batch) {
+    auto const n = (last - pos < batch ? last - pos : batch);
+    for (auto i = 0u; i < n; ++i) {
+      pages[i] = reinterpret_cast<void*>((pos + i) * page);
+    }
+
+    if (syscall(SYS_move_pages, 0, n, pages, nullptr, status, 0) != 0) {
+      less::detail::throw_errno();
+    }
+
+    for (auto i = 0u; i < n; ++i) {
+      if (status[i] == -ENOENT) {
+        ++dist.not_present;
+        continue;
+      }
+      if (status[i] < 0) {
+        ++dist.failed;
+        continue;
+      }
+
+      auto const node = static_cast<unsigned_long_type>(status[i]);
+      if (node >= dist.pages_per_node.size()) {
+        dist.pages_per_node.resize(node + 1);
+      }
+      ++dist.pages_per_node[node];
+    }
+  }
+
+  return dist;
+}
+
+}    // namespace numa
+}    // namespace less
+
+#endif    // LESS_NUMA_HPP
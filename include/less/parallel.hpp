@@ -0,0 +1,422 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_PARALLEL_HPP
+#define LESS_PARALLEL_HPP
+
+// Smallest number of elements a chunk of `parallel_for()`,
+// `parallel_transform()` and the reductions covers, and of a sorted run in
+// `parallel_sort()`. Smaller ranges just run on the calling thread.
+//
+#ifndef LESS_PARALLEL_MIN_GRAIN
+#define LESS_PARALLEL_MIN_GRAIN 1024u
+#endif
+
+#ifndef LESS_PARALLEL_SORT_MIN_GRAIN
+#define LESS_PARALLEL_SORT_MIN_GRAIN 8192u
+#endif
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+
+#include <less/thread_pool.hpp>
+
+// Parallel algorithms over `less::vector`s and pointer ranges, run on
+// `less::default_thread_pool()` with the calling thread joining in.
+//
+// The grain size is picked automatically: ranges are cut into about four
+// chunks per thread, so threads that finish early can take more, but never
+// into chunks smaller than the minimum grain above. Pass an explicit grain to
+// the overloads that take one when the per-element cost is known to be far off
+// from that.
+//
+namespace less {
+namespace detail {
+
+inline auto auto_grain(unsigned_long_type n, unsigned_long_type min_grain)
+    -> unsigned_long_type
+{
+  auto const threads = default_thread_pool().size() + 1;
+  auto const grain   = n / (4 * threads);
+  return grain < min_grain ? min_grain : grain;
+}
+
+// start of part `i` when splitting `n` elements into `parts` nearly equal ones
+//
+inline auto split_point(unsigned_long_type n, unsigned_long_type parts,
+                        unsigned_long_type i) noexcept -> unsigned_long_type
+{
+  auto const q = n / parts;
+  auto const r = n % parts;
+  return q * i + (i < r ? i : r);
+}
+
+// Number of elements of `a` among the first `k` elements of the stable merge
+// of `a` and `b`.
+//
+template <class T, class Compare>
+auto co_rank(unsigned_long_type k, T const* a, unsigned_long_type m,
+             T const* b, unsigned_long_type n, Compare& comp)
+    -> unsigned_long_type
+{
+  auto lo = (k > n ? k - n : 0u);
+  auto hi = (k < m ? k : m);
+  while (lo < hi) {
+    auto const i = lo + (hi - lo) / 2;
+    auto const j = k - i;
+    if (j == 0 || i == m || comp(b[j - 1], a[i])) {
+      hi = i;
+    }
+    else {
+      lo = i + 1;
+    }
+  }
+  return lo;
+}
+
+// Uninitialized room for one partial result per chunk of a reduction, so the
+// result type needn't be default or copy constructible. Once every chunk has
+// succeeded, `built` is set and the destructor destroys them all.
+//
+template <class U>
+struct reduce_partials {
+  struct slot {
+    alignas(U) unsigned char bytes[sizeof(U)];
+  };
+
+  vector<slot> slots;
+  bool         built = false;
+
+  explicit reduce_partials(unsigned_long_type n)
+      : slots(default_init, n)
+  {
+  }
+
+  reduce_partials(reduce_partials const&) = delete;
+  auto operator=(reduce_partials const&) -> reduce_partials& = delete;
+
+  ~reduce_partials()
+  {
+    if (built) { this->destroy(0u, slots.size()); }
+  }
+
+  auto operator[](unsigned_long_type i) noexcept -> U&
+  {
+    return *reinterpret_cast<U*>(slots[i].bytes);
+  }
+
+  void destroy(unsigned_long_type b, unsigned_long_type e) noexcept
+  {
+    for (; b < e; ++b) {
+      (*this)[b].~U();
+    }
+  }
+};
+
+}    // namespace detail
+
+// Calls `f(i)` for every `i` in `[first, last)`.
+//
+template <class F>
+void parallel_for(unsigned_long_type first, unsigned_long_type last,
+                  unsigned_long_type grain, F f)
+{
+  if (first >= last) { return; }
+
+  detail::parallel_chunks(
+      last - first, grain,
+      [&](unsigned_long_type b, unsigned_long_type e) {
+        for (; b < e; ++b) {
+          f(first + b);
+        }
+      },
+      [](unsigned_long_type, unsigned_long_type) {});
+}
+
+template <class F>
+void parallel_for(unsigned_long_type first, unsigned_long_type last, F f)
+{
+  auto const n = (first < last ? last - first : 0u);
+  less::parallel_for(first, last,
+                     detail::auto_grain(n, LESS_PARALLEL_MIN_GRAIN), f);
+}
+
+// Calls `f(x)` for every element `x` of `v`.
+//
+template <class T, class F>
+void parallel_for(vector<T>& v, F f)
+{
+  auto const p = v.data();
+  less::parallel_for(0u, v.size(), [&](unsigned_long_type i) { f(p[i]); });
+}
+
+// Writes `f(first[i])` to `out[i]` for every element of `[first, last)`;
+// `out` has to hold that many constructed elements already.
+//
+template <class T, class U, class F>
+void parallel_transform(T const* first, T const* last, U* out, F f)
+{
+  auto const n = static_cast<unsigned_long_type>(last - first);
+  less::parallel_for(0u, n,
+                     [&](unsigned_long_type i) { out[i] = f(first[i]); });
+}
+
+// Returns a vector holding `f(x)` for every element `x` of `in`.
+//
+template <class T, class F>
+auto parallel_transform(vector<T> const& in, F f)
+    -> vector<std::decay_t<decltype(f(in[0]))>>
+{
+  using U = std::decay_t<decltype(f(in[0]))>;
+
+  // no-op for trivial types, parallel itself for large ones otherwise
+  //
+  auto out = vector<U>(default_init, in.size());
+  less::parallel_transform(in.data(), in.data() + in.size(), out.data(), f);
+  return out;
+}
+
+// Folds `transform(x)` for every element `x` of `[first, last)` into `init`
+// with `reduce`. `reduce` takes two `U`s and has to be associative: each chunk
+// is folded on its own, starting from its first transformed element, and the
+// partial results are then folded into `init` in order, so `reduce` needn't
+// be commutative and `init` is used once. `U` only has to be movable.
+//
+template <class T, class U, class Reduce, class Transform>
+auto parallel_transform_reduce(T const* first, T const* last, U init,
+                               Reduce reduce, Transform transform) -> U
+{
+  auto const n = static_cast<unsigned_long_type>(last - first);
+  if (n == 0) { return init; }
+
+  auto const grain      = detail::auto_grain(n, LESS_PARALLEL_MIN_GRAIN);
+  auto const num_chunks = (n + grain - 1) / grain;
+  if (num_chunks == 1) {
+    for (; first != last; ++first) {
+      init = reduce(detail::move(init), transform(*first));
+    }
+    return init;
+  }
+
+  auto const chunk_begin = [&](unsigned_long_type c) { return c * grain; };
+
+  // each chunk's partial result starts from its first element, so `init` is
+  // folded in exactly once, at the end
+  //
+  auto partials = detail::reduce_partials<U>(num_chunks);
+  detail::parallel_chunks(
+      num_chunks, 1u,
+      [&](unsigned_long_type b, unsigned_long_type e) {
+        auto const first_chunk = b;
+        try {
+          for (; b < e; ++b) {
+            auto const end = (chunk_begin(b + 1) < n ? chunk_begin(b + 1) : n);
+
+            auto& acc = *new (partials.slots[b].bytes,
+                              detail::placement_tag_t{})
+                U(transform(first[chunk_begin(b)]));
+            try {
+              for (auto i = chunk_begin(b) + 1; i < end; ++i) {
+                acc = reduce(detail::move(acc), transform(first[i]));
+              }
+            }
+            catch (...) {
+              acc.~U();
+              throw;
+            }
+          }
+        }
+        catch (...) {
+          partials.destroy(first_chunk, b);
+          throw;
+        }
+      },
+      [&](unsigned_long_type b, unsigned_long_type e) {
+        partials.destroy(b, e);
+      });
+  partials.built = true;
+
+  for (auto c = unsigned_long_type{0}; c < num_chunks; ++c) {
+    init = reduce(detail::move(init), detail::move(partials[c]));
+  }
+  return init;
+}
+
+template <class T, class U, class Reduce, class Transform>
+auto parallel_transform_reduce(vector<T> const& v, U init, Reduce reduce,
+                               Transform transform) -> U
+{
+  return less::parallel_transform_reduce(v.data(), v.data() + v.size(),
+                                         detail::move(init), reduce, transform);
+}
+
+// Folds `[first, last)` into `init` with `op`, which takes two `U`s and has
+// to be associative; elements are converted to `U`. For a fold that isn't
+// `op(U, U)`, such as summing a member or a square, use
+// `parallel_transform_reduce()`.
+//
+template <class T, class U, class Op>
+auto parallel_reduce(T const* first, T const* last, U init, Op op) -> U
+{
+  return less::parallel_transform_reduce(
+      first, last, detail::move(init), op,
+      [](T const& x) -> T const& { return x; });
+}
+
+template <class T, class U, class Op>
+auto parallel_reduce(vector<T> const& v, U init, Op op) -> U
+{
+  return less::parallel_reduce(v.data(), v.data() + v.size(),
+                               detail::move(init), op);
+}
+
+template <class T>
+auto parallel_reduce(vector<T> const& v, T init) -> T
+{
+  return less::parallel_reduce(v, detail::move(init), std::plus<>());
+}
+
+// Sorts `[first, last)` by `comp`, not stably.
+//
+// Runs of about `n / threads` elements are sorted with `std::sort()` in
+// parallel and then merged pairwise into a scratch buffer and back. Every
+// merge round is cut into equal pieces of output, each finding where it starts
+// in its two inputs with a binary search, so the final merges are as parallel
+// as the first ones. The scratch buffer is a `less::vector<T>` built with
+// `less::default_init`.
+//
+// If `comp` or a move throws, the range is left holding valid but
+// unspecified elements.
+//
+template <class T, class Compare>
+void parallel_sort(T* first, T* last, Compare comp)
+{
+  auto const n = static_cast<unsigned_long_type>(last - first);
+
+  auto const grain    = detail::auto_grain(n, LESS_PARALLEL_SORT_MIN_GRAIN);
+  auto const max_runs = default_thread_pool().size() + 1;
+
+  auto const num_runs = (n / grain < max_runs ? n / grain : max_runs);
+  if (num_runs < 2) {
+    std::sort(first, last, comp);
+    return;
+  }
+
+  // start of run `run`, or `n` past the last one
+  //
+  auto const bound = [&](unsigned_long_type run) {
+    return run < num_runs ? detail::split_point(n, num_runs, run) : n;
+  };
+
+  detail::parallel_chunks(
+      num_runs, 1u,
+      [&](unsigned_long_type b, unsigned_long_type e) {
+        for (; b < e; ++b) {
+          std::sort(first + bound(b), first + bound(b + 1), comp);
+        }
+      },
+      [](unsigned_long_type, unsigned_long_type) {});
+
+  // each merge round's output is cut into pieces merged independently
+  //
+  auto const max_pieces = 4 * max_runs;
+  auto const num_pieces = (n / grain < max_pieces ? n / grain : max_pieces);
+
+  auto const piece = [&](unsigned_long_type p) {
+    return detail::split_point(n, num_pieces, p);
+  };
+
+  auto scratch = vector<T>(default_init, n);
+  auto ranks   = vector<unsigned_long_type>(num_pieces + 1);
+
+  auto src = first;
+  auto dst = scratch.data();
+  for (auto width = unsigned_long_type{1}; width < num_runs; width *= 2) {
+    auto const step = 2 * width;
+
+    // where each piece starts in the first of the two runs it falls into,
+    // found up front since the merges below move elements out of `src`
+    //
+    for (auto p = unsigned_long_type{0}; p < num_pieces; ++p) {
+      auto const pos = piece(p);
+
+      auto run = unsigned_long_type{0};
+      while (bound(run + step) <= pos) {
+        run += step;
+      }
+
+      auto const lo  = bound(run);
+      auto const mid = bound(run + width);
+      auto const hi  = bound(run + step);
+      ranks[p] =
+          detail::co_rank(pos - lo, src + lo, mid - lo, src + mid, hi - mid,
+                          comp);
+    }
+
+    auto merge_pieces = [&](unsigned_long_type pb, unsigned_long_type pe) {
+      for (auto p = pb; p < pe; ++p) {
+        auto const b = piece(p);
+        auto const e = piece(p + 1);
+        for (auto run = unsigned_long_type{0}; run < num_runs; run += step) {
+          auto const lo  = bound(run);
+          auto const mid = bound(run + width);
+          auto const hi  = bound(run + step);
+          if (hi <= b || lo >= e) { continue; }
+
+          auto const kb = (b > lo ? b : lo) - lo;
+          auto const ke = (e < hi ? e : hi) - lo;
+          auto const ib = (b > lo ? ranks[p] : 0u);
+          auto const ie = (e < hi ? ranks[p + 1] : mid - lo);
+
+          std::merge(std::make_move_iterator(src + lo + ib),
+                     std::make_move_iterator(src + lo + ie),
+                     std::make_move_iterator(src + mid + (kb - ib)),
+                     std::make_move_iterator(src + mid + (ke - ie)),
+                     dst + lo + kb, comp);
+        }
+      }
+    };
+
+    detail::parallel_chunks(num_pieces, 1u, merge_pieces,
+                            [](unsigned_long_type, unsigned_long_type) {});
+
+    auto const tmp = src;
+    src            = dst;
+    dst            = tmp;
+  }
+
+  if (src != first) {
+    less::parallel_for(0u, n, [&](unsigned_long_type i) {
+      first[i] = detail::move(src[i]);
+    });
+  }
+}
+
+template <class T>
+void parallel_sort(T* first, T* last)
+{
+  less::parallel_sort(first, last, std::less<>());
+}
+
+template <class T, class Compare>
+void parallel_sort(vector<T>& v, Compare comp)
+{
+  less::parallel_sort(v.data(), v.data() + v.size(), comp);
+}
+
+template <class T>
+void parallel_sort(vector<T>& v)
+{
+  less::parallel_sort(v.data(), v.data() + v.size(), std::less<>());
+}
+
+}    // namespace less
+
+#endif    // LESS_PARALLEL_HPP
@@ -0,0 +1,920 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_PERSISTENT_VECTOR_HPP
+#define LESS_PERSISTENT_VECTOR_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+inline constexpr unsigned const rrb_bits  = 5u;
+inline constexpr unsigned const rrb_width = 1u << rrb_bits;
+inline constexpr unsigned const rrb_mask  = rrb_width - 1;
+
+// `owner` is the id of the transient that created the node, which may modify
+// it in place for as long as it's alive; 0 for nodes nobody may modify
+//
+struct rrb_node {
+  std::atomic<unsigned> refs{1u};
+  unsigned              count = 0u;
+  std::uint64_t         owner = 0u;
+};
+
+struct rrb_inner : rrb_node {
+  rrb_node* children[rrb_width];
+
+  // cumulative sizes of the subtrees, only for relaxed nodes
+  //
+  unsigned_long_type* sizes = nullptr;
+
+  ~rrb_inner()
+  {
+    delete[] sizes;
+  }
+};
+
+template <class T>
+struct rrb_leaf : rrb_node {
+  alignas(T) unsigned char storage[rrb_width * sizeof(T)];
+
+  auto elems() noexcept -> T*
+  {
+    return reinterpret_cast<T*>(storage);
+  }
+};
+
+inline auto next_transient_id() noexcept -> std::uint64_t
+{
+  static std::atomic<std::uint64_t> next{1};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+}    // namespace detail
+
+// An immutable vector whose modifications return new versions that share
+// almost all of their storage with the old one.
+//
+// Elements live in a relaxed radix-balanced tree of 32-way nodes plus a tail
+// leaf of up to 32 elements that appends go to. `push_back()`, `set()`,
+// `take()`, `drop()` and `slice()` copy only the O(log32 n) nodes on the path
+// they change, so keeping many versions around costs little more than one.
+// Nodes are reference counted with atomic counts, so versions can be shared
+// across threads.
+//
+// Trees are regular, indexed with plain bit shifts, until `drop()` or
+// `slice()` cut into the front. The nodes along the cut become relaxed and
+// carry a table of their subtrees' sizes, which lookups search starting from
+// the radix guess.
+//
+// For batches of changes, `transient()` gives a mutable `transient_type` that
+// modifies the nodes it created in place and hands back a new version with
+// `persistent()`.
+//
+template <class T>
+struct persistent_vector {
+ public:
+  using value_type      = T;
+  using size_type       = unsigned_long_type;
+  using difference_type = long_type;
+  using const_reference = T const&;
+
+  struct transient_type;
+
+ private:
+  using node  = detail::rrb_node;
+  using inner = detail::rrb_inner;
+  using leaf  = detail::rrb_leaf<T>;
+
+  static constexpr unsigned const bits  = detail::rrb_bits;
+  static constexpr unsigned const width = detail::rrb_width;
+  static constexpr unsigned const mask  = detail::rrb_mask;
+
+  // `root_` is at level `shift_`, i.e. its children hold `1 << shift_`
+  // elements each when full; leaves are at level 0
+  //
+  inner*    root_  = nullptr;
+  leaf*     tail_  = nullptr;
+  size_type size_  = 0u;
+  unsigned  shift_ = bits;
+
+  static void retain(node* n) noexcept
+  {
+    if (n) { n->refs.fetch_add(1u, std::memory_order_relaxed); }
+  }
+
+  static void release_leaf(leaf* l) noexcept
+  {
+    if (!l || l->refs.fetch_sub(1u, std::memory_order_acq_rel) != 1u) {
+      return;
+    }
+
+    for (auto i = 0u; i < l->count; ++i) {
+      l->elems()[i].~T();
+    }
+    delete l;
+  }
+
+  static void release(node* n, unsigned shift) noexcept
+  {
+    if (shift == 0) {
+      release_leaf(static_cast<leaf*>(n));
+      return;
+    }
+
+    if (!n || n->refs.fetch_sub(1u, std::memory_order_acq_rel) != 1u) {
+      return;
+    }
+
+    auto const in = static_cast<inner*>(n);
+    for (auto i = 0u; i < in->count; ++i) {
+      release(in->children[i], shift - bits);
+    }
+    delete in;
+  }
+
+  static auto new_inner(std::uint64_t edit, bool relaxed) -> inner*
+  {
+    auto const n = new inner();
+    n->owner     = edit;
+    if (relaxed) {
+      try {
+        n->sizes = new size_type[width];
+      }
+      catch (...) {
+        delete n;
+        throw;
+      }
+    }
+    return n;
+  }
+
+  static auto new_leaf(std::uint64_t edit) -> leaf*
+  {
+    auto const l = new leaf();
+    l->owner     = edit;
+    return l;
+  }
+
+  // a new leaf holding copies of `src`'s elements `[first, last)`
+  //
+  static auto copy_leaf(leaf* src, unsigned first, unsigned last,
+                        std::uint64_t edit) -> leaf*
+  {
+    auto const l = new_leaf(edit);
+    try {
+      for (; l->count < last - first; ++l->count) {
+        new (l->elems() + l->count, detail::placement_tag_t{})
+            T(src->elems()[first + l->count]);
+      }
+    }
+    catch (...) {
+      release_leaf(l);
+      throw;
+    }
+    return l;
+  }
+
+  static auto copy_inner(inner* src, std::uint64_t edit) -> inner*
+  {
+    auto const n = new_inner(edit, src->sizes != nullptr);
+    n->count     = src->count;
+    for (auto i = 0u; i < src->count; ++i) {
+      n->children[i] = src->children[i];
+      retain(n->children[i]);
+      if (n->sizes) { n->sizes[i] = src->sizes[i]; }
+    }
+    return n;
+  }
+
+  // The node to modify in place of `n`, which is `n` itself if the transient
+  // `edit` owns it and a copy otherwise. The caller owns a reference to it
+  // either way.
+  //
+  static auto editable(inner* n, std::uint64_t edit) -> inner*
+  {
+    if (edit != 0u && n->owner == edit) {
+      retain(n);
+      return n;
+    }
+    return copy_inner(n, edit);
+  }
+
+  static auto editable(leaf* l, std::uint64_t edit) -> leaf*
+  {
+    if (edit != 0u && l->owner == edit) {
+      retain(l);
+      return l;
+    }
+    return copy_leaf(l, 0u, l->count, edit);
+  }
+
+  // number of elements under `n`
+  //
+  static auto tree_size(node* n, unsigned shift) noexcept -> size_type
+  {
+    if (shift == 0) { return n->count; }
+
+    auto const in = static_cast<inner*>(n);
+    if (in->sizes) { return in->sizes[in->count - 1]; }
+
+    return (size_type{in->count - 1} << shift) +
+           tree_size(in->children[in->count - 1], shift - bits);
+  }
+
+  // the child of `n` holding its `i`th element, making `i` relative to it
+  //
+  static auto child_index(inner const* n, unsigned shift, size_type& i) noexcept
+      -> unsigned
+  {
+    if (!n->sizes) {
+      auto const idx = static_cast<unsigned>(i >> shift) & mask;
+      i -= size_type{idx} << shift;
+      return idx;
+    }
+
+    // a relaxed node's children hold at most `1 << shift` elements each, so
+    // the radix guess is never past the right one
+    //
+    auto idx = static_cast<unsigned>(i >> shift);
+    while (n->sizes[idx] <= i) {
+      ++idx;
+    }
+    if (idx > 0) { i -= n->sizes[idx - 1]; }
+    return idx;
+  }
+
+  auto tail_offset() const noexcept -> size_type
+  {
+    return size_ - (tail_ ? tail_->count : 0u);
+  }
+
+  // the leaf holding element `i`, making `i` relative to it
+  //
+  auto leaf_for(size_type& i) const noexcept -> leaf*
+  {
+    auto const offset = this->tail_offset();
+    if (i >= offset) {
+      i -= offset;
+      return tail_;
+    }
+
+    node* n = root_;
+    for (auto shift = shift_; shift > 0; shift -= bits) {
+      auto const in = static_cast<inner*>(n);
+      n             = in->children[child_index(in, shift, i)];
+    }
+    return static_cast<leaf*>(n);
+  }
+
+  // a chain of single-child nodes from level `shift` down to `l`
+  //
+  static auto new_path(unsigned shift, leaf* l, std::uint64_t edit) -> node*
+  {
+    if (shift == 0) { return l; }
+
+    auto const n = new_inner(edit, false);
+    try {
+      n->children[0] = new_path(shift - bits, l, edit);
+    }
+    catch (...) {
+      delete n;
+      throw;
+    }
+    n->count = 1u;
+    return n;
+  }
+
+  // Appends the leaf `l` to the subtree `n`, returning the node replacing
+  // `n`, or null if it's full. `l` only changes hands on success.
+  //
+  static auto push_leaf(inner* n, unsigned shift, leaf* l, std::uint64_t edit)
+      -> inner*
+  {
+    if (shift == bits) {
+      if (n->count == width) { return nullptr; }
+
+      auto const m = editable(n, edit);
+      if (m->sizes) {
+        m->sizes[m->count] = (m->count ? m->sizes[m->count - 1] : 0u) + l->count;
+      }
+      m->children[m->count++] = l;
+      return m;
+    }
+
+    auto const last = static_cast<inner*>(n->children[n->count - 1]);
+    if (auto const r = push_leaf(last, shift - bits, l, edit)) {
+      inner* m = nullptr;
+      try {
+        m = editable(n, edit);
+      }
+      catch (...) {
+        release(r, shift - bits);
+        throw;
+      }
+
+      release(m->children[m->count - 1], shift - bits);
+      m->children[m->count - 1] = r;
+      if (m->sizes) { m->sizes[m->count - 1] += l->count; }
+      return m;
+    }
+
+    if (n->count == width) { return nullptr; }
+
+    auto const path = new_path(shift - bits, l, edit);
+    inner*     m    = nullptr;
+    try {
+      m = editable(n, edit);
+    }
+    catch (...) {
+      delete_path(path, shift - bits);
+      throw;
+    }
+
+    if (m->sizes) { m->sizes[m->count] = m->sizes[m->count - 1] + l->count; }
+    m->children[m->count++] = path;
+    return m;
+  }
+
+  // frees the nodes `new_path()` made, but not the leaf at the bottom
+  //
+  static void delete_path(node* n, unsigned shift) noexcept
+  {
+    if (shift == 0) { return; }
+
+    auto const in = static_cast<inner*>(n);
+    delete_path(in->children[0], shift - bits);
+    delete in;
+  }
+
+  // moves the full tail into the tree
+  //
+  void push_tail(std::uint64_t edit)
+  {
+    auto const l = tail_;
+
+    if (!root_) {
+      root_              = new_inner(edit, false);
+      root_->children[0] = l;
+      root_->count       = 1u;
+      shift_             = bits;
+      tail_              = nullptr;
+      return;
+    }
+
+    if (auto const r = push_leaf(root_, shift_, l, edit)) {
+      release(root_, shift_);
+      root_ = r;
+      tail_ = nullptr;
+      return;
+    }
+
+    // the root is full, so the tree grows a level
+    //
+    auto const relaxed = (root_->sizes != nullptr);
+    auto const top     = new_inner(edit, relaxed);
+    try {
+      top->children[1] = new_path(shift_, l, edit);
+    }
+    catch (...) {
+      release(top, shift_ + bits);
+      throw;
+    }
+
+    top->children[0] = root_;
+    top->count       = 2u;
+    if (relaxed) {
+      top->sizes[0] = tree_size(root_, shift_);
+      top->sizes[1] = top->sizes[0] + l->count;
+    }
+
+    root_ = top;
+    shift_ += bits;
+    tail_ = nullptr;
+  }
+
+  template <class U>
+  void push_back_impl(U&& value, std::uint64_t edit)
+  {
+    if (tail_ && tail_->count < width) {
+      auto const l = editable(tail_, edit);
+      try {
+        new (l->elems() + l->count, detail::placement_tag_t{})
+            T(detail::forward<U>(value));
+      }
+      catch (...) {
+        release_leaf(l);
+        throw;
+      }
+      ++l->count;
+
+      release_leaf(tail_);
+      tail_ = l;
+      ++size_;
+      return;
+    }
+
+    auto const l = new_leaf(edit);
+    try {
+      new (l->elems(), detail::placement_tag_t{}) T(detail::forward<U>(value));
+    }
+    catch (...) {
+      release_leaf(l);
+      throw;
+    }
+    l->count = 1u;
+
+    if (tail_) {
+      try {
+        this->push_tail(edit);
+      }
+      catch (...) {
+        release_leaf(l);
+        throw;
+      }
+    }
+
+    tail_ = l;
+    ++size_;
+  }
+
+  // `n` with its `i`th element replaced by `value`
+  //
+  template <class U>
+  static auto set_in(node* n, unsigned shift, size_type i, U&& value,
+                     std::uint64_t edit) -> node*
+  {
+    if (shift == 0) {
+      auto const l = editable(static_cast<leaf*>(n), edit);
+      try {
+        l->elems()[i] = detail::forward<U>(value);
+      }
+      catch (...) {
+        release_leaf(l);
+        throw;
+      }
+      return l;
+    }
+
+    auto const m   = editable(static_cast<inner*>(n), edit);
+    auto const idx = child_index(m, shift, i);
+
+    node* c = nullptr;
+    try {
+      c = set_in(m->children[idx], shift - bits, i, detail::forward<U>(value),
+                 edit);
+    }
+    catch (...) {
+      release(m, shift);
+      throw;
+    }
+
+    release(m->children[idx], shift - bits);
+    m->children[idx] = c;
+    return m;
+  }
+
+  template <class U>
+  void set_impl(size_type i, U&& value, std::uint64_t edit)
+  {
+    if (i >= this->tail_offset()) {
+      auto const l = static_cast<leaf*>(
+          set_in(tail_, 0u, i - this->tail_offset(), detail::forward<U>(value),
+                 edit));
+      release_leaf(tail_);
+      tail_ = l;
+      return;
+    }
+
+    auto const r = static_cast<inner*>(
+        set_in(root_, shift_, i, detail::forward<U>(value), edit));
+    release(root_, shift_);
+    root_ = r;
+  }
+
+  // the first `m` elements of `n`, ending on a leaf boundary
+  //
+  static auto take_tree(node* n, unsigned shift, size_type m) -> node*
+  {
+    if (shift == 0 || m == tree_size(n, shift)) {
+      retain(n);
+      return n;
+    }
+
+    auto const in  = static_cast<inner*>(n);
+    auto       i   = m - 1;
+    auto const idx = child_index(in, shift, i);
+
+    auto const out = new_inner(0u, in->sizes != nullptr);
+    for (; out->count < idx; ++out->count) {
+      out->children[out->count] = in->children[out->count];
+      retain(out->children[out->count]);
+      if (out->sizes) { out->sizes[out->count] = in->sizes[out->count]; }
+    }
+
+    try {
+      out->children[idx] = take_tree(in->children[idx], shift - bits, i + 1);
+    }
+    catch (...) {
+      release(out, shift);
+      throw;
+    }
+    if (out->sizes) { out->sizes[idx] = m; }
+    ++out->count;
+    return out;
+  }
+
+  // `n` without its first `m` elements, relaxed along the cut
+  //
+  static auto drop_tree(node* n, unsigned shift, size_type m) -> node*
+  {
+    if (m == 0) {
+      retain(n);
+      return n;
+    }
+
+    if (shift == 0) {
+      auto const l = static_cast<leaf*>(n);
+      return copy_leaf(l, static_cast<unsigned>(m), l->count, 0u);
+    }
+
+    auto const in  = static_cast<inner*>(n);
+    auto       i   = m;
+    auto const idx = child_index(in, shift, i);
+
+    auto const out = new_inner(0u, true);
+    try {
+      out->children[0] = drop_tree(in->children[idx], shift - bits, i);
+    }
+    catch (...) {
+      delete out;
+      throw;
+    }
+    out->count = 1u;
+
+    for (auto k = idx + 1; k < in->count; ++k) {
+      out->children[out->count++] = in->children[k];
+      retain(in->children[k]);
+    }
+
+    auto total = size_type{0};
+    for (auto k = 0u; k < out->count; ++k) {
+      total += tree_size(out->children[k], shift - bits);
+      out->sizes[k] = total;
+    }
+    return out;
+  }
+
+  // removes root levels with a single child
+  //
+  void collapse() noexcept
+  {
+    while (shift_ > bits && root_->count == 1u) {
+      auto const child = static_cast<inner*>(root_->children[0]);
+      retain(child);
+      release(root_, shift_);
+      root_ = child;
+      shift_ -= bits;
+    }
+  }
+
+  template <class F>
+  static void for_each_in(node* n, unsigned shift, F& f)
+  {
+    if (shift == 0) {
+      auto const l = static_cast<leaf*>(n);
+      for (auto i = 0u; i < l->count; ++i) {
+        f(static_cast<T const&>(l->elems()[i]));
+      }
+      return;
+    }
+
+    auto const in = static_cast<inner*>(n);
+    for (auto i = 0u; i < in->count; ++i) {
+      for_each_in(in->children[i], shift - bits, f);
+    }
+  }
+
+ public:
+  persistent_vector() noexcept
+  {
+  }
+
+  // builds the tree in one go, through a transient
+  //
+  explicit persistent_vector(vector<T> const& v)
+  {
+    auto t = this->transient();
+    for (auto const& x : v) {
+      t.push_back(x);
+    }
+    *this = t.persistent();
+  }
+
+  persistent_vector(persistent_vector const& rhs) noexcept
+      : root_(rhs.root_)
+      , tail_(rhs.tail_)
+      , size_(rhs.size_)
+      , shift_(rhs.shift_)
+  {
+    retain(root_);
+    retain(tail_);
+  }
+
+  persistent_vector(persistent_vector&& rhs) noexcept
+      : root_(rhs.root_)
+      , tail_(rhs.tail_)
+      , size_(rhs.size_)
+      , shift_(rhs.shift_)
+  {
+    rhs.root_  = nullptr;
+    rhs.tail_  = nullptr;
+    rhs.size_  = 0u;
+    rhs.shift_ = bits;
+  }
+
+  ~persistent_vector()
+  {
+    release(root_, shift_);
+    release_leaf(tail_);
+  }
+
+  auto operator=(persistent_vector const& rhs) noexcept -> persistent_vector&
+  {
+    auto tmp = persistent_vector(rhs);
+    this->swap(tmp);
+    return *this;
+  }
+
+  auto operator=(persistent_vector&& rhs) noexcept -> persistent_vector&
+  {
+    auto tmp = persistent_vector(detail::move(rhs));
+    this->swap(tmp);
+    return *this;
+  }
+
+  // Element access
+
+  auto at(size_type const pos) const -> const_reference
+  {
+    if (pos >= size_) { throw out_of_range{}; }
+
+    return (*this)[pos];
+  }
+
+  auto operator[](size_type pos) const noexcept -> const_reference
+  {
+    return this->leaf_for(pos)->elems()[pos];
+  }
+
+  auto front() const noexcept -> const_reference
+  {
+    return (*this)[0];
+  }
+
+  auto back() const noexcept -> const_reference
+  {
+    return tail_->elems()[tail_->count - 1];
+  }
+
+  // Calls `f(x)` for every element in order, a leaf at a time.
+  //
+  template <class F>
+  void for_each(F f) const
+  {
+    if (root_) { for_each_in(root_, shift_, f); }
+    if (tail_) { for_each_in(tail_, 0u, f); }
+  }
+
+  auto to_vector() const -> vector<T>
+  {
+    auto v = vector<T>(with_capacity, size_);
+    this->for_each([&](T const& x) { v.push_back(x); });
+    return v;
+  }
+
+  // Capacity
+
+  bool empty() const noexcept
+  {
+    return size_ == 0u;
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return size_;
+  }
+
+  // New versions
+
+  auto push_back(T const& value) const -> persistent_vector
+  {
+    auto v = *this;
+    v.push_back_impl(value, 0u);
+    return v;
+  }
+
+  auto push_back(T&& value) const -> persistent_vector
+  {
+    auto v = *this;
+    v.push_back_impl(detail::move(value), 0u);
+    return v;
+  }
+
+  // this version with element `pos` replaced by `value`
+  //
+  auto set(size_type pos, T const& value) const -> persistent_vector
+  {
+    if (pos >= size_) { throw out_of_range{}; }
+
+    auto v = *this;
+    v.set_impl(pos, value, 0u);
+    return v;
+  }
+
+  auto set(size_type pos, T&& value) const -> persistent_vector
+  {
+    if (pos >= size_) { throw out_of_range{}; }
+
+    auto v = *this;
+    v.set_impl(pos, detail::move(value), 0u);
+    return v;
+  }
+
+  // the first `count` elements
+  //
+  auto take(size_type count) const -> persistent_vector
+  {
+    if (count >= size_) { return *this; }
+    if (count == 0) { return persistent_vector(); }
+
+    auto       v      = persistent_vector();
+    auto const offset = this->tail_offset();
+    if (count > offset) {
+      v.root_  = root_;
+      v.shift_ = shift_;
+      retain(root_);
+
+      v.tail_ = copy_leaf(tail_, 0u, static_cast<unsigned>(count - offset), 0u);
+      v.size_ = count;
+      return v;
+    }
+
+    // the leaf holding the last element kept becomes the tail
+    //
+    auto       i     = count - 1;
+    auto const l     = this->leaf_for(i);
+    auto const start = count - 1 - i;
+
+    v.tail_ = copy_leaf(l, 0u, static_cast<unsigned>(i + 1), 0u);
+    v.size_ = count;
+    if (start > 0) {
+      v.root_  = static_cast<inner*>(take_tree(root_, shift_, start));
+      v.shift_ = shift_;
+      v.collapse();
+    }
+    return v;
+  }
+
+  // everything but the first `count` elements
+  //
+  auto drop(size_type count) const -> persistent_vector
+  {
+    if (count == 0) { return *this; }
+    if (count >= size_) { return persistent_vector(); }
+
+    auto       v      = persistent_vector();
+    auto const offset = this->tail_offset();
+    if (count >= offset) {
+      v.tail_ = copy_leaf(tail_, static_cast<unsigned>(count - offset),
+                          tail_->count, 0u);
+      v.size_ = size_ - count;
+      return v;
+    }
+
+    v.root_  = static_cast<inner*>(drop_tree(root_, shift_, count));
+    v.shift_ = shift_;
+    v.tail_  = tail_;
+    v.size_  = size_ - count;
+    retain(tail_);
+    v.collapse();
+    return v;
+  }
+
+  // the elements `[first, last)`
+  //
+  auto slice(size_type first, size_type last) const -> persistent_vector
+  {
+    if (last > size_) { last = size_; }
+    if (first >= last) { return persistent_vector(); }
+
+    return this->take(last).drop(first);
+  }
+
+  // a mutable copy for batches of changes
+  //
+  auto transient() const -> transient_type
+  {
+    return transient_type(*this);
+  }
+
+  void swap(persistent_vector& other) noexcept
+  {
+    auto const root  = other.root_;
+    auto const tail  = other.tail_;
+    auto const size  = other.size_;
+    auto const shift = other.shift_;
+
+    other.root_  = root_;
+    other.tail_  = tail_;
+    other.size_  = size_;
+    other.shift_ = shift_;
+
+    root_  = root;
+    tail_  = tail;
+    size_  = size;
+    shift_ = shift;
+  }
+};
+
+// A `persistent_vector` under construction. Nodes it copies or creates belong
+// to it and are modified in place afterwards, so a batch of `push_back()`s
+// fills leaves directly instead of copying the tail for every element.
+// `persistent()` ends the batch: the nodes are frozen and the transient is
+// left empty.
+//
+template <class T>
+struct persistent_vector<T>::transient_type {
+ private:
+  persistent_vector v_;
+  std::uint64_t     edit_ = detail::next_transient_id();
+
+  friend struct persistent_vector;
+
+  explicit transient_type(persistent_vector const& v) noexcept
+      : v_(v)
+  {
+  }
+
+ public:
+  transient_type(transient_type const&) = delete;
+  auto operator=(transient_type const&) -> transient_type& = delete;
+
+  transient_type(transient_type&&) noexcept = default;
+
+  auto operator[](size_type pos) const noexcept -> const_reference
+  {
+    return v_[pos];
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return v_.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return v_.empty();
+  }
+
+  void push_back(T const& value)
+  {
+    v_.push_back_impl(value, edit_);
+  }
+
+  void push_back(T&& value)
+  {
+    v_.push_back_impl(detail::move(value), edit_);
+  }
+
+  void set(size_type pos, T const& value)
+  {
+    if (pos >= v_.size()) { throw out_of_range{}; }
+    v_.set_impl(pos, value, edit_);
+  }
+
+  void set(size_type pos, T&& value)
+  {
+    if (pos >= v_.size()) { throw out_of_range{}; }
+    v_.set_impl(pos, detail::move(value), edit_);
+  }
+
+  auto persistent() -> persistent_vector
+  {
+    edit_ = detail::next_transient_id();
+    return detail::move(v_);
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_PERSISTENT_VECTOR_HPP
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_POLY_COLLECTION_HPP
+#define LESS_POLY_COLLECTION_HPP
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
+
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+// A segment's elements seen as `Base`: element `i`'s `Base` subobject is at
+// `data + i * stride + offset`.
+//
+struct poly_range {
+  char*              data   = nullptr;
+  unsigned_long_type size   = 0;
+  unsigned_long_type stride = 0;
+  std::ptrdiff_t     offset = 0;
+};
+
+template <class Base>
+struct poly_segment_base {
+  std::type_info const* type;
+
+  explicit poly_segment_base(std::type_info const& t) noexcept
+      : type(&t)
+  {
+  }
+
+  virtual ~poly_segment_base() = default;
+
+  virtual auto size() const noexcept -> unsigned_long_type = 0;
+  virtual auto range() noexcept -> poly_range               = 0;
+  virtual void clear() noexcept                             = 0;
+};
+
+template <class Base, class Derived>
+struct poly_segment final : poly_segment_base<Base> {
+  vector<Derived> values;
+
+  poly_segment() noexcept
+      : poly_segment_base<Base>(typeid(Derived))
+  {
+  }
+
+  auto size() const noexcept -> unsigned_long_type override
+  {
+    return values.size();
+  }
+
+  auto range() noexcept -> poly_range override
+  {
+    auto r = poly_range{reinterpret_cast<char*>(values.data()), values.size(),
+                        sizeof(Derived), 0};
+    if (!values.empty()) {
+      auto const d = values.data();
+      r.offset     = reinterpret_cast<char*>(static_cast<Base*>(d)) -
+                 reinterpret_cast<char*>(d);
+    }
+    return r;
+  }
+
+  void clear() noexcept override
+  {
+    values.clear();
+  }
+};
+
+}    // namespace detail
+
+// Objects derived from `Base`, stored by value in one `less::vector` per
+// concrete type instead of behind a pointer each.
+//
+// Inserting a `D` appends to the `less::vector<D>` segment for `D`, so
+// elements are never allocated one at a time and those of the same type are
+// adjacent. `for_each(f)` visits every element as a `Base&`, one segment
+// after another, with a single virtual call per segment to find its bounds.
+// `for_each<D1, D2, ...>(f)` calls `f` with the concrete type for the
+// segments it names, so calls through a `final` type there are resolved
+// statically and can be inlined; other segments are visited as `Base&`.
+//
+// Elements are stored as the static type they were inserted as. Iteration
+// goes segment by segment in the order the types were first inserted.
+//
+template <class Base>
+struct poly_collection {
+ public:
+  using value_type = Base;
+  using size_type  = unsigned_long_type;
+
+ private:
+  using segment_ptr = std::unique_ptr<detail::poly_segment_base<Base>>;
+
+  vector<segment_ptr> segments_;
+
+  template <class D>
+  auto find_segment() const noexcept -> detail::poly_segment<Base, D>*
+  {
+    for (auto const& s : segments_) {
+      if (*s->type == typeid(D)) {
+        return static_cast<detail::poly_segment<Base, D>*>(s.get());
+      }
+    }
+    return nullptr;
+  }
+
+  template <class D>
+  auto get_segment() -> detail::poly_segment<Base, D>&
+  {
+    static_assert(std::is_base_of_v<Base, D>,
+                  "less::poly_collection elements have to derive from Base");
+
+    if (auto s = this->find_segment<D>()) { return *s; }
+
+    auto s = std::make_unique<detail::poly_segment<Base, D>>();
+    auto& r = *s;
+    segments_.push_back(detail::move(s));
+    return r;
+  }
+
+  template <class B, class F>
+  static void visit_base(detail::poly_range r, F& f)
+  {
+    for (auto i = size_type{0}; i < r.size; ++i) {
+      f(*reinterpret_cast<B*>(r.data + i * r.stride + r.offset));
+    }
+  }
+
+  template <class D, class F>
+  bool visit_as(detail::poly_segment_base<Base>& s, F& f)
+  {
+    if (*s.type != typeid(D)) { return false; }
+    for (auto& x : static_cast<detail::poly_segment<Base, D>&>(s).values) {
+      f(x);
+    }
+    return true;
+  }
+
+ public:
+  poly_collection() = default;
+
+  poly_collection(poly_collection&&) noexcept = default;
+  auto operator=(poly_collection&&) noexcept -> poly_collection& = default;
+
+  poly_collection(poly_collection const&) = delete;
+  auto operator=(poly_collection const&) -> poly_collection& = delete;
+
+  template <class D, class... Args>
+  auto emplace(Args&&... args) -> D&
+  {
+    return this->get_segment<D>().values.emplace_back(
+        detail::forward<Args>(args)...);
+  }
+
+  template <class D>
+  auto insert(D&& value) -> std::decay_t<D>&
+  {
+    using type = std::decay_t<D>;
+    return this->get_segment<type>().values.emplace_back(
+        detail::forward<D>(value));
+  }
+
+  // The elements of type `D`, created empty if there are none yet.
+  //
+  template <class D>
+  auto segment() -> vector<D>&
+  {
+    return this->get_segment<D>().values;
+  }
+
+  template <class D>
+  void reserve(size_type capacity)
+  {
+    this->get_segment<D>().values.reserve(capacity);
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    auto n = size_type{0};
+    for (auto const& s : segments_) {
+      n += s->size();
+    }
+    return n;
+  }
+
+  template <class D>
+  auto size() const noexcept -> size_type
+  {
+    auto const s = this->find_segment<D>();
+    return s ? s->values.size() : 0u;
+  }
+
+  bool empty() const noexcept
+  {
+    return this->size() == 0;
+  }
+
+  auto segment_count() const noexcept -> size_type
+  {
+    return segments_.size();
+  }
+
+  // Destroys every element but keeps the segments and their capacity.
+  //
+  void clear() noexcept
+  {
+    for (auto& s : segments_) {
+      s->clear();
+    }
+  }
+
+  template <class F>
+  void for_each(F f)
+  {
+    for (auto& s : segments_) {
+      visit_base<Base>(s->range(), f);
+    }
+  }
+
+  template <class F>
+  void for_each(F f) const
+  {
+    for (auto& s : segments_) {
+      visit_base<Base const>(s->range(), f);
+    }
+  }
+
+  template <class D, class... Ds, class F>
+  void for_each(F f)
+  {
+    for (auto& s : segments_) {
+      if (!(this->visit_as<D>(*s, f) || (this->visit_as<Ds>(*s, f) || ...))) {
+        visit_base<Base>(s->range(), f);
+      }
+    }
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_POLY_COLLECTION_HPP
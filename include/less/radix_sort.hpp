@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_RADIX_SORT_HPP
+#define LESS_RADIX_SORT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+template <unsigned_long_type Size>
+struct radix_uint;
+
+template <>
+struct radix_uint<1> {
+  using type = std::uint8_t;
+};
+
+template <>
+struct radix_uint<2> {
+  using type = std::uint16_t;
+};
+
+template <>
+struct radix_uint<4> {
+  using type = std::uint32_t;
+};
+
+template <>
+struct radix_uint<8> {
+  using type = std::uint64_t;
+};
+
+// Maps `key` to an unsigned integer that orders the same way. Signed integers
+// get their sign bit flipped; floats get it set when positive and all their
+// bits flipped when negative, so -0.0 sorts before 0.0 and NaNs end up at
+// either end depending on their sign.
+//
+template <class K>
+auto radix_bits(K key) noexcept -> typename radix_uint<sizeof(K)>::type
+{
+  static_assert(std::is_arithmetic_v<K>,
+                "less::radix_sort keys must be integers or floating point");
+
+  using U = typename radix_uint<sizeof(K)>::type;
+
+  constexpr U const sign = U(1) << (sizeof(K) * 8 - 1);
+
+  if constexpr (std::is_floating_point_v<K>) {
+    auto u = U();
+    std::memcpy(&u, &key, sizeof(K));
+    return (u & sign) ? U(~u) : U(u | sign);
+  }
+  else if constexpr (std::is_signed_v<K>) {
+    return U(U(key) ^ sign);
+  }
+  else {
+    return U(key);
+  }
+}
+
+// Sorts `data` by `key`, using `scratch` for as many elements, and returns
+// whichever of the two holds the result.
+//
+template <class T, class KeyFn>
+auto radix_sort_impl(T* data, T* scratch, unsigned_long_type n, KeyFn& key)
+    -> T*
+{
+  using U = decltype(radix_bits(key(data[0])));
+
+  // 11-bit digits take 3 passes for 32-bit keys and 6 for 64-bit ones
+  // instead of 4 and 8 with bytes. Counting every pass in one sweep then needs
+  // 48 or 96 KiB of counters, which lives in L2 rather than L1; a pass over
+  // the data saved is worth more than that. Narrow keys use bytes.
+  //
+  constexpr unsigned const key_bits   = sizeof(U) * 8;
+  constexpr unsigned const digit_bits = (key_bits <= 16 ? 8u : 11u);
+  constexpr unsigned const passes = (key_bits + digit_bits - 1) / digit_bits;
+  constexpr unsigned_long_type const radix = unsigned_long_type{1}
+                                             << digit_bits;
+  constexpr U const mask = U(radix - 1);
+
+  // the counts of every pass, gathered in a single sweep
+  //
+  auto counts = vector<unsigned_long_type>(passes * radix);
+  for (auto i = unsigned_long_type{0}; i < n; ++i) {
+    auto const k = radix_bits(key(data[i]));
+    for (auto p = 0u; p < passes; ++p) {
+      ++counts[p * radix + ((k >> (p * digit_bits)) & mask)];
+    }
+  }
+
+  auto src = data;
+  auto dst = scratch;
+  for (auto p = 0u; p < passes; ++p) {
+    auto const c     = counts.data() + p * radix;
+    auto const shift = p * digit_bits;
+
+    // every element has the same digit, so this pass wouldn't move anything
+    //
+    if (c[(radix_bits(key(src[0])) >> shift) & mask] == n) { continue; }
+
+    auto sum = unsigned_long_type{0};
+    for (auto d = unsigned_long_type{0}; d < radix; ++d) {
+      auto const count = c[d];
+      c[d]             = sum;
+      sum += count;
+    }
+
+    for (auto i = unsigned_long_type{0}; i < n; ++i) {
+      auto const d = (radix_bits(key(src[i])) >> shift) & mask;
+      dst[c[d]++]  = detail::move(src[i]);
+    }
+
+    auto const tmp = src;
+    src            = dst;
+    dst            = tmp;
+  }
+
+  return src;
+}
+
+struct radix_identity {
+  template <class T>
+  auto operator()(T const& x) const noexcept -> T
+  {
+    return x;
+  }
+};
+
+}    // namespace detail
+
+// Stable LSD radix sort of `v` by `key(x)`, which has to return an integer or
+// floating-point value; without `key` the elements are the keys.
+//
+// All digit counts are gathered in one pass over the input, then each digit
+// moves the elements between `v` and a scratch vector built with
+// `less::default_init`, so it's never zeroed. Digits that are the same for
+// every element are skipped. Ends with `v` swapping buffers with the scratch
+// vector when that's where the result is.
+//
+template <class T, class KeyFn>
+void radix_sort(vector<T>& v, KeyFn key)
+{
+  if (v.size() < 2) { return; }
+
+  auto scratch = vector<T>(default_init, v.size());
+  if (detail::radix_sort_impl(v.data(), scratch.data(), v.size(), key) !=
+      v.data()) {
+    v.swap(scratch);
+  }
+}
+
+template <class T>
+void radix_sort(vector<T>& v)
+{
+  less::radix_sort(v, detail::radix_identity());
+}
+
+template <class T, class KeyFn>
+void radix_sort(T* first, T* last, KeyFn key)
+{
+  auto const n = static_cast<unsigned_long_type>(last - first);
+  if (n < 2) { return; }
+
+  auto scratch = vector<T>(default_init, n);
+
+  auto const result = detail::radix_sort_impl(first, scratch.data(), n, key);
+  if (result != first) {
+    for (auto i = unsigned_long_type{0}; i < n; ++i) {
+      first[i] = detail::move(result[i]);
+    }
+  }
+}
+
+template <class T>
+void radix_sort(T* first, T* last)
+{
+  less::radix_sort(first, last, detail::radix_identity());
+}
+
+}    // namespace less
+
+#endif    // LESS_RADIX_SORT_HPP
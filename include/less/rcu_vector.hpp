@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_RCU_VECTOR_HPP
+#define LESS_RCU_VECTOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+// Spreads threads over reader slots so that, most of the time, each one keeps
+// hitting a cache line no other thread writes to.
+//
+inline auto reader_hint() noexcept -> unsigned
+{
+  static std::atomic<unsigned> next{0};
+  thread_local unsigned const  hint =
+      next.fetch_add(1, std::memory_order_relaxed);
+  return hint;
+}
+
+}    // namespace detail
+
+// A vector that's read far more often than it's written.
+//
+// Readers take a `snapshot`, an immutable view of the elements as they were at
+// that moment, without locking and without touching any shared counter.
+// Writers copy the current elements, modify the copy and publish it with one
+// atomic pointer swap; readers holding an older snapshot keep using it
+// undisturbed.
+//
+// Old versions are freed using epoch-based reclamation. A reader announces the
+// current epoch in a slot of its own, on its own cache line, before loading
+// the pointer and clears it when the snapshot is destroyed. Every publish
+// advances the epoch and tags the replaced version with it; a version is freed
+// once no slot announces an epoch at or before its tag. That check runs after
+// each publish and in `reclaim()`, so a long-lived snapshot only delays
+// freeing what was replaced after it was taken.
+//
+// Up to `max_readers` snapshots can be alive at once; taking one more spins
+// until a slot frees up. Writers are serialized with a mutex readers never
+// see.
+//
+template <class T>
+struct rcu_vector {
+ public:
+  using value_type      = T;
+  using size_type       = unsigned_long_type;
+  using difference_type = long_type;
+  using const_reference = T const&;
+  using const_pointer   = T const*;
+  using const_iterator  = const_pointer;
+
+  static constexpr unsigned const max_readers = 128u;
+
+ private:
+  struct alignas(64) reader_slot {
+    std::atomic<std::uint64_t> epoch{0};
+  };
+
+  struct node {
+    vector<T>     elems;
+    std::uint64_t retired = 0;
+  };
+
+  alignas(64) std::atomic<node*> current_;
+  alignas(64) std::atomic<std::uint64_t> epoch_{1};
+
+  mutable reader_slot slots_[max_readers];
+
+  std::mutex    writer_m_;
+  vector<node*> retired_;
+
+  auto pin() const noexcept -> reader_slot*
+  {
+    auto i = detail::reader_hint();
+    while (true) {
+      for (auto n = 0u; n < max_readers; ++n, ++i) {
+        auto& slot     = slots_[i % max_readers];
+        auto  expected = std::uint64_t{0};
+        auto  e        = epoch_.load();
+        if (slot.epoch.load(std::memory_order_relaxed) == 0 &&
+            slot.epoch.compare_exchange_strong(expected, e)) {
+          return &slot;
+        }
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  // the oldest epoch any reader might still be using
+  //
+  auto min_pinned() const noexcept -> std::uint64_t
+  {
+    auto min = ~std::uint64_t{0};
+    for (auto const& slot : slots_) {
+      auto const e = slot.epoch.load();
+      if (e != 0 && e < min) { min = e; }
+    }
+    return min;
+  }
+
+  // expects `writer_m_` to be held
+  //
+  void reclaim_locked() noexcept
+  {
+    if (retired_.empty()) { return; }
+
+    auto const min = this->min_pinned();
+
+    auto kept = size_type{0};
+    for (auto p : retired_) {
+      if (p->retired < min) {
+        delete p;
+      }
+      else {
+        retired_[kept++] = p;
+      }
+    }
+    retired_.resize(kept);
+  }
+
+  // expects `writer_m_` to be held
+  //
+  void publish_locked(node* fresh)
+  {
+    // making room first keeps retiring the old version from failing
+    //
+    try {
+      detail::grow_capacity(retired_, retired_.size() + 1);
+    }
+    catch (...) {
+      delete fresh;
+      throw;
+    }
+
+    auto const old = current_.exchange(fresh);
+    old->retired   = epoch_.fetch_add(1);
+    retired_.push_back(old);
+
+    this->reclaim_locked();
+  }
+
+ public:
+  // A consistent, immutable view of the elements. Keeps its version alive,
+  // and the reader slot it occupies busy, until destroyed.
+  //
+  struct snapshot {
+   private:
+    reader_slot*     slot_ = nullptr;
+    vector<T> const* v_    = nullptr;
+
+    friend struct rcu_vector;
+
+    snapshot(reader_slot* slot, vector<T> const* v) noexcept
+        : slot_(slot)
+        , v_(v)
+    {
+    }
+
+   public:
+    snapshot(snapshot const&) = delete;
+    auto operator=(snapshot const&) -> snapshot& = delete;
+
+    snapshot(snapshot&& rhs) noexcept
+        : slot_(rhs.slot_)
+        , v_(rhs.v_)
+    {
+      rhs.slot_ = nullptr;
+      rhs.v_    = nullptr;
+    }
+
+    ~snapshot()
+    {
+      if (slot_) { slot_->epoch.store(0, std::memory_order_release); }
+    }
+
+    auto at(size_type const pos) const -> const_reference
+    {
+      return v_->at(pos);
+    }
+
+    auto operator[](size_type const pos) const -> const_reference
+    {
+      return (*v_)[pos];
+    }
+
+    auto front() const -> const_reference
+    {
+      return v_->front();
+    }
+
+    auto back() const -> const_reference
+    {
+      return v_->back();
+    }
+
+    auto data() const noexcept -> T const*
+    {
+      return v_->data();
+    }
+
+    auto begin() const noexcept -> const_iterator
+    {
+      return v_->begin();
+    }
+
+    auto end() const noexcept -> const_iterator
+    {
+      return v_->end();
+    }
+
+    bool empty() const noexcept
+    {
+      return v_->empty();
+    }
+
+    auto size() const noexcept -> size_type
+    {
+      return v_->size();
+    }
+  };
+
+  rcu_vector()
+      : current_(new node())
+  {
+  }
+
+  explicit rcu_vector(vector<T> elems)
+      : current_(new node{detail::move(elems)})
+  {
+  }
+
+  rcu_vector(rcu_vector const&) = delete;
+  auto operator=(rcu_vector const&) -> rcu_vector& = delete;
+
+  // no snapshot may outlive the vector
+  //
+  ~rcu_vector()
+  {
+    for (auto p : retired_) {
+      delete p;
+    }
+    delete current_.load();
+  }
+
+  // Lock-free; never blocks unless `max_readers` snapshots are already alive.
+  //
+  auto read() const noexcept -> snapshot
+  {
+    auto const slot = this->pin();
+    return snapshot(slot, &current_.load()->elems);
+  }
+
+  // Publishes `elems` as the new contents.
+  //
+  void store(vector<T> elems)
+  {
+    auto fresh = new node{detail::move(elems)};
+
+    auto lock = std::lock_guard<std::mutex>(writer_m_);
+    this->publish_locked(fresh);
+  }
+
+  // Copies the current contents, lets `f(less::vector<T>&)` modify the copy
+  // and publishes it. Updates are serialized, so none of them is lost.
+  //
+  template <class F>
+  void update(F f)
+  {
+    auto lock = std::lock_guard<std::mutex>(writer_m_);
+
+    auto fresh = new node{current_.load(std::memory_order_relaxed)->elems};
+    try {
+      f(fresh->elems);
+    }
+    catch (...) {
+      delete fresh;
+      throw;
+    }
+
+    this->publish_locked(fresh);
+  }
+
+  // Frees replaced versions no reader can still be using.
+  //
+  void reclaim() noexcept
+  {
+    auto lock = std::lock_guard<std::mutex>(writer_m_);
+    this->reclaim_locked();
+  }
+
+  // number of replaced versions waiting to be freed
+  //
+  auto pending() noexcept -> size_type
+  {
+    auto lock = std::lock_guard<std::mutex>(writer_m_);
+    return retired_.size();
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_RCU_VECTOR_HPP
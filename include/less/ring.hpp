@@ -0,0 +1,460 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_RING_HPP
+#define LESS_RING_HPP
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+// uninitialized room for one `T`; a `less::vector` of these constructed with
+// `less::default_init` is raw storage straight from the vector's allocation
+//
+template <class T>
+struct ring_slot {
+  alignas(T) unsigned char bytes[sizeof(T)];
+
+  auto get() noexcept -> T*
+  {
+    return reinterpret_cast<T*>(bytes);
+  }
+};
+
+inline auto ring_capacity(unsigned_long_type n) noexcept -> unsigned_long_type
+{
+  auto cap = unsigned_long_type{2};
+  while (cap < n) {
+    cap *= 2;
+  }
+  return cap;
+}
+
+}    // namespace detail
+
+// A bounded single-producer, single-consumer queue.
+//
+// Exactly one thread may push and one thread may pop at a time; both sides are
+// wait-free. The producer owns `tail_` and the consumer `head_`, each on its
+// own cache line along with a cached copy of the other side's index, so the
+// shared line is only read when the cached value says the ring looks full or
+// empty.
+//
+// `push_n()` and `pop_n()` move as many elements as fit in one go, as at most
+// two `memcpy()`s around the wrap point for trivially copyable types.
+//
+template <class T>
+struct spsc_ring {
+ public:
+  using value_type = T;
+  using size_type  = unsigned_long_type;
+
+ private:
+  vector<detail::ring_slot<T>> slots_;
+  size_type                    mask_;
+
+  alignas(64) std::atomic<size_type> head_{0u};
+  size_type cached_tail_ = 0u;
+
+  alignas(64) std::atomic<size_type> tail_{0u};
+  size_type cached_head_ = 0u;
+
+  auto slot(size_type pos) noexcept -> T*
+  {
+    return slots_[pos & mask_].get();
+  }
+
+  // number of free slots as far as the producer can tell
+  //
+  auto free_space(size_type tail, size_type want) noexcept -> size_type
+  {
+    auto const cap = slots_.size();
+    if (cap - (tail - cached_head_) < want) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+    }
+    return cap - (tail - cached_head_);
+  }
+
+  auto available(size_type head, size_type want) noexcept -> size_type
+  {
+    if (cached_tail_ - head < want) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+    }
+    return cached_tail_ - head;
+  }
+
+ public:
+  // Rounds `capacity` up to a power of two, at least 2.
+  //
+  explicit spsc_ring(size_type capacity)
+      : slots_(default_init, detail::ring_capacity(capacity))
+      , mask_(slots_.size() - 1)
+  {
+  }
+
+  spsc_ring(spsc_ring const&) = delete;
+  auto operator=(spsc_ring const&) -> spsc_ring& = delete;
+
+  ~spsc_ring()
+  {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    for (auto pos = head_.load(std::memory_order_relaxed); pos != tail;
+         ++pos) {
+      this->slot(pos)->~T();
+    }
+  }
+
+  auto capacity() const noexcept -> size_type
+  {
+    return slots_.size();
+  }
+
+  // exact when called from either end while the other one is idle
+  //
+  auto size() const noexcept -> size_type
+  {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+  bool empty() const noexcept
+  {
+    return this->size() == 0u;
+  }
+
+  // Producer
+
+  template <class... Args>
+  bool try_emplace(Args&&... args)
+  {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    if (this->free_space(tail, 1) == 0) { return false; }
+
+    new (this->slot(tail), detail::placement_tag_t{})
+        T(detail::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_push(T const& value)
+  {
+    return this->try_emplace(value);
+  }
+
+  bool try_push(T&& value)
+  {
+    return this->try_emplace(detail::move(value));
+  }
+
+  // Copies up to `count` elements from `first` and returns how many fit.
+  //
+  auto push_n(T const* first, size_type count) -> size_type
+  {
+    auto const tail  = tail_.load(std::memory_order_relaxed);
+    auto const space = this->free_space(tail, count);
+    auto const n     = (count < space ? count : space);
+
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      auto const begin = tail & mask_;
+      auto const split = slots_.size() - begin;
+      auto const n1    = (n < split ? n : split);
+      if (n1 > 0) { std::memcpy(this->slot(tail), first, n1 * sizeof(T)); }
+      if (n > n1) {
+        std::memcpy(this->slot(0), first + n1, (n - n1) * sizeof(T));
+      }
+    }
+    else {
+      auto i = size_type{0};
+      try {
+        for (; i < n; ++i) {
+          new (this->slot(tail + i), detail::placement_tag_t{})
+              T(first[i]);
+        }
+      }
+      catch (...) {
+        // whatever was copied before the exception is published
+        //
+        tail_.store(tail + i, std::memory_order_release);
+        throw;
+      }
+    }
+
+    tail_.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  // Consumer
+
+  bool try_pop(T& out)
+  {
+    auto const head = head_.load(std::memory_order_relaxed);
+    if (this->available(head, 1) == 0) { return false; }
+
+    auto const p = this->slot(head);
+    out          = detail::move(*p);
+    p->~T();
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Moves up to `count` elements into `out` and returns how many there were.
+  //
+  auto pop_n(T* out, size_type count) -> size_type
+  {
+    auto const head  = head_.load(std::memory_order_relaxed);
+    auto const avail = this->available(head, count);
+    auto const n     = (count < avail ? count : avail);
+
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      auto const begin = head & mask_;
+      auto const split = slots_.size() - begin;
+      auto const n1    = (n < split ? n : split);
+      if (n1 > 0) { std::memcpy(out, this->slot(head), n1 * sizeof(T)); }
+      if (n > n1) {
+        std::memcpy(out + n1, this->slot(0), (n - n1) * sizeof(T));
+      }
+    }
+    else {
+      auto i = size_type{0};
+      try {
+        for (; i < n; ++i) {
+          auto const p = this->slot(head + i);
+          out[i]       = detail::move(*p);
+          p->~T();
+        }
+      }
+      catch (...) {
+        // the element that failed to move stays at the front
+        //
+        head_.store(head + i, std::memory_order_release);
+        throw;
+      }
+    }
+
+    head_.store(head + n, std::memory_order_release);
+    return n;
+  }
+};
+
+// A bounded multi-producer, multi-consumer queue.
+//
+// Every slot carries a sequence number saying whether it's ready to be written
+// or read in the current lap around the ring (Vyukov's bounded queue).
+// Producers claim slots by advancing `tail_` with a CAS, consumers by
+// advancing `head_`, and the two indices live on separate cache lines. A
+// thread only retries when another thread of the same kind made progress, so
+// the queue is lock-free; wait-freedom is left to `less::spsc_ring`.
+//
+// `push_n()` and `pop_n()` claim a run of consecutive ready slots with a
+// single CAS. Since any element may be moved out of or into the ring while
+// other threads hold claims, `T` has to be nothrow move constructible and
+// assignable.
+//
+template <class T>
+struct mpmc_ring {
+  static_assert(std::is_nothrow_move_constructible_v<T> &&
+                    std::is_nothrow_move_assignable_v<T>,
+                "less::mpmc_ring requires nothrow moves");
+
+ public:
+  using value_type = T;
+  using size_type  = unsigned_long_type;
+
+ private:
+  struct cell {
+    std::atomic<size_type> seq;
+    detail::ring_slot<T>   value;
+  };
+
+  vector<cell> cells_;
+  size_type    mask_;
+
+  alignas(64) std::atomic<size_type> head_{0u};
+  alignas(64) std::atomic<size_type> tail_{0u};
+
+  // Claims up to `count` slots starting at the index `pos` points to, as long
+  // as each slot's sequence is `ready_offset` past its position. Returns the
+  // first claimed position and sets `count` to how many were claimed.
+  //
+  auto claim(std::atomic<size_type>& pos, size_type ready_offset,
+             size_type& count) noexcept -> size_type
+  {
+    auto p = pos.load(std::memory_order_relaxed);
+    while (true) {
+      auto n = size_type{0};
+      for (; n < count; ++n) {
+        auto const seq =
+            cells_[(p + n) & mask_].seq.load(std::memory_order_acquire);
+        if (seq != p + n + ready_offset) { break; }
+      }
+
+      if (n == 0) {
+        // nothing ready, unless another thread claimed `p` meanwhile
+        //
+        auto const now = pos.load(std::memory_order_relaxed);
+        if (now == p) {
+          count = 0;
+          return p;
+        }
+        p = now;
+        continue;
+      }
+
+      if (pos.compare_exchange_weak(p, p + n, std::memory_order_relaxed)) {
+        count = n;
+        return p;
+      }
+    }
+  }
+
+  void publish(size_type pos, size_type seq) noexcept
+  {
+    cells_[pos & mask_].seq.store(seq, std::memory_order_release);
+  }
+
+  auto slot(size_type pos) noexcept -> T*
+  {
+    return cells_[pos & mask_].value.get();
+  }
+
+ public:
+  // Rounds `capacity` up to a power of two, at least 2.
+  //
+  explicit mpmc_ring(size_type capacity)
+      : cells_(default_init, detail::ring_capacity(capacity))
+      , mask_(cells_.size() - 1)
+  {
+    for (auto i = size_type{0}; i < cells_.size(); ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  mpmc_ring(mpmc_ring const&) = delete;
+  auto operator=(mpmc_ring const&) -> mpmc_ring& = delete;
+
+  ~mpmc_ring()
+  {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    for (auto pos = head_.load(std::memory_order_relaxed); pos != tail;
+         ++pos) {
+      this->slot(pos)->~T();
+    }
+  }
+
+  auto capacity() const noexcept -> size_type
+  {
+    return cells_.size();
+  }
+
+  // only a snapshot while other threads push or pop
+  //
+  auto size() const noexcept -> size_type
+  {
+    auto const head = head_.load(std::memory_order_acquire);
+    auto const tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0u;
+  }
+
+  bool empty() const noexcept
+  {
+    return this->size() == 0u;
+  }
+
+  // Producers
+
+  bool try_push(T const& value)
+  {
+    // copy before claiming so a throwing copy can't leave a hole
+    //
+    auto copy = value;
+    return this->try_push(detail::move(copy));
+  }
+
+  bool try_push(T&& value) noexcept
+  {
+    auto n   = size_type{1};
+    auto pos = this->claim(tail_, 0u, n);
+    if (n == 0) { return false; }
+
+    new (this->slot(pos), detail::placement_tag_t{}) T(detail::move(value));
+    this->publish(pos, pos + 1);
+    return true;
+  }
+
+  template <class... Args>
+  bool try_emplace(Args&&... args)
+  {
+    return this->try_push(T(detail::forward<Args>(args)...));
+  }
+
+  // Copies up to `count` elements from `first` and returns how many fit.
+  //
+  auto push_n(T const* first, size_type count) noexcept -> size_type
+  {
+    static_assert(std::is_nothrow_copy_constructible_v<T>,
+                  "claimed slots have to be filled without throwing");
+
+    auto const pos = this->claim(tail_, 0u, count);
+
+    for (auto i = size_type{0}; i < count; ++i) {
+      if constexpr (std::is_trivially_copyable_v<T>) {
+        std::memcpy(this->slot(pos + i), first + i, sizeof(T));
+      }
+      else {
+        new (this->slot(pos + i), detail::placement_tag_t{})
+            T(first[i]);
+      }
+      this->publish(pos + i, pos + i + 1);
+    }
+    return count;
+  }
+
+  // Consumers
+
+  bool try_pop(T& out) noexcept
+  {
+    auto n   = size_type{1};
+    auto pos = this->claim(head_, 1u, n);
+    if (n == 0) { return false; }
+
+    auto const p = this->slot(pos);
+    out          = detail::move(*p);
+    p->~T();
+    this->publish(pos, pos + cells_.size());
+    return true;
+  }
+
+  // Moves up to `count` elements into `out` and returns how many there were.
+  //
+  auto pop_n(T* out, size_type count) noexcept -> size_type
+  {
+    auto const pos = this->claim(head_, 1u, count);
+
+    for (auto i = size_type{0}; i < count; ++i) {
+      auto const p = this->slot(pos + i);
+      if constexpr (std::is_trivially_copyable_v<T>) {
+        std::memcpy(out + i, p, sizeof(T));
+      }
+      else {
+        out[i] = detail::move(*p);
+        p->~T();
+      }
+      this->publish(pos + i, pos + i + cells_.size());
+    }
+    return count;
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_RING_HPP
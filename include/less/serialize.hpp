@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_SERIALIZE_HPP
+#define LESS_SERIALIZE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <less/system_error.hpp>
+#include <less/vector.hpp>
+
+// A flat binary format for vectors of trivially copyable types:
+//
+//   [0, 64)                 `detail::serial_header`, zero padded
+//   [64, 64 + count * size) the elements, exactly as they sit in memory
+//
+// The payload starts at a multiple of 64 bytes so a buffer or `mmap()`ed file
+// holding a serialized vector can be viewed in place with `less::vector_view`
+// without copying anything.
+//
+namespace less {
+namespace detail {
+
+struct serial_header {
+  char          magic[8];
+  std::uint32_t version;
+  std::uint32_t endian;
+  std::uint32_t value_size;
+  std::uint32_t value_align;
+  std::uint64_t count;
+  std::uint64_t payload_offset;
+  std::uint64_t checksum;
+};
+
+inline constexpr char const serial_magic[8] = {'l', 'e', 's', 's',
+                                               's', 'e', 'r', '\0'};
+
+inline constexpr std::uint32_t const serial_version = 1;
+
+// written in native byte order; reading it back as anything else means the
+// data came from a machine with different endianness
+//
+inline constexpr std::uint32_t const serial_endian = 0x01020304u;
+
+inline constexpr unsigned_long_type const serial_header_size = 64;
+
+static_assert(sizeof(serial_header) <= serial_header_size);
+
+inline auto load64(unsigned char const* p) noexcept -> std::uint64_t
+{
+  auto w = std::uint64_t{0};
+  std::memcpy(&w, p, sizeof(w));
+  return w;
+}
+
+inline auto mix64(std::uint64_t h) noexcept -> std::uint64_t
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+// A non-cryptographic 64-bit checksum that runs four independent lanes over
+// 32-byte blocks so it keeps up with memory bandwidth.
+//
+inline auto checksum(void const* data, unsigned_long_type size) noexcept
+    -> std::uint64_t
+{
+  constexpr std::uint64_t const k = 0x9e3779b97f4a7c15ull;
+
+  auto p = static_cast<unsigned char const*>(data);
+
+  std::uint64_t h[4] = {k, k ^ 1, k ^ 2, k ^ 3};
+
+  auto n = size;
+  for (; n >= 32; n -= 32, p += 32) {
+    for (auto i = 0u; i < 4; ++i) {
+      h[i] = (h[i] ^ load64(p + 8 * i)) * k;
+      h[i] ^= h[i] >> 29;
+    }
+  }
+
+  auto tail = std::uint64_t{0};
+  for (auto i = 0u; n >= 8; n -= 8, p += 8, ++i) {
+    h[i] = (h[i] ^ load64(p)) * k;
+    h[i] ^= h[i] >> 29;
+  }
+  if (n > 0) { std::memcpy(&tail, p, n); }
+
+  auto r = mix64(mix64(size) ^ tail);
+  for (auto i = 0u; i < 4; ++i) {
+    r = mix64(r ^ h[i]);
+  }
+  return r;
+}
+
+}    // namespace detail
+
+struct skip_checksum_t {};
+inline constexpr skip_checksum_t skip_checksum;
+
+// number of bytes `serialize()` produces for `count` elements of `T`
+//
+template <class T>
+constexpr auto serialized_size(unsigned_long_type count) noexcept
+    -> unsigned_long_type
+{
+  return detail::serial_header_size + count * sizeof(T);
+}
+
+// Writes `count` elements starting at `data` in the format described above by
+// calling `sink(void const* bytes, unsigned_long_type size)` with consecutive
+// pieces of the output.
+//
+template <class T, class Sink>
+void serialize(T const* data, unsigned_long_type count, Sink&& sink)
+{
+  static_assert(std::is_trivially_copyable_v<T>,
+                "less::serialize requires a trivially copyable type");
+  static_assert(alignof(T) <= detail::serial_header_size);
+
+  unsigned char header[detail::serial_header_size] = {};
+
+  auto h = detail::serial_header();
+  std::memcpy(h.magic, detail::serial_magic, sizeof(h.magic));
+  h.version        = detail::serial_version;
+  h.endian         = detail::serial_endian;
+  h.value_size     = sizeof(T);
+  h.value_align    = alignof(T);
+  h.count          = count;
+  h.payload_offset = detail::serial_header_size;
+  h.checksum       = detail::checksum(data, count * sizeof(T));
+  std::memcpy(header, &h, sizeof(h));
+
+  sink(static_cast<void const*>(header), detail::serial_header_size);
+  if (count > 0) {
+    sink(static_cast<void const*>(data), count * sizeof(T));
+  }
+}
+
+template <class T, class Sink>
+void serialize(vector<T> const& v, Sink&& sink)
+{
+  less::serialize(v.data(), v.size(), sink);
+}
+
+// A read-only view of a vector serialized with `less::serialize()`. The view
+// points straight into the buffer it was created from, which must outlive it.
+//
+// Construction checks the header against `T` and throws `less::format_error`
+// if the buffer is truncated, misaligned for `T`, from another version or byte
+// order, or fails its checksum. Passing `less::skip_checksum` leaves out the
+// checksum, the only part that has to read the whole payload, so viewing e.g.
+// a freshly `mmap()`ed file costs nothing more than a few comparisons.
+//
+template <class T>
+struct vector_view {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "less::vector_view requires a trivially copyable type");
+
+ public:
+  using value_type      = T;
+  using size_type       = unsigned_long_type;
+  using difference_type = long_type;
+  using reference       = T const&;
+  using const_reference = T const&;
+  using pointer         = T const*;
+  using const_pointer   = T const*;
+  using iterator        = const_pointer;
+  using const_iterator  = const_pointer;
+
+ private:
+  T const*  p_    = nullptr;
+  size_type size_ = 0u;
+
+  void init(void const* bytes, size_type size, bool verify)
+  {
+    if (size < detail::serial_header_size) { throw format_error{}; }
+
+    auto const base = static_cast<unsigned char const*>(bytes);
+
+    auto h = detail::serial_header();
+    std::memcpy(&h, base, sizeof(h));
+
+    if (std::memcmp(h.magic, detail::serial_magic, sizeof(h.magic)) != 0 ||
+        h.version != detail::serial_version ||
+        h.endian != detail::serial_endian || h.value_size != sizeof(T) ||
+        h.value_align != alignof(T) ||
+        h.payload_offset < detail::serial_header_size ||
+        h.payload_offset > size ||
+        h.count > (size - h.payload_offset) / sizeof(T)) {
+      throw format_error{};
+    }
+
+    auto const payload = base + h.payload_offset;
+    if (reinterpret_cast<unsigned_long_type>(payload) % alignof(T) != 0) {
+      throw format_error{};
+    }
+
+    if (verify &&
+        detail::checksum(payload, h.count * sizeof(T)) != h.checksum) {
+      throw format_error{};
+    }
+
+    p_    = reinterpret_cast<T const*>(payload);
+    size_ = h.count;
+  }
+
+ public:
+  vector_view() noexcept
+  {
+  }
+
+  vector_view(void const* bytes, size_type size)
+  {
+    this->init(bytes, size, true);
+  }
+
+  vector_view(skip_checksum_t, void const* bytes, size_type size)
+  {
+    this->init(bytes, size, false);
+  }
+
+  // Element access
+
+  auto at(size_type const pos) const -> const_reference
+  {
+    if (pos >= size_) { throw out_of_range{}; }
+
+    return p_[pos];
+  }
+
+  auto operator[](size_type const pos) const -> const_reference
+  {
+    return p_[pos];
+  }
+
+  auto front() const -> const_reference
+  {
+    return *p_;
+  }
+
+  auto back() const -> const_reference
+  {
+    return p_[size_ - 1];
+  }
+
+  auto data() const noexcept -> T const*
+  {
+    return p_;
+  }
+
+  // Iterators
+
+  auto begin() const noexcept -> const_iterator
+  {
+    return p_;
+  }
+
+  auto cbegin() const noexcept -> const_iterator
+  {
+    return p_;
+  }
+
+  auto end() const noexcept -> const_iterator
+  {
+    return p_ + size_;
+  }
+
+  auto cend() const noexcept -> const_iterator
+  {
+    return p_ + size_;
+  }
+
+  // Capacity
+
+  bool empty() const noexcept
+  {
+    return size_ == 0u;
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return size_;
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_SERIALIZE_HPP
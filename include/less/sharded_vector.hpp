@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_SHARDED_VECTOR_HPP
+#define LESS_SHARDED_VECTOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include <less/vector.hpp>
+
+// How many `less::sharded_vector`s each thread remembers its shard of.
+//
+#ifndef LESS_SHARDED_VECTOR_CACHE_SIZE
+#define LESS_SHARDED_VECTOR_CACHE_SIZE 8u
+#endif
+
+namespace less {
+namespace detail {
+
+// the shards a thread used last, each keyed by the id of the
+// `sharded_vector` it belongs to; ids are never reused so a stale entry can't
+// match
+//
+struct shard_cache {
+  struct entry {
+    std::uint64_t owner = 0;
+    void*         shard = nullptr;
+  };
+
+  entry    entries[LESS_SHARDED_VECTOR_CACHE_SIZE];
+  unsigned next = 0;    // replaced on the next miss
+};
+
+inline auto local_shard_cache() noexcept -> shard_cache&
+{
+  thread_local auto cache = shard_cache();
+  return cache;
+}
+
+inline auto next_sharded_id() noexcept -> std::uint64_t
+{
+  static std::atomic<std::uint64_t> next{1};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+}    // namespace detail
+
+// Per-thread append buffers that are merged once at the end.
+//
+// Each thread appends to its own `less::vector` shard, reached through
+// `local()`, so appends take no lock and shards never share a cache line. A
+// thread gets its shard the first time it calls `local()`, under a mutex,
+// and finds it through a thread-local cache afterwards. That cache remembers
+// the last LESS_SHARDED_VECTOR_CACHE_SIZE `sharded_vector`s a thread used;
+// one that cycles through more than that looks its shard up under the mutex
+// again on a miss. Shards belong to a `std::thread::id`, so a new thread
+// that's handed the id of an exited one carries on with its shard.
+//
+// `collect()` sums the shard sizes, allocates the result once and moves every
+// shard into place, spread across the thread pool when
+// `<less/thread_pool.hpp>` was included first. The shards keep their capacity
+// for the next round. `collect()`, `size()` and `clear()` must not race with
+// appends.
+//
+template <class T>
+struct sharded_vector {
+ public:
+  using value_type = T;
+  using size_type  = unsigned_long_type;
+
+ private:
+  struct alignas(64) shard {
+    vector<T>       elems;
+    std::thread::id owner;
+  };
+
+  std::uint64_t  id_ = detail::next_sharded_id();
+  std::mutex     m_;
+  vector<shard*> shards_;
+
+  auto find_shard() -> shard*
+  {
+    auto const self = std::this_thread::get_id();
+
+    auto lock = std::lock_guard<std::mutex>(m_);
+    for (auto s : shards_) {
+      if (s->owner == self) { return s; }
+    }
+
+    detail::grow_capacity(shards_, shards_.size() + 1);
+
+    auto s   = new shard();
+    s->owner = self;
+    shards_.push_back(s);
+    return s;
+  }
+
+  // moves `count` elements from `src` to `dst`, both already constructed
+  //
+  static void move_elements(T* dst, T* src, size_type count)
+  {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+      if (count > 0) { std::memcpy(dst, src, count * sizeof(T)); }
+    }
+    else {
+      for (auto i = size_type{0}; i < count; ++i) {
+        dst[i] = detail::move(src[i]);
+      }
+    }
+  }
+
+ public:
+  sharded_vector()
+  {
+  }
+
+  sharded_vector(sharded_vector const&) = delete;
+  auto operator=(sharded_vector const&) -> sharded_vector& = delete;
+
+  ~sharded_vector()
+  {
+    for (auto s : shards_) {
+      delete s;
+    }
+  }
+
+  // the calling thread's shard
+  //
+  auto local() -> vector<T>&
+  {
+    auto& cache = detail::local_shard_cache();
+    for (auto const& e : cache.entries) {
+      if (e.owner == id_) { return static_cast<shard*>(e.shard)->elems; }
+    }
+
+    auto const s = this->find_shard();
+
+    auto& e    = cache.entries[cache.next];
+    e.owner    = id_;
+    e.shard    = s;
+    cache.next = (cache.next + 1) % LESS_SHARDED_VECTOR_CACHE_SIZE;
+    return s->elems;
+  }
+
+  void push_back(T const& value)
+  {
+    this->local().push_back(value);
+  }
+
+  void push_back(T&& value)
+  {
+    this->local().push_back(detail::move(value));
+  }
+
+  template <class... Args>
+  auto emplace_back(Args&&... args) -> T&
+  {
+    return this->local().emplace_back(detail::forward<Args>(args)...);
+  }
+
+  auto shard_count() const noexcept -> size_type
+  {
+    return shards_.size();
+  }
+
+  // the `i`th shard, in the order threads first used them
+  //
+  auto shard_at(size_type i) -> vector<T>&
+  {
+    return shards_[i]->elems;
+  }
+
+  // total number of elements across all shards
+  //
+  auto size() const noexcept -> size_type
+  {
+    auto total = size_type{0};
+    for (auto s : shards_) {
+      total += s->elems.size();
+    }
+    return total;
+  }
+
+  bool empty() const noexcept
+  {
+    return this->size() == 0u;
+  }
+
+  void clear() noexcept
+  {
+    for (auto s : shards_) {
+      s->elems.clear();
+    }
+  }
+
+  // Moves every element into a single vector, shard by shard in
+  // `shard_at()` order, leaving the shards empty.
+  //
+  auto collect() -> vector<T>
+  {
+    static_assert(std::is_default_constructible_v<T>,
+                  "less::sharded_vector::collect() needs to default "
+                  "initialize the result before moving into it");
+
+    auto const n = shards_.size();
+
+    auto offsets = vector<size_type>(n + 1);
+    for (auto i = size_type{0}; i < n; ++i) {
+      offsets[i + 1] = offsets[i] + shards_[i]->elems.size();
+    }
+
+    auto const total = offsets[n];
+
+    // a no-op for trivial types, otherwise parallel as well if large enough
+    //
+    auto out = vector<T>(default_init, total);
+
+    // moves the part of the concatenated shards that falls into `[b, e)`
+    //
+    auto move_range = [&](size_type b, size_type e) {
+      auto s = size_type{0};
+      while (offsets[s + 1] <= b) {
+        ++s;
+      }
+
+      while (b < e) {
+        auto const last = (offsets[s + 1] < e ? offsets[s + 1] : e);
+        auto const src  = shards_[s]->elems.data() + (b - offsets[s]);
+        move_elements(out.data() + b, src, last - b);
+        b = last;
+        ++s;
+      }
+    };
+
+#ifdef LESS_THREAD_POOL_HPP
+    constexpr size_type const grain =
+        (LESS_PARALLEL_THRESHOLD + sizeof(T) - 1) / sizeof(T);
+
+    if (total > 0) {
+      detail::parallel_chunks(total, grain, move_range,
+                              [](size_type, size_type) {});
+    }
+#else
+    if (total > 0) { move_range(0u, total); }
+#endif
+
+    this->clear();
+    return out;
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_SHARDED_VECTOR_HPP
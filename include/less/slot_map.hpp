@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_SLOT_MAP_HPP
+#define LESS_SLOT_MAP_HPP
+
+#include <cstdint>
+
+#include <less/vector.hpp>
+
+namespace less {
+
+// Stable handles into densely packed values.
+//
+// Values live contiguously in a `less::vector<T>` and are iterated like one.
+// A handle names a slot in a separate array, and the slot holds the value's
+// current position plus a generation. Erasing moves the last value into the
+// hole, repoints that value's slot and bumps the erased slot's generation.
+// Handles to erased values then stop matching, even once the slot is
+// reused. Free slots are chained through their index field, so insert, erase
+// and lookup are all O(1).
+//
+// Handles stay valid across growth and across erasing other elements; the
+// positions and addresses of values do not.
+//
+template <class T>
+struct slot_map {
+ public:
+  using value_type     = T;
+  using size_type      = unsigned_long_type;
+  using iterator       = T*;
+  using const_iterator = T const*;
+
+  struct handle {
+    std::uint32_t index      = 0xffffffffu;
+    std::uint32_t generation = 0u;
+
+    friend bool operator==(handle const& lhs, handle const& rhs) noexcept
+    {
+      return lhs.index == rhs.index && lhs.generation == rhs.generation;
+    }
+
+    friend bool operator!=(handle const& lhs, handle const& rhs) noexcept
+    {
+      return !(lhs == rhs);
+    }
+  };
+
+ private:
+  static constexpr std::uint32_t const npos = 0xffffffffu;
+
+  // `index` is the value's position while the slot is in use and the next
+  // free slot otherwise
+  //
+  struct slot {
+    std::uint32_t index;
+    std::uint32_t generation;
+  };
+
+  vector<T>             values_;
+  vector<std::uint32_t> owners_;
+  vector<slot>          slots_;
+  std::uint32_t         free_ = npos;
+
+  auto find(handle h) const noexcept -> std::uint32_t
+  {
+    if (h.index >= slots_.size()) { return npos; }
+
+    // a free slot already carries the generation its next value will get, so
+    // no handle issued so far can match it
+    //
+    auto const& s = slots_[h.index];
+    return s.generation == h.generation ? s.index : npos;
+  }
+
+ public:
+  slot_map() = default;
+
+  auto begin() noexcept -> iterator
+  {
+    return values_.begin();
+  }
+
+  auto end() noexcept -> iterator
+  {
+    return values_.end();
+  }
+
+  auto begin() const noexcept -> const_iterator
+  {
+    return values_.begin();
+  }
+
+  auto end() const noexcept -> const_iterator
+  {
+    return values_.end();
+  }
+
+  auto data() noexcept -> T*
+  {
+    return values_.data();
+  }
+
+  auto data() const noexcept -> T const*
+  {
+    return values_.data();
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return values_.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return values_.empty();
+  }
+
+  void reserve(size_type capacity)
+  {
+    values_.reserve(capacity);
+    owners_.reserve(capacity);
+    slots_.reserve(capacity);
+  }
+
+  template <class... Args>
+  auto emplace(Args&&... args) -> handle
+  {
+    if (free_ == npos) {
+      if (slots_.size() == npos) { throw out_of_range{}; }
+      slots_.push_back(slot{npos, 0u});
+      free_ = static_cast<std::uint32_t>(slots_.size() - 1);
+    }
+
+    auto const s = free_;
+    values_.emplace_back(detail::forward<Args>(args)...);
+    try {
+      owners_.push_back(s);
+    }
+    catch (...) {
+      values_.pop_back();
+      throw;
+    }
+
+    free_           = slots_[s].index;
+    slots_[s].index = static_cast<std::uint32_t>(values_.size() - 1);
+    return handle{s, slots_[s].generation};
+  }
+
+  auto insert(T const& value) -> handle
+  {
+    return this->emplace(value);
+  }
+
+  auto insert(T&& value) -> handle
+  {
+    return this->emplace(detail::move(value));
+  }
+
+  // Moves the last value into the erased one's place. Returns false for a
+  // stale or foreign handle.
+  //
+  bool erase(handle h)
+  {
+    auto const i = this->find(h);
+    if (i == npos) { return false; }
+
+    auto const last = static_cast<std::uint32_t>(values_.size() - 1);
+    if (i != last) {
+      values_[i]               = detail::move(values_[last]);
+      owners_[i]               = owners_[last];
+      slots_[owners_[i]].index = i;
+    }
+    values_.pop_back();
+    owners_.pop_back();
+
+    auto& s = slots_[h.index];
+    ++s.generation;
+    s.index = free_;
+    free_   = h.index;
+    return true;
+  }
+
+  void clear() noexcept
+  {
+    for (auto const owner : owners_) {
+      auto& s = slots_[owner];
+      ++s.generation;
+      s.index = free_;
+      free_   = owner;
+    }
+    values_.clear();
+    owners_.clear();
+  }
+
+  bool contains(handle h) const noexcept
+  {
+    return this->find(h) != npos;
+  }
+
+  // nullptr for a stale handle
+  //
+  auto get(handle h) noexcept -> T*
+  {
+    auto const i = this->find(h);
+    return i == npos ? nullptr : values_.data() + i;
+  }
+
+  auto get(handle h) const noexcept -> T const*
+  {
+    auto const i = this->find(h);
+    return i == npos ? nullptr : values_.data() + i;
+  }
+
+  auto at(handle h) -> T&
+  {
+    auto const p = this->get(h);
+    if (!p) { throw out_of_range{}; }
+    return *p;
+  }
+
+  auto at(handle h) const -> T const&
+  {
+    auto const p = this->get(h);
+    if (!p) { throw out_of_range{}; }
+    return *p;
+  }
+
+  // `h` has to be live.
+  //
+  auto operator[](handle h) noexcept -> T&
+  {
+    return values_[slots_[h.index].index];
+  }
+
+  auto operator[](handle h) const noexcept -> T const&
+  {
+    return values_[slots_[h.index].index];
+  }
+
+  // The handle of the value at position `i`, e.g. while iterating.
+  //
+  auto handle_at(size_type i) const noexcept -> handle
+  {
+    auto const s = owners_[i];
+    return handle{s, slots_[s].generation};
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_SLOT_MAP_HPP
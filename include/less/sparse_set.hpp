@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_SPARSE_SET_HPP
+#define LESS_SPARSE_SET_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#include <less/vector.hpp>
+
+#ifndef LESS_SPARSE_SET_PAGE_SIZE
+#define LESS_SPARSE_SET_PAGE_SIZE 4096u
+#endif
+
+namespace less {
+
+// A set of integer ids with O(1) insert, erase, contains and clear.
+//
+// Members are packed in a dense `less::vector<Id>` that iterates like any
+// other array. A sparse array maps each id to its position in the dense one.
+// That array is split into pages of LESS_SPARSE_SET_PAGE_SIZE entries,
+// allocated the first time an id in their range is inserted, so a few large
+// ids don't cost memory for every id below them.
+//
+// An id is a member only if its sparse entry points inside the dense array
+// and the dense entry points back at it. Stale sparse entries therefore don't
+// matter, and `clear()` only has to reset the dense size.
+//
+template <class Id = std::uint32_t>
+struct sparse_set {
+ public:
+  static_assert(std::is_unsigned_v<Id>, "less::sparse_set ids are unsigned");
+
+  using value_type     = Id;
+  using size_type      = unsigned_long_type;
+  using iterator       = Id const*;
+  using const_iterator = Id const*;
+
+ private:
+  static constexpr size_type const page_size = LESS_SPARSE_SET_PAGE_SIZE;
+
+  static_assert((page_size & (page_size - 1)) == 0,
+                "LESS_SPARSE_SET_PAGE_SIZE has to be a power of two");
+
+  vector<Id>         dense_;
+  vector<vector<Id>> pages_;
+
+  // position of `id` in `dense_`, or nullptr if its page doesn't exist yet
+  //
+  auto lookup(Id id) const noexcept -> Id const*
+  {
+    auto const page = static_cast<size_type>(id) / page_size;
+    if (page >= pages_.size() || pages_[page].empty()) { return nullptr; }
+    return pages_[page].data() + (id & (page_size - 1));
+  }
+
+  // the sparse entry of `id`, allocating its page on first use
+  //
+  auto slot(Id id) -> Id&
+  {
+    auto const page = static_cast<size_type>(id) / page_size;
+    if (page >= pages_.size()) {
+      detail::grow_capacity(pages_, page + 1);
+      pages_.resize(page + 1);
+    }
+    if (pages_[page].empty()) { pages_[page] = vector<Id>(page_size); }
+    return pages_[page][id & (page_size - 1)];
+  }
+
+ public:
+  sparse_set() = default;
+
+  auto begin() const noexcept -> const_iterator
+  {
+    return dense_.begin();
+  }
+
+  auto end() const noexcept -> const_iterator
+  {
+    return dense_.end();
+  }
+
+  // The members, in no particular order.
+  //
+  auto data() const noexcept -> Id const*
+  {
+    return dense_.data();
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return dense_.size();
+  }
+
+  bool empty() const noexcept
+  {
+    return dense_.empty();
+  }
+
+  // Room for `capacity` members without reallocating the dense array.
+  //
+  void reserve(size_type capacity)
+  {
+    dense_.reserve(capacity);
+  }
+
+  bool contains(Id id) const noexcept
+  {
+    auto const p = this->lookup(id);
+    return p && *p < dense_.size() && dense_[*p] == id;
+  }
+
+  // Returns false if `id` was already a member.
+  //
+  bool insert(Id id)
+  {
+    if (this->contains(id)) { return false; }
+
+    auto& s = this->slot(id);
+    dense_.push_back(id);
+    s = static_cast<Id>(dense_.size() - 1);
+    return true;
+  }
+
+  // Moves the last member into the erased one's place. Returns false if `id`
+  // wasn't a member.
+  //
+  bool erase(Id id) noexcept
+  {
+    if (!this->contains(id)) { return false; }
+
+    auto const pos  = *this->lookup(id);
+    auto const last = dense_.back();
+
+    dense_[pos] = last;
+    pages_[last / page_size][last & (page_size - 1)] = pos;
+    dense_.pop_back();
+    return true;
+  }
+
+  // O(1): pages keep their stale entries, which no longer point inside the
+  // dense array.
+  //
+  void clear() noexcept
+  {
+    dense_.clear();
+  }
+
+  // Frees the pages as well.
+  //
+  void reset() noexcept
+  {
+    dense_.clear();
+    pages_.clear();
+  }
+};
+
+}    // namespace less
+
+#endif    // LESS_SPARSE_SET_HPP
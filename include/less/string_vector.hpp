@@ -0,0 +1,481 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_STRING_VECTOR_HPP
+#define LESS_STRING_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <string_view>
+
+#include <less/vector.hpp>
+
+namespace less {
+
+struct string_vector;
+
+namespace detail {
+
+struct string_vector_iterator {
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type        = std::string_view;
+  using difference_type   = std::ptrdiff_t;
+  using reference         = std::string_view;
+  using pointer           = void;
+
+ private:
+  string_vector const* v_ = nullptr;
+  unsigned_long_type   i_ = 0;
+
+ public:
+  string_vector_iterator() = default;
+
+  string_vector_iterator(string_vector const* v, unsigned_long_type i) noexcept
+      : v_(v)
+      , i_(i)
+  {
+  }
+
+  inline auto operator*() const noexcept -> std::string_view;
+
+  auto operator[](difference_type n) const noexcept -> std::string_view
+  {
+    return *(*this + n);
+  }
+
+  auto operator++() noexcept -> string_vector_iterator&
+  {
+    ++i_;
+    return *this;
+  }
+
+  auto operator++(int) noexcept -> string_vector_iterator
+  {
+    auto it = *this;
+    ++i_;
+    return it;
+  }
+
+  auto operator--() noexcept -> string_vector_iterator&
+  {
+    --i_;
+    return *this;
+  }
+
+  auto operator--(int) noexcept -> string_vector_iterator
+  {
+    auto it = *this;
+    --i_;
+    return it;
+  }
+
+  auto operator+=(difference_type n) noexcept -> string_vector_iterator&
+  {
+    i_ = static_cast<unsigned_long_type>(static_cast<difference_type>(i_) + n);
+    return *this;
+  }
+
+  auto operator-=(difference_type n) noexcept -> string_vector_iterator&
+  {
+    return *this += -n;
+  }
+
+  friend auto operator+(string_vector_iterator it, difference_type n) noexcept
+      -> string_vector_iterator
+  {
+    return it += n;
+  }
+
+  friend auto operator+(difference_type n, string_vector_iterator it) noexcept
+      -> string_vector_iterator
+  {
+    return it += n;
+  }
+
+  friend auto operator-(string_vector_iterator it, difference_type n) noexcept
+      -> string_vector_iterator
+  {
+    return it -= n;
+  }
+
+  friend auto operator-(string_vector_iterator const& lhs,
+                        string_vector_iterator const& rhs) noexcept
+      -> difference_type
+  {
+    return static_cast<difference_type>(lhs.i_) -
+           static_cast<difference_type>(rhs.i_);
+  }
+
+  friend bool operator==(string_vector_iterator const& lhs,
+                         string_vector_iterator const& rhs) noexcept
+  {
+    return lhs.i_ == rhs.i_;
+  }
+
+  friend bool operator!=(string_vector_iterator const& lhs,
+                         string_vector_iterator const& rhs) noexcept
+  {
+    return lhs.i_ != rhs.i_;
+  }
+
+  friend bool operator<(string_vector_iterator const& lhs,
+                        string_vector_iterator const& rhs) noexcept
+  {
+    return lhs.i_ < rhs.i_;
+  }
+
+  friend bool operator>(string_vector_iterator const& lhs,
+                        string_vector_iterator const& rhs) noexcept
+  {
+    return rhs.i_ < lhs.i_;
+  }
+
+  friend bool operator<=(string_vector_iterator const& lhs,
+                         string_vector_iterator const& rhs) noexcept
+  {
+    return !(rhs.i_ < lhs.i_);
+  }
+
+  friend bool operator>=(string_vector_iterator const& lhs,
+                         string_vector_iterator const& rhs) noexcept
+  {
+    return !(lhs.i_ < rhs.i_);
+  }
+};
+
+}    // namespace detail
+
+// Many strings in one allocation: every character lives in a single
+// `less::vector<char>` and string `i` is `[offsets[i], offsets[i + 1])` of it,
+// read back as a `std::string_view`. Appending a string copies its bytes to
+// the end of the arena; there are no per-string allocations.
+//
+// `intern()` returns the index of an equal string if there is one, and only
+// appends otherwise. It's backed by an open-addressing table of indices that
+// is built on first use and kept up to date by `push_back()`; `sort()`,
+// `unique()` and `pop_back()` drop it until it's needed again.
+//
+// Views are invalidated whenever the arena grows or gets rearranged.
+//
+struct string_vector {
+ public:
+  using value_type     = std::string_view;
+  using size_type      = unsigned_long_type;
+  using iterator       = detail::string_vector_iterator;
+  using const_iterator = detail::string_vector_iterator;
+
+  static constexpr size_type const npos = size_type(-1);
+
+ private:
+  vector<char>      chars_;
+  vector<size_type> offsets_;
+
+  // index + 1 of the string hashed there, 0 for empty; at most half full
+  //
+  vector<size_type> index_;
+
+  static auto hash(std::string_view s) noexcept -> size_type
+  {
+    return static_cast<size_type>(std::hash<std::string_view>()(s));
+  }
+
+  auto view(size_type i) const noexcept -> std::string_view
+  {
+    return {chars_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]};
+  }
+
+  // slot holding `s`, or the empty slot where it would go
+  //
+  auto probe(std::string_view s) const noexcept -> size_type
+  {
+    auto const mask = index_.size() - 1;
+    for (auto slot = hash(s) & mask;; slot = (slot + 1) & mask) {
+      auto const entry = index_[slot];
+      if (entry == 0 || this->view(entry - 1) == s) { return slot; }
+    }
+  }
+
+  void index_insert(size_type i)
+  {
+    if (2 * (this->size()) > index_.size()) {
+      this->rebuild_index(4 * this->size());
+      return;
+    }
+
+    auto const slot = this->probe(this->view(i));
+    if (index_[slot] == 0) { index_[slot] = i + 1; }
+  }
+
+  // Sized for `n` strings at half load; earlier duplicates win.
+  //
+  void rebuild_index(size_type n)
+  {
+    auto capacity = size_type{16};
+    while (capacity < 2 * n) {
+      capacity *= 2;
+    }
+
+    index_ = vector<size_type>(capacity, size_type{0});
+    for (auto i = size_type{0}; i < this->size(); ++i) {
+      auto const slot = this->probe(this->view(i));
+      if (index_[slot] == 0) { index_[slot] = i + 1; }
+    }
+  }
+
+  // Room for `n` more characters. The arena at least doubles when it has to
+  // grow, so appends are amortized O(1) per character.
+  //
+  void grow_chars(size_type n)
+  {
+    auto const needed = chars_.size() + n;
+    if (needed <= chars_.capacity()) { return; }
+
+    auto const doubled = 2 * chars_.capacity();
+    chars_.reserve(doubled > needed ? doubled : needed);
+  }
+
+  // Lays the strings out again in `order`.
+  //
+  void gather(vector<size_type> const& order)
+  {
+    auto chars   = vector<char>(with_capacity, chars_.size());
+    auto offsets = vector<size_type>(with_capacity, order.size() + 1);
+    offsets.push_back(0);
+    for (auto i : order) {
+      auto const s = this->view(i);
+      chars.insert(chars.end(), s.data(), s.data() + s.size());
+      offsets.push_back(chars.size());
+    }
+    chars_.swap(chars);
+    offsets_.swap(offsets);
+    index_.clear();
+  }
+
+ public:
+  string_vector()
+      : offsets_(1u, size_type{0})
+  {
+  }
+
+  string_vector(std::initializer_list<std::string_view> ilist)
+      : string_vector()
+  {
+    for (auto s : ilist) {
+      this->push_back(s);
+    }
+  }
+
+  auto begin() const noexcept -> const_iterator
+  {
+    return {this, 0};
+  }
+
+  auto end() const noexcept -> const_iterator
+  {
+    return {this, this->size()};
+  }
+
+  auto size() const noexcept -> size_type
+  {
+    return offsets_.size() - 1;
+  }
+
+  bool empty() const noexcept
+  {
+    return this->size() == 0;
+  }
+
+  // Total length of all strings.
+  //
+  auto char_count() const noexcept -> size_type
+  {
+    return chars_.size();
+  }
+
+  // The arena and the offsets into it.
+  //
+  auto chars() const noexcept -> vector<char> const&
+  {
+    return chars_;
+  }
+
+  auto offsets() const noexcept -> vector<size_type> const&
+  {
+    return offsets_;
+  }
+
+  void reserve(size_type strings, size_type chars)
+  {
+    offsets_.reserve(strings + 1);
+    chars_.reserve(chars);
+  }
+
+  void clear() noexcept
+  {
+    chars_.clear();
+    offsets_.erase(offsets_.begin() + 1, offsets_.end());
+    index_.clear();
+  }
+
+  auto operator[](size_type i) const noexcept -> std::string_view
+  {
+    return this->view(i);
+  }
+
+  auto at(size_type i) const -> std::string_view
+  {
+    if (i >= this->size()) { throw out_of_range{}; }
+    return this->view(i);
+  }
+
+  auto front() const noexcept -> std::string_view
+  {
+    return this->view(0);
+  }
+
+  auto back() const noexcept -> std::string_view
+  {
+    return this->view(this->size() - 1);
+  }
+
+  void push_back(std::string_view s)
+  {
+    // `s` may point into the arena, which can move while it grows
+    //
+    auto const first   = chars_.data();
+    auto const aliased = s.data() >= first &&
+                         s.data() < chars_.data() + chars_.size();
+    auto const pos =
+        aliased ? static_cast<size_type>(s.data() - first) : size_type{0};
+
+    this->grow_chars(s.size());
+    if (aliased) { s = std::string_view(chars_.data() + pos, s.size()); }
+
+    auto const size = chars_.size();
+    chars_.insert(chars_.end(), s.data(), s.data() + s.size());
+    try {
+      offsets_.push_back(chars_.size());
+    }
+    catch (...) {
+      chars_.erase(chars_.begin() + size, chars_.end());
+      throw;
+    }
+
+    if (!index_.empty()) { this->index_insert(this->size() - 1); }
+  }
+
+  void pop_back()
+  {
+    offsets_.pop_back();
+    chars_.erase(chars_.begin() + offsets_.back(), chars_.end());
+    index_.clear();
+  }
+
+  // Index of the first string equal to `s`, or npos.
+  //
+  auto find(std::string_view s) -> size_type
+  {
+    if (index_.empty()) { this->rebuild_index(this->size()); }
+
+    auto const entry = index_[this->probe(s)];
+    return entry == 0 ? npos : entry - 1;
+  }
+
+  // Index of the first string equal to `s`, appending it if there's none.
+  //
+  auto intern(std::string_view s) -> size_type
+  {
+    auto const i = this->find(s);
+    if (i != npos) { return i; }
+
+    this->push_back(s);
+    return this->size() - 1;
+  }
+
+  // Sorts the strings by sorting their indices, then copies the arena once
+  // in the new order.
+  //
+  template <class Compare>
+  void sort(Compare comp)
+  {
+    auto order = vector<size_type>(default_init, this->size());
+    for (auto i = size_type{0}; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_type a, size_type b) {
+                       return comp(this->view(a), this->view(b));
+                     });
+    this->gather(order);
+  }
+
+  void sort()
+  {
+    this->sort(std::less<std::string_view>());
+  }
+
+  // Drops strings equal to the one before them, compacting the arena in
+  // place. Returns how many were removed.
+  //
+  auto unique() -> size_type
+  {
+    auto const n = this->size();
+    if (n < 2) { return 0; }
+
+    auto w    = size_type{1};
+    auto tail = offsets_[1];
+    for (auto r = size_type{1}; r < n; ++r) {
+      auto const s    = this->view(r);
+      auto const prev = std::string_view(chars_.data() + offsets_[w - 1],
+                                         tail - offsets_[w - 1]);
+      if (s == prev) { continue; }
+
+      if (tail != offsets_[r]) {
+        std::memmove(chars_.data() + tail, s.data(), s.size());
+      }
+      offsets_[w] = tail;
+      tail += s.size();
+      ++w;
+    }
+
+    offsets_[w] = tail;
+    offsets_.erase(offsets_.begin() + w + 1, offsets_.end());
+    chars_.erase(chars_.begin() + tail, chars_.end());
+    index_.clear();
+    return n - w;
+  }
+
+  friend bool operator==(string_vector const& lhs, string_vector const& rhs)
+  {
+    return lhs.offsets_ == rhs.offsets_ && lhs.chars_ == rhs.chars_;
+  }
+
+  friend bool operator!=(string_vector const& lhs, string_vector const& rhs)
+  {
+    return !(lhs == rhs);
+  }
+};
+
+namespace detail {
+
+inline auto string_vector_iterator::operator*() const noexcept
+    -> std::string_view
+{
+  return (*v_)[i_];
+}
+
+}    // namespace detail
+
+}    // namespace less
+
+#endif    // LESS_STRING_VECTOR_HPP
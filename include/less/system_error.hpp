@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_SYSTEM_ERROR_HPP
+#define LESS_SYSTEM_ERROR_HPP
+
+#include <cerrno>
+
+namespace less {
+
+// thrown by the parts of the library that sit on top of system calls, `code`
+// is the `errno` value the failing call left behind
+//
+struct system_error {
+  int code = 0;
+};
+
+// thrown when a file or buffer doesn't hold the data layout the library
+// expects, e.g. a file written for a different element type
+//
+struct format_error {};
+
+namespace detail {
+
+[[noreturn]] inline void throw_errno()
+{
+  throw system_error{errno};
+}
+
+}    // namespace detail
+}    // namespace less
+
+#endif    // LESS_SYSTEM_ERROR_HPP
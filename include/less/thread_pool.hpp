@@ -0,0 +1,538 @@
+/*
+ * Copyright (c) 2022 Christian Mazakas
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE_1_0.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef LESS_THREAD_POOL_HPP
+#define LESS_THREAD_POOL_HPP
+
+// Minimum number of bytes a single chunk of parallel construction has to cover
+// before `less::vector` hands work off to the thread pool. Ranges smaller than
+// two chunks are always constructed on the calling thread.
+//
+#ifndef LESS_PARALLEL_THRESHOLD
+#define LESS_PARALLEL_THRESHOLD (1u << 20)
+#endif
+
+// Number of workers in `less::default_thread_pool()`. Zero starts one fewer
+// than the number of hardware threads, since callers join in on the work.
+//
+#ifndef LESS_THREAD_POOL_SIZE
+#define LESS_THREAD_POOL_SIZE 0
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <initializer_list>
+#include <iterator>
+
+// `less::vector` checks for `LESS_THREAD_POOL_HPP` and forward-declares
+// `detail::parallel_chunks()` so it must come after the guard above
+//
+#include <less/vector.hpp>
+
+namespace less {
+namespace detail {
+
+struct pool_task {
+  virtual ~pool_task() = default;
+  virtual void run() noexcept = 0;
+};
+
+template <class F>
+struct pool_task_impl final : pool_task {
+  F f_;
+
+  explicit pool_task_impl(F f)
+      : f_(detail::move(f))
+  {
+  }
+
+  void run() noexcept override
+  {
+    f_();
+  }
+};
+
+// A Chase-Lev work-stealing deque. The owning worker pushes and pops at the
+// bottom while other workers steal from the top. The ring grows by doubling;
+// outgrown rings stay alive until the deque is destroyed since a thief may
+// still be reading from one.
+//
+struct work_deque {
+ private:
+  // copyable only so it can live in a `less::vector`; rings are never copied
+  //
+  struct slot {
+    std::atomic<pool_task*> task_{nullptr};
+
+    slot() noexcept
+    {
+    }
+
+    slot(slot const& rhs) noexcept
+        : task_(rhs.task_.load(std::memory_order_relaxed))
+    {
+    }
+  };
+
+  struct ring {
+    less::vector<slot> slots_;
+    long_type          mask_;
+
+    // filled one by one since the sized constructor could itself end up
+    // running on the pool
+    //
+    explicit ring(unsigned_long_type capacity)
+        : slots_(less::with_capacity, capacity)
+        , mask_(static_cast<long_type>(capacity) - 1)
+    {
+      for (auto i = 0u; i < capacity; ++i) {
+        slots_.emplace_back();
+      }
+    }
+
+    auto get(long_type i) const noexcept -> pool_task*
+    {
+      return slots_[static_cast<unsigned_long_type>(i & mask_)].task_.load(
+          std::memory_order_relaxed);
+    }
+
+    void put(long_type i, pool_task* t) noexcept
+    {
+      slots_[static_cast<unsigned_long_type>(i & mask_)].task_.store(
+          t, std::memory_order_relaxed);
+    }
+  };
+
+  alignas(64) std::atomic<long_type> top_{0};
+  alignas(64) std::atomic<long_type> bottom_{0};
+  std::atomic<ring*>  ring_;
+  less::vector<ring*> rings_;
+
+ public:
+  work_deque()
+      : ring_(new ring(256u))
+  {
+    try {
+      rings_.push_back(ring_.load());
+    }
+    catch (...) {
+      delete ring_.load();
+      throw;
+    }
+  }
+
+  work_deque(work_deque const&) = delete;
+  auto operator=(work_deque const&) -> work_deque& = delete;
+
+  ~work_deque()
+  {
+    for (auto r : rings_) {
+      delete r;
+    }
+  }
+
+  // owner only
+  //
+  void push(pool_task* t)
+  {
+    auto const b = bottom_.load(std::memory_order_relaxed);
+    auto const f = top_.load(std::memory_order_acquire);
+    auto       r = ring_.load(std::memory_order_relaxed);
+
+    if (b - f > r->mask_) {
+      rings_.reserve(rings_.size() + 1);
+
+      auto const bigger =
+          new ring(2 * static_cast<unsigned_long_type>(r->mask_ + 1));
+      for (auto i = f; i < b; ++i) {
+        bigger->put(i, r->get(i));
+      }
+      rings_.push_back(bigger);
+      ring_.store(bigger, std::memory_order_release);
+      r = bigger;
+    }
+
+    r->put(b, t);
+    bottom_.store(b + 1, std::memory_order_release);
+  }
+
+  // owner only
+  //
+  auto pop() noexcept -> pool_task*
+  {
+    auto const b = bottom_.load(std::memory_order_relaxed) - 1;
+    auto const r = ring_.load(std::memory_order_relaxed);
+    bottom_.store(b);
+
+    auto f = top_.load();
+    if (f > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    auto t = r->get(b);
+    if (f == b) {
+      // the last element, a thief may be after it as well
+      //
+      if (!top_.compare_exchange_strong(f, f + 1)) { t = nullptr; }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return t;
+  }
+
+  auto steal() noexcept -> pool_task*
+  {
+    auto f = top_.load();
+    auto b = bottom_.load();
+    if (f >= b) { return nullptr; }
+
+    auto const t = ring_.load(std::memory_order_acquire)->get(f);
+    if (!top_.compare_exchange_strong(f, f + 1)) { return nullptr; }
+    return t;
+  }
+};
+
+}    // namespace detail
+
+// A work-stealing thread pool.
+//
+// Every worker owns a `detail::work_deque`. Tasks posted from a worker go to
+// the bottom of its own deque, so nested parallel work stays on the thread
+// that created it while idle workers steal from the top of the others. Tasks
+// posted from outside the pool go to a shared queue. Workers that find nothing
+// to do spin briefly and then sleep until new work is posted.
+//
+struct thread_pool {
+ private:
+  struct alignas(64) worker {
+    detail::work_deque deque;
+  };
+
+  less::vector<worker*>     workers_;
+  less::vector<std::thread> threads_;
+
+  std::mutex                     m_;
+  std::condition_variable        cv_;
+  std::deque<detail::pool_task*> injected_;
+  bool                           stop_ = false;
+
+  // counts tasks from before they're queued until they're taken, so a worker
+  // never sleeps while there's something to take
+  //
+  alignas(64) std::atomic<unsigned_long_type> queued_{0};
+  std::atomic<unsigned> sleepers_{0};
+
+  struct current_worker {
+    thread_pool*       pool  = nullptr;
+    unsigned_long_type index = 0;
+  };
+
+  static auto current() noexcept -> current_worker&
+  {
+    thread_local auto w = current_worker();
+    return w;
+  }
+
+  void wake_one()
+  {
+    if (sleepers_.load() == 0) { return; }
+
+    auto lock = std::lock_guard<std::mutex>(m_);
+    cv_.notify_one();
+  }
+
+  auto try_take(unsigned_long_type self, unsigned& seed) -> detail::pool_task*
+  {
+    if (auto t = workers_[self]->deque.pop()) { return t; }
+
+    auto const n = workers_.size();
+    if (n > 1) {
+      // xorshift picks where to start so thieves spread out
+      //
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+
+      auto const start = seed % n;
+      for (auto i = 0u; i < n; ++i) {
+        auto const victim = (start + i) % n;
+        if (victim == self) { continue; }
+        if (auto t = workers_[victim]->deque.steal()) { return t; }
+      }
+    }
+
+    auto lock = std::lock_guard<std::mutex>(m_);
+    if (injected_.empty()) { return nullptr; }
+
+    auto t = injected_.front();
+    injected_.pop_front();
+    return t;
+  }
+
+  void run(unsigned_long_type self)
+  {
+    current() = current_worker{this, self};
+
+    auto seed = static_cast<unsigned>(self) * 2654435761u + 1u;
+    auto idle = 0u;
+    while (true) {
+      if (auto t = this->try_take(self, seed)) {
+        queued_.fetch_sub(1);
+        t->run();
+        delete t;
+        idle = 0;
+        continue;
+      }
+
+      // a task that was counted may be about to be pushed, or a busy worker
+      // may spawn more work soon
+      //
+      if (++idle < 64) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      auto lock = std::unique_lock<std::mutex>(m_);
+      ++sleepers_;
+      cv_.wait(lock, [&] { return stop_ || queued_.load() > 0; });
+      --sleepers_;
+      if (stop_ && queued_.load() == 0) { return; }
+      idle = 0;
+    }
+  }
+
+ public:
+  explicit thread_pool(unsigned num_threads)
+      : workers_(less::with_capacity, num_threads)
+      , threads_(less::with_capacity, num_threads)
+  {
+    try {
+      for (auto i = 0u; i < num_threads; ++i) {
+        workers_.push_back(new worker());
+      }
+      for (auto i = 0u; i < num_threads; ++i) {
+        threads_.emplace_back([this, i] { this->run(i); });
+      }
+    }
+    catch (...) {
+      this->stop();
+      throw;
+    }
+  }
+
+  thread_pool(thread_pool const&) = delete;
+  auto operator=(thread_pool const&) -> thread_pool& = delete;
+
+  ~thread_pool()
+  {
+    this->stop();
+  }
+
+  // Runs `f()` on one of the worker threads. Tasks that are still queued when
+  // the pool is destroyed are run before the workers exit. A task that throws
+  // terminates the program, same as an exception escaping a `std::thread`.
+  //
+  template <class F>
+  void post(F f)
+  {
+    auto t = new detail::pool_task_impl<F>(detail::move(f));
+
+    queued_.fetch_add(1);
+
+    auto& w = current();
+    try {
+      if (w.pool == this) {
+        workers_[w.index]->deque.push(t);
+      }
+      else {
+        auto lock = std::lock_guard<std::mutex>(m_);
+        injected_.push_back(t);
+      }
+    }
+    catch (...) {
+      queued_.fetch_sub(1);
+      delete t;
+      throw;
+    }
+
+    this->wake_one();
+  }
+
+  auto size() const noexcept -> unsigned_long_type
+  {
+    return threads_.size();
+  }
+
+ private:
+  void stop() noexcept
+  {
+    {
+      auto lock = std::lock_guard<std::mutex>(m_);
+      stop_     = true;
+    }
+    cv_.notify_all();
+
+    for (auto& t : threads_) {
+      if (t.joinable()) { t.join(); }
+    }
+    for (auto w : workers_) {
+      delete w;
+    }
+  }
+};
+
+// The pool used by `less::vector` and the parallel algorithms. The calling
+// thread always takes part in the work so by default one worker fewer than the
+// number of hardware threads is started; `LESS_THREAD_POOL_SIZE` overrides it.
+//
+inline auto default_thread_pool() -> thread_pool&
+{
+  static auto pool = thread_pool([] {
+    if (LESS_THREAD_POOL_SIZE > 0) { return LESS_THREAD_POOL_SIZE + 0u; }
+
+    auto const n = std::thread::hardware_concurrency();
+    return n > 1 ? n - 1 : 1u;
+  }());
+
+  return pool;
+}
+
+namespace detail {
+
+struct parallel_state {
+  std::atomic<unsigned_long_type> next_{0};
+  std::atomic<unsigned_long_type> pending_;
+
+  std::mutex              m_;
+  std::condition_variable cv_;
+  std::exception_ptr      error_;
+
+  less::vector<unsigned char> failed_;
+
+  void (*run_)(void*, unsigned_long_type) = nullptr;
+  void* ctx_                               = nullptr;
+
+  explicit parallel_state(unsigned_long_type num_chunks)
+      : pending_(num_chunks)
+      , failed_(num_chunks)
+  {
+  }
+
+  // Claims chunks until none are left. The body behind `ctx_` lives on the
+  // stack of the thread that called `parallel_chunks()`, which is only
+  // guaranteed to be alive while some chunk is still pending. Helpers that get
+  // scheduled after the last chunk was claimed therefore never touch it.
+  //
+  void work() noexcept
+  {
+    auto const num_chunks = failed_.size();
+    while (true) {
+      auto const chunk = next_.fetch_add(1, std::memory_order_relaxed);
+      if (chunk >= num_chunks) { return; }
+
+      try {
+        run_(ctx_, chunk);
+      }
+      catch (...) {
+        auto lock      = std::lock_guard<std::mutex>(m_);
+        failed_[chunk] = 1;
+        if (!error_) { error_ = std::current_exception(); }
+      }
+
+      if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        auto lock = std::lock_guard<std::mutex>(m_);
+        cv_.notify_all();
+      }
+    }
+  }
+
+  void wait()
+  {
+    auto lock = std::unique_lock<std::mutex>(m_);
+    cv_.wait(lock, [&] { return pending_.load(std::memory_order_acquire) == 0; });
+  }
+};
+
+// Splits `[0, n)` into contiguous chunks of at least `grain` elements and calls
+// `f(first, last)` for each of them across the default thread pool and the
+// calling thread.
+//
+// `f` must leave its chunk untouched if it throws. Once every chunk has
+// finished, `undo(first, last)` is called for each chunk that succeeded and the
+// first exception is rethrown, so the range as a whole either completes or has
+// no effect.
+//
+template <class F, class Undo>
+void parallel_chunks(unsigned_long_type n, unsigned_long_type grain, F f,
+                     Undo undo)
+{
+  auto& pool = default_thread_pool();
+
+  // a few chunks per thread so threads that finish early pick up more
+  //
+  auto const max_chunks = 4 * (pool.size() + 1);
+  auto const num_chunks =
+      (n / grain < max_chunks ? (n / grain == 0 ? 1 : n / grain) : max_chunks);
+
+  auto const chunk_begin = [&](unsigned_long_type chunk) {
+    auto const q = n / num_chunks;
+    auto const r = n % num_chunks;
+    return q * chunk + (chunk < r ? chunk : r);
+  };
+
+  if (num_chunks == 1) {
+    f(0u, n);
+    return;
+  }
+
+  auto body = [&](unsigned_long_type chunk) {
+    f(chunk_begin(chunk), chunk_begin(chunk + 1));
+  };
+
+  auto state  = std::make_shared<parallel_state>(num_chunks);
+  state->ctx_ = &body;
+  state->run_ = [](void* ctx, unsigned_long_type chunk) {
+    (*static_cast<decltype(body)*>(ctx))(chunk);
+  };
+
+  // if we can't enqueue a helper the chunks it would've taken are simply run
+  // on this thread instead
+  //
+  try {
+    auto const helpers = (num_chunks - 1 < pool.size() ? num_chunks - 1
+                                                       : pool.size());
+    for (auto i = 0u; i < helpers; ++i) {
+      pool.post([state] { state->work(); });
+    }
+  }
+  catch (...) {
+  }
+
+  state->work();
+  state->wait();
+
+  if (!state->error_) { return; }
+
+  for (auto chunk = 0u; chunk < num_chunks; ++chunk) {
+    if (state->failed_[chunk]) { continue; }
+    undo(chunk_begin(chunk), chunk_begin(chunk + 1));
+  }
+
+  std::rethrow_exception(state->error_);
+}
+
+}    // namespace detail
+}    // namespace less
+
+#endif    // LESS_THREAD_POOL_HPP
@@ -19,6 +19,10 @@
 #define LESS_HAS_ITERATOR
 #endif
 
+#if defined(LESS_THREAD_POOL_HPP)
+#define LESS_HAS_THREAD_POOL
+#endif
+
 namespace less {
 
 namespace detail {
@@ -33,6 +37,14 @@ namespace detail {
 
 struct placement_tag_t {};
 
+#ifdef LESS_HAS_THREAD_POOL
+// defined in <less/thread_pool.hpp>
+//
+template <class F, class Undo>
+void parallel_chunks(unsigned_long_type n, unsigned_long_type grain, F f,
+                     Undo undo);
+#endif
+
 }    // namespace detail
 }    // namespace less
 
@@ -259,6 +271,11 @@ inline constexpr with_capacity_t with_capacity;
 
 struct out_of_range {};
 
+// defined in <less/frozen_vector.hpp>
+//
+template <class T>
+struct frozen_vector;
+
 template <class T>
 struct vector {
  public:
@@ -277,6 +294,9 @@ struct vector {
 
   static constexpr detail::placement_tag_t placement_tag = {};
 
+  template <class>
+  friend struct frozen_vector;
+
   pointer   p_        = nullptr;
   size_type size_     = 0u;
   size_type capacity_ = 0u;
@@ -322,29 +342,110 @@ struct vector {
     }
   };
 
+#ifdef LESS_HAS_THREAD_POOL
+  static constexpr size_type const parallel_grain =
+      (LESS_PARALLEL_THRESHOLD + sizeof(value_type) - 1) / sizeof(value_type);
+#endif
+
+  // whether constructing or filling `count` elements is worth splitting across
+  // the thread pool
+  //
+  static constexpr auto use_parallel(size_type count) noexcept -> bool
+  {
+#ifdef LESS_HAS_THREAD_POOL
+    return count >= 2 * parallel_grain;
+#else
+    (void)count;
+    return false;
+#endif
+  }
+
+  // calls `f(p + i, i)` for every `i` in `[first, last)`, destroying what was
+  // already constructed if `f` throws
+  //
   template <class F>
-  void construct(size_type size, size_type capacity, F f)
+  static void construct_range(pointer p, size_type first, size_type last, F& f)
   {
     constexpr size_type const stride = 32;
 
-    auto alloc = alloc_holder(this->allocate(capacity));
-
-    auto const p = alloc.p_;
+    auto guard = alloc_destroyer{0u, p + first};
 
-    auto guard = alloc_destroyer{0u, p};
+    auto const count = last - first;
 
     auto& i = guard.size;
-    for (; (i + stride) < size; i += stride) {
-      for (auto j = 0u; j < stride; ++j) {
-        f(p + i + j, i);
+    for (; (i + stride) < count;) {
+      for (auto j = 0u; j < stride; ++j, ++i) {
+        f(p + first + i, first + i);
       }
     }
 
-    for (; i < size; ++i) {
-      f(p + i, i);
+    for (; i < count; ++i) {
+      f(p + first + i, first + i);
     }
 
     guard.reset();
+  }
+
+  // same as `construct_range()` but splits large ranges across the thread
+  // pool, each worker touching its chunk first. If any chunk throws, every
+  // element is destroyed before the exception propagates.
+  //
+  template <class F>
+  static void construct_range_parallel(pointer p, size_type first,
+                                       size_type last, F& f)
+  {
+#ifdef LESS_HAS_THREAD_POOL
+    if (use_parallel(last - first)) {
+      detail::parallel_chunks(
+          last - first, parallel_grain,
+          [&](size_type b, size_type e) {
+            construct_range(p, first + b, first + e, f);
+          },
+          [&](size_type b, size_type e) {
+            for (; b < e; ++b) {
+              (p + first + b)->~T();
+            }
+          });
+      return;
+    }
+#endif
+    construct_range(p, first, last, f);
+  }
+
+  // calls `f(i)` for every `i` in `[0, count)`, in parallel when the range is
+  // large enough; `f` is used for overwriting existing elements so there's
+  // nothing to undo if it throws
+  //
+  template <class F>
+  static void for_each_index_parallel(size_type count, F& f)
+  {
+#ifdef LESS_HAS_THREAD_POOL
+    if (use_parallel(count)) {
+      detail::parallel_chunks(
+          count, parallel_grain,
+          [&](size_type b, size_type e) {
+            for (; b < e; ++b) {
+              f(b);
+            }
+          },
+          [](size_type, size_type) {});
+      return;
+    }
+#endif
+    for (auto i = 0u; i < count; ++i) {
+      f(i);
+    }
+  }
+
+  template <class F>
+  void construct(size_type size, size_type capacity, F f)
+  {
+    auto alloc = alloc_holder(this->allocate(capacity));
+
+    auto const p = alloc.p_;
+
+    construct_range_parallel(p, 0u, size, f);
+
     alloc.reset();
 
     p_        = p;
@@ -364,7 +465,7 @@ struct vector {
   template <class F>
   auto insert_impl(const_iterator pos, size_type count, F f) -> iterator
   {
-    if (size_ + count >= capacity_) {
+    if (size_ + count > capacity_) {
       auto const new_cap = count + capacity_;
 
       auto alloc = alloc_holder(this->allocate(new_cap));
@@ -565,6 +666,11 @@ struct vector {
 
   auto operator=(vector&& rhs) noexcept -> vector&
   {
+    if (this == &rhs) { return *this; }
+
+    this->clear();
+    this->deallocate(p_);
+
     p_        = rhs.p_;
     size_     = rhs.size_;
     capacity_ = rhs.capacity_;
@@ -585,14 +691,21 @@ struct vector {
 
   void assign(size_type count, T const& value)
   {
+    auto copy = [&](auto p, auto) { new (p, placement_tag) T(value); };
+
     if (count <= capacity_) {
       auto const min = (count <= size_ ? count : size_);
 
-      for (auto i = 0u; i < min; ++i) {
-        p_[i] = value;
-      }
+      auto overwrite = [&](size_type i) { p_[i] = value; };
+      for_each_index_parallel(min, overwrite);
 
       if (count > size_) {
+        if (use_parallel(count - size_)) {
+          construct_range_parallel(p_, size_, count, copy);
+          size_ = count;
+          return;
+        }
+
         for (auto& i = size_; i < count; ++i) {
           new (p_ + i, placement_tag) T(value);
         }
@@ -608,6 +721,12 @@ struct vector {
 
       p_        = this->allocate(count);
       capacity_ = count;
+      if (use_parallel(count)) {
+        construct_range_parallel(p_, 0u, count, copy);
+        size_ = count;
+        return;
+      }
+
       for (auto& i = size_; i < count; ++i) {
         new (p_ + i, placement_tag) T(value);
       }
@@ -630,6 +749,10 @@ struct vector {
     else {
       auto const count = static_cast<size_type>(last - first);
 
+      auto copy = [&](auto p, auto idx) {
+        new (p, placement_tag) T(first[idx]);
+      };
+
       if (count > capacity_) {
         auto const p = this->allocate(count);
 
@@ -638,6 +761,12 @@ struct vector {
 
         p_        = p;
         capacity_ = count;
+        if (use_parallel(count)) {
+          construct_range_parallel(p_, 0u, count, copy);
+          size_ = count;
+          return;
+        }
+
         for (auto& i = size_; i < count; ++i) {
           new (p_ + i, placement_tag) T(first[i]);
         }
@@ -646,11 +775,16 @@ struct vector {
 
       auto const min = (count <= size_ ? count : size_);
 
-      for (auto i = 0u; i < min; ++i) {
-        p_[i] = first[i];
-      }
+      auto overwrite = [&](size_type i) { p_[i] = first[i]; };
+      for_each_index_parallel(min, overwrite);
 
       if (count > size_) {
+        if (use_parallel(count - size_)) {
+          construct_range_parallel(p_, size_, count, copy);
+          size_ = count;
+          return;
+        }
+
         for (auto& i = size_; i < count; ++i) {
           new (p_ + i, placement_tag) T(first[i]);
         }
@@ -1056,17 +1190,13 @@ struct vector {
   void resize_impl(size_type count, F f)
   {
     if (count > capacity_) {
-      auto alloc  = alloc_holder(this->allocate(count));
-      auto p      = alloc.p_;
-      auto guard2 = alloc_destroyer{0u, p + size_};
-      auto guard1 = alloc_destroyer{0u, p};
+      auto alloc = alloc_holder(this->allocate(count));
+      auto p     = alloc.p_;
 
-      auto const num_new_elems = count - size_;
+      construct_range_parallel(p, size_, count, f);
 
-      auto p2 = guard2.p;
-      for (auto& i = guard2.size; i < num_new_elems; ++i) {
-        f(p2 + i);
-      }
+      auto guard2 = alloc_destroyer{count - size_, p + size_};
+      auto guard1 = alloc_destroyer{0u, p};
 
       for (auto& i = guard1.size; i < size_; ++i) {
         new (p + i, placement_tag) T(detail::move_if_noexcept(p_[i]));
@@ -1086,11 +1216,7 @@ struct vector {
     }
 
     if (count > size_) {
-      auto guard = alloc_destroyer{0u, p_ + size_};
-      for (auto& i = guard.size; i < (count - size_); ++i) {
-        f(p_ + size_ + i);
-      }
-      guard.reset();
+      construct_range_parallel(p_, size_, count, f);
 
       size_ = count;
       return;
@@ -1102,25 +1228,22 @@ struct vector {
  public:
   void resize(size_type count)
   {
-    this->resize_impl(count, [](auto* p) { new (p) T(); });
+    this->resize_impl(count,
+                      [](auto p, auto) { new (p, placement_tag) T(); });
   }
 
   void resize(size_type count, value_type const& value)
   {
-    this->resize_impl(count, [&](auto* p) { new (p) T(value); });
+    this->resize_impl(count,
+                      [&](auto p, auto) { new (p, placement_tag) T(value); });
   }
 
   template <class F>
   void resize_and_overwrite(size_type n, F f)
   {
     if (n <= size_) {
-      auto erase_begin = p_ + f(p_, n);
-      auto erase_end   = p_ + size_;
-
-      for (; erase_begin < erase_end; ++erase_begin) {
-        erase_begin->~T();
-      }
-      size_ = n;
+      auto const new_len = static_cast<size_type>(f(p_, n));
+      this->remove_from_end(size_ - new_len);
       return;
     }
 
@@ -1161,7 +1284,7 @@ struct vector {
     }
     else {
       auto guard = detail::alloc_destroyer<value_type>{0u, p_ + size_};
-      for (auto& i = guard.size; i < n; ++i) {
+      for (auto& i = guard.size; i < (n - size_); ++i) {
         new (p_ + size_ + i, placement_tag) T;
       }
       guard.reset();
@@ -1180,6 +1303,15 @@ struct vector {
     size_ -= (n - new_len);
   }
 
+  // Hands the elements over to an immutable, reference-counted
+  // `less::frozen_vector`, leaving this vector empty. Needs
+  // `<less/frozen_vector.hpp>`.
+  //
+  auto freeze() -> frozen_vector<T>
+  {
+    return frozen_vector<T>(detail::move(*this));
+  }
+
   void swap(vector& other) noexcept
   {
     auto* p    = other.p_;
@@ -1216,6 +1348,23 @@ bool operator!=(vector<T> const& lhs, vector<T> const& rhs)
   return !(lhs == rhs);
 }
 
+namespace detail {
+
+// Makes room for `n` elements in `v`, at least doubling its capacity when it
+// has to grow. Reserving this way ahead of pushes that mustn't throw keeps
+// them amortized O(1), where an exact `reserve()` would copy every time.
+//
+template <class T>
+void grow_capacity(vector<T>& v, unsigned_long_type n)
+{
+  if (n <= v.capacity()) { return; }
+
+  auto const doubled = 2 * v.capacity();
+  v.reserve(doubled > n ? doubled : n);
+}
+
+}    // namespace detail
+
 }    // namespace less
 
 #ifdef LESS_HAS_INITIALIZER_LIST
@@ -1226,4 +1375,8 @@ bool operator!=(vector<T> const& lhs, vector<T> const& rhs)
 #undef LESS_HAS_ITERATOR
 #endif
 
+#ifdef LESS_HAS_THREAD_POOL
+#undef LESS_HAS_THREAD_POOL
+#endif
+
 #endif    // LESS_VECTOR_HPP
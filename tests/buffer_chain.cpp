@@ -0,0 +1,209 @@
+#include "lwt_helper.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <thread>
+#include <unistd.h>
+
+#include <less/buffer_chain.hpp>
+
+static auto make(char const* s) -> less::vector<char>
+{
+  return less::vector<char>(s, s + std::strlen(s));
+}
+
+static auto drain(int fd) -> less::vector<char>
+{
+  auto out = less::vector<char>();
+  char buf[4096];
+  while (true) {
+    auto const n = read(fd, buf, sizeof(buf));
+    if (n <= 0) { break; }
+    out.insert(out.end(), buf, buf + n);
+  }
+  return out;
+}
+
+static void owned_and_borrowed()
+{
+  auto const header = make("HTTP/1.1 200 OK\r\n\r\n");
+
+  auto chain = less::buffer_chain();
+  BOOST_TEST(chain.empty());
+  BOOST_TEST_EQ(chain.iov_count(), 0u);
+
+  chain.borrow(header);
+  chain.push_back(make("hello, "));
+  chain.push_back(less::vector<char>());
+  chain.borrow("world", 5);
+
+  BOOST_TEST_EQ(chain.size(), header.size() + 12);
+  BOOST_TEST_EQ(chain.iov_count(), 3u);
+
+  // borrowed buffers aren't copied
+  //
+  BOOST_TEST_EQ(chain.iov()[0].iov_base,
+                static_cast<void const*>(header.data()));
+
+  int fds[2];
+  BOOST_TEST_EQ(pipe(fds), 0);
+
+  auto const n = chain.write(fds[1]);
+  BOOST_TEST_EQ(n, header.size() + 12);
+  BOOST_TEST(chain.empty());
+  BOOST_TEST_EQ(chain.iov_count(), 0u);
+  BOOST_TEST_EQ(chain.write(fds[1]), 0u);
+  close(fds[1]);
+
+  auto const out = drain(fds[0]);
+  close(fds[0]);
+
+  auto const expected = make("HTTP/1.1 200 OK\r\n\r\nhello, world");
+  BOOST_TEST(out == expected);
+}
+
+static void partial_consume()
+{
+  auto chain = less::buffer_chain();
+  chain.push_back(make("abc"));
+  chain.push_back(make("defg"));
+  chain.borrow("hi", 2);
+
+  chain.consume(2);
+  BOOST_TEST_EQ(chain.size(), 7u);
+  BOOST_TEST_EQ(chain.iov_count(), 3u);
+  BOOST_TEST_EQ(chain.iov()[0].iov_len, 1u);
+  BOOST_TEST_EQ(*static_cast<char const*>(chain.iov()[0].iov_base), 'c');
+
+  // finishing the first buffer and starting on the second
+  //
+  chain.consume(3);
+  BOOST_TEST_EQ(chain.size(), 4u);
+  BOOST_TEST_EQ(chain.iov_count(), 2u);
+  BOOST_TEST_EQ(chain.iov()[0].iov_len, 2u);
+  BOOST_TEST_EQ(*static_cast<char const*>(chain.iov()[0].iov_base), 'f');
+
+  chain.consume(4);
+  BOOST_TEST(chain.empty());
+  BOOST_TEST_EQ(chain.iov_count(), 0u);
+}
+
+static void recycling()
+{
+  auto chain = less::buffer_chain();
+  BOOST_TEST_EQ(chain.acquire().capacity(), 0u);
+
+  auto v = less::vector<char>(less::with_capacity, 4096u);
+  v.insert(v.end(), 100u, 'x');
+  auto const p = v.data();
+
+  chain.push_back(std::move(v));
+  chain.consume(50);
+
+  // not drained yet
+  //
+  BOOST_TEST_EQ(chain.acquire().capacity(), 0u);
+
+  chain.consume(50);
+
+  auto w = chain.acquire();
+  BOOST_TEST(w.empty());
+  BOOST_TEST_EQ(w.capacity(), 4096u);
+  BOOST_TEST_EQ(w.data(), p);
+  BOOST_TEST_EQ(chain.acquire().capacity(), 0u);
+
+  // clearing recycles unwritten buffers too, up to the limit
+  //
+  for (auto i = 0u; i < 2 * less::buffer_chain::max_spare; ++i) {
+    chain.push_back(make("abc"));
+  }
+  chain.clear();
+  BOOST_TEST(chain.empty());
+  BOOST_TEST_EQ(chain.iov_count(), 0u);
+
+  auto recycled = 0u;
+  while (chain.acquire().capacity() > 0) {
+    ++recycled;
+  }
+  BOOST_TEST_EQ(recycled, less::buffer_chain::max_spare);
+}
+
+static void nonblocking()
+{
+  int fds[2];
+  BOOST_TEST_EQ(pipe(fds), 0);
+  fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+  // far more buffers than fit into a single `writev()` and more bytes than a
+  // pipe holds
+  //
+  auto expected = less::vector<char>();
+  auto chain    = less::buffer_chain();
+  for (auto i = 0u; i < 5000; ++i) {
+    auto v = chain.acquire();
+    for (auto j = 0u; j < 97; ++j) {
+      v.push_back(static_cast<char>('a' + (i + j) % 26));
+    }
+    expected.insert(expected.end(), v.begin(), v.end());
+    chain.push_back(std::move(v));
+  }
+  BOOST_TEST_EQ(chain.size(), expected.size());
+
+  auto out    = less::vector<char>();
+  auto reader = std::thread([&] { out = drain(fds[0]); });
+
+  auto total = less::unsigned_long_type{0};
+  while (!chain.empty()) {
+    auto const n = chain.write(fds[1]);
+    total += n;
+    BOOST_TEST_EQ(chain.size(), expected.size() - total);
+    if (n == 0) { std::this_thread::yield(); }
+  }
+  close(fds[1]);
+  reader.join();
+  close(fds[0]);
+
+  BOOST_TEST_EQ(total, expected.size());
+  BOOST_TEST(out == expected);
+}
+
+static void positional()
+{
+  char path[32] = "/tmp/less_chain_XXXXXX";
+
+  auto const fd = mkstemp(path);
+  BOOST_TEST_NE(fd, -1);
+
+  auto chain = less::buffer_chain();
+  chain.push_back(make("0123456789"));
+  BOOST_TEST_EQ(chain.write(fd, 0), 10u);
+
+  chain.borrow("abc", 3);
+  chain.push_back(make("de"));
+  BOOST_TEST_EQ(chain.write(fd, 4), 5u);
+
+  BOOST_TEST_EQ(lseek(fd, 0, SEEK_SET), 0);
+  auto const out = drain(fd);
+  BOOST_TEST(out == make("0123abcde9"));
+
+  close(fd);
+  unlink(path);
+
+  // errors throw and leave the chain alone
+  //
+  chain.push_back(make("lost"));
+  BOOST_TEST_THROWS(chain.write(fd), less::system_error);
+  BOOST_TEST_EQ(chain.size(), 4u);
+}
+
+int main()
+{
+  owned_and_borrowed();
+  partial_consume();
+  recycling();
+  nonblocking();
+  positional();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,166 @@
+#include "lwt_helper.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include <less/concurrent_vector.hpp>
+
+static std::atomic<int> live{0};
+
+struct counted {
+  unsigned value = 0;
+
+  counted() noexcept
+  {
+    ++live;
+  }
+
+  counted(unsigned v)
+      : value(v)
+  {
+    if (v == 0xdeadbeef) { throw 1; }
+    ++live;
+  }
+
+  counted(counted const& rhs) noexcept
+      : value(rhs.value)
+  {
+    ++live;
+  }
+
+  ~counted()
+  {
+    --live;
+  }
+};
+
+static void layout()
+{
+  using cv = less::concurrent_vector<int>;
+
+  auto v = cv();
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(v.segment_count(), 0u);
+  BOOST_TEST_EQ(v.capacity(), 0u);
+  BOOST_TEST_EQ(cv::first_segment_size, 1024u);
+
+  auto const n = 5 * cv::first_segment_size;
+  for (auto i = 0u; i < n; ++i) {
+    BOOST_TEST_EQ(v.push_back(static_cast<int>(i)), i);
+  }
+
+  // segments of 1, 2 and 4 times the first one
+  //
+  BOOST_TEST_EQ(v.size(), n);
+  BOOST_TEST_EQ(v.segment_count(), 3u);
+  BOOST_TEST_EQ(v.capacity(), 7 * cv::first_segment_size);
+  BOOST_TEST_EQ(v.segment(0).size(), cv::first_segment_size);
+  BOOST_TEST_EQ(v.segment(1).size(), 2 * cv::first_segment_size);
+  BOOST_TEST_EQ(v.segment(2).size(), 2 * cv::first_segment_size);
+  BOOST_TEST(v.segment(3).empty());
+
+  auto expected = 0;
+  for (auto k = 0u; k < v.segment_count(); ++k) {
+    for (auto x : v.segment(k)) {
+      BOOST_TEST_ASSERT_EQ(x, expected++);
+    }
+  }
+  BOOST_TEST_EQ(v.segment(1).data(), &v[cv::first_segment_size]);
+  BOOST_TEST_EQ(v.at(4000), 4000);
+  BOOST_TEST_THROWS(v.at(n), less::out_of_range);
+
+  // nothing ever moves
+  //
+  auto const p = &v[17];
+  v.grow_by(100 * cv::first_segment_size);
+  BOOST_TEST_EQ(&v[17], p);
+  BOOST_TEST_EQ(v[n], 0);
+
+  v.clear();
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(v.capacity(), 127 * cv::first_segment_size);
+
+  auto w = less::concurrent_vector<double>();
+  w.reserve(512);
+  BOOST_TEST_EQ(w.capacity(), 512u);
+  w.reserve(513);
+  BOOST_TEST_EQ(w.capacity(), 1536u);
+}
+
+static void concurrent_appends()
+{
+  constexpr auto const num_threads = 8u;
+  constexpr auto const per_thread  = 20000u;
+
+  {
+    auto v = less::concurrent_vector<counted>();
+
+    auto threads = less::vector<std::thread>();
+    for (auto t = 0u; t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        for (auto i = 0u; i < per_thread; ++i) {
+          if (i % 100 == 0) {
+            // ranges stay contiguous in index space
+            //
+            auto const first = v.grow_by(10, counted(t * per_thread + i));
+            for (auto j = 0u; j < 10; ++j) {
+              BOOST_TEST_ASSERT_EQ(v[first + j].value, t * per_thread + i);
+            }
+            continue;
+          }
+
+          auto const pos = v.push_back(counted(t * per_thread + i));
+          BOOST_TEST_ASSERT_EQ(v[pos].value, t * per_thread + i);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    auto const grown = num_threads * (per_thread / 100);
+    BOOST_TEST_EQ(v.size(), num_threads * per_thread + 9 * grown);
+    BOOST_TEST_EQ(live.load(), static_cast<int>(v.size()));
+
+    auto seen = less::vector<unsigned char>(num_threads * per_thread, 0);
+    v.for_each([&](counted const& c) { ++seen[c.value]; });
+    for (auto i = 0u; i < seen.size(); ++i) {
+      BOOST_TEST_ASSERT_EQ(seen[i], (i % per_thread) % 100 == 0 ? 10 : 1);
+    }
+  }
+  BOOST_TEST_EQ(live.load(), 0);
+}
+
+static void throwing()
+{
+  {
+    auto v = less::concurrent_vector<counted>();
+    v.push_back(counted(1));
+    BOOST_TEST_THROWS(v.emplace_back(0xdeadbeef), int);
+    v.push_back(counted(2));
+
+    // the failed index stays claimed but is never destroyed
+    //
+    BOOST_TEST_EQ(v.size(), 3u);
+    BOOST_TEST_EQ(v[2].value, 2u);
+    BOOST_TEST_EQ(live.load(), 2);
+  }
+  BOOST_TEST_EQ(live.load(), 0);
+
+  {
+    auto v = less::concurrent_vector<std::string>();
+    v.push_back("a string too long for the small buffer");
+    v.grow_by(3000, "another string too long for the small buffer");
+    BOOST_TEST_EQ(v[2999], "another string too long for the small buffer");
+  }
+}
+
+int main()
+{
+  layout();
+  concurrent_appends();
+  throwing();
+
+  return boost::report_errors();
+}
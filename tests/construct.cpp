@@ -261,6 +261,51 @@ static void initializer_list_construct()
 //   BOOST_TEST_EQ(v[0].x, 7331);
 // }
 
+static int live = 0;
+
+struct tracked {
+  tracked()
+  {
+    ++live;
+  }
+
+  tracked(tracked const&)
+  {
+    ++live;
+  }
+
+  ~tracked()
+  {
+    --live;
+  }
+};
+
+static void move_assign()
+{
+  {
+    auto v  = less::vector<tracked>(10u);
+    auto v2 = less::vector<tracked>(20u);
+    BOOST_TEST_EQ(live, 30);
+
+    auto const data = v2.data();
+
+    // the elements we held before are destroyed and their storage released
+    //
+    v = std::move(v2);
+    BOOST_TEST_EQ(live, 20);
+    BOOST_TEST_EQ(v.size(), 20u);
+    BOOST_TEST_EQ(v.data(), data);
+    BOOST_TEST(v2.empty());
+    BOOST_TEST_EQ(v2.data(), nullptr);
+
+    auto& self = v;
+    v          = std::move(self);
+    BOOST_TEST_EQ(v.size(), 20u);
+    BOOST_TEST_EQ(live, 20);
+  }
+  BOOST_TEST_EQ(live, 0);
+}
+
 int main()
 {
   default_construct();
@@ -273,6 +318,7 @@ int main()
   copy_construct_raii();
   move_construct();
   move_construct_raii();
+  move_assign();
   iterator_construct_random_access();
   iterator_construct_bidirectional();
   initializer_list_construct();
@@ -0,0 +1,154 @@
+#include "lwt_helper.hpp"
+
+#define LESS_EXTERNAL_SORT_MIN_BLOCK 256u
+
+#include <cstdint>
+
+#include <less/external_sort.hpp>
+
+struct record {
+  std::uint64_t key;
+  std::uint32_t seq;
+  std::uint32_t pad;
+};
+
+static auto next_random(std::uint64_t& state) -> std::uint64_t
+{
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+static void single_pass()
+{
+  auto v = less::external_vector<std::uint32_t>(4u, 4096u);
+
+  auto state = std::uint64_t{12345};
+  for (auto i = 0u; i < 50000u; ++i) {
+    v.push_back(static_cast<std::uint32_t>(next_random(state) % 100000u));
+  }
+
+  // 16 runs of 3125 elements, merged in one pass
+  //
+  less::external_sort(v, 3125u * 4u);
+  BOOST_TEST_EQ(v.size(), 50000u);
+
+  auto prev = 0u;
+  auto ok   = true;
+  auto sum  = std::uint64_t{0};
+  v.for_each([&](std::uint32_t x) {
+    ok   = ok && prev <= x;
+    prev = x;
+    sum += x;
+  });
+  BOOST_TEST(ok);
+
+  state         = 12345;
+  auto expected = std::uint64_t{0};
+  for (auto i = 0u; i < 50000u; ++i) {
+    expected += next_random(state) % 100000u;
+  }
+  BOOST_TEST_EQ(sum, expected);
+}
+
+static void multi_pass()
+{
+  auto v = less::external_vector<record>(8u, 64u * sizeof(record));
+
+  auto state = std::uint64_t{987654321};
+  for (auto i = 0u; i < 40000u; ++i) {
+    v.push_back(record{next_random(state) % 5000u, i, 0u});
+  }
+
+  // 100-element runs against a fan-in of 2 force many merge passes
+  //
+  less::external_sort(v, 100u * sizeof(record),
+                      [](record const& a, record const& b) {
+                        return a.key > b.key;
+                      });
+  BOOST_TEST_EQ(v.size(), 40000u);
+
+  auto prev  = ~std::uint64_t{0};
+  auto ok    = true;
+  auto seen  = less::vector<unsigned char>(40000u);
+  v.for_each([&](record const& r) {
+    ok   = ok && r.key <= prev;
+    prev = r.key;
+    seen[r.seq] += 1u;
+  });
+  BOOST_TEST(ok);
+
+  auto all_once = true;
+  for (auto s : seen) {
+    all_once = all_once && s == 1u;
+  }
+  BOOST_TEST(all_once);
+}
+
+static void small()
+{
+  auto v = less::external_vector<int>(2u);
+  less::external_sort(v, 1024u);
+  BOOST_TEST(v.empty());
+
+  v.push_back(3);
+  v.push_back(1);
+  v.push_back(2);
+  less::external_sort(v, 1u << 20);
+  BOOST_TEST_EQ(v[0], 1);
+  BOOST_TEST_EQ(v[1], 2);
+  BOOST_TEST_EQ(v[2], 3);
+}
+
+static void throwing_comparator()
+{
+  auto v = less::external_vector<std::uint32_t>(4u, 4096u);
+
+  auto state = std::uint64_t{555};
+  for (auto i = 0u; i < 10000u; ++i) {
+    v.push_back(static_cast<std::uint32_t>(next_random(state) % 1000u));
+  }
+
+  // count the comparisons of a full sort, then fail the last one, which is
+  // part of the final merge
+  //
+  auto calls = 0u;
+  {
+    auto w = less::external_vector<std::uint32_t>(4u, 4096u);
+    v.for_each([&](std::uint32_t x) { w.push_back(x); });
+    less::external_sort(w, 1000u * 4u, [&](std::uint32_t a, std::uint32_t b) {
+      ++calls;
+      return a < b;
+    });
+  }
+
+  auto left = calls;
+  BOOST_TEST_THROWS(
+      less::external_sort(v, 1000u * 4u,
+                          [&](std::uint32_t a, std::uint32_t b) {
+                            if (--left == 0) { throw 1; }
+                            return a < b;
+                          }),
+      int);
+
+  // `v` still holds the unsorted input
+  //
+  BOOST_TEST_EQ(v.size(), 10000u);
+  state   = 555;
+  auto ok = true;
+  v.for_each([&](std::uint32_t x) {
+    ok = ok && x == next_random(state) % 1000u;
+  });
+  BOOST_TEST(ok);
+}
+
+int main()
+{
+  single_pass();
+  multi_pass();
+  small();
+  throwing_comparator();
+
+  return boost::report_errors();
+}
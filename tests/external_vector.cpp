@@ -0,0 +1,94 @@
+#include "lwt_helper.hpp"
+
+#include <cstdint>
+
+#include <less/external_vector.hpp>
+
+struct point {
+  std::uint32_t x;
+  std::uint32_t y;
+};
+
+static void push_back_and_scan()
+{
+  // 4 resident pages of 512 elements each for 20 pages' worth of data
+  //
+  auto v = less::external_vector<std::uint32_t>(4u, 2048u);
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(v.page_size(), 512u);
+  BOOST_TEST_EQ(v.max_resident(), 4u);
+
+  auto const n = 20u * 512u + 100u;
+  for (auto i = 0u; i < n; ++i) {
+    v.push_back(i * 3u);
+  }
+
+  BOOST_TEST_EQ(v.size(), n);
+  BOOST_TEST_LE(v.resident(), 4u);
+
+  // every full page went out as it filled, so nothing was dirty to evict
+  //
+  auto stats = v.stats();
+  BOOST_TEST_EQ(stats.write_behinds, 20u);
+  BOOST_TEST_EQ(stats.dirty_evictions, 0u);
+  BOOST_TEST_EQ(stats.evictions, 17u);
+  BOOST_TEST_EQ(stats.faults, 0u);
+
+  auto next = 0u;
+  auto ok   = true;
+  v.for_each([&](std::uint32_t x) { ok = ok && (x == 3u * next++); });
+  BOOST_TEST(ok);
+  BOOST_TEST_EQ(next, n);
+
+  // the scan from the front evicts the last pages before it gets to them
+  //
+  stats = v.stats();
+  BOOST_TEST_EQ(stats.faults, 21u);
+  BOOST_TEST_GE(stats.read_aheads, 15u);
+  BOOST_TEST_LE(stats.read_aheads, 20u);
+}
+
+static void random_access()
+{
+  auto v = less::external_vector<point>(3u, 64u * sizeof(point));
+  for (auto i = 0u; i < 1000u; ++i) {
+    v.push_back(point{i, 0u});
+  }
+
+  // a partial last page with unsaved changes survives eviction too
+  //
+  for (auto i = 0u; i < 1000u; i += 7u) {
+    v.set(i, point{i, i + 1});
+  }
+
+  auto ok = true;
+  for (auto i = 0u; i < 1000u; ++i) {
+    auto const p = v[(i * 389u) % 1000u];
+    auto const j = (i * 389u) % 1000u;
+    ok = ok && p.x == j && p.y == (j % 7u == 0u ? j + 1 : 0u);
+  }
+  BOOST_TEST(ok);
+
+  auto const stats = v.stats();
+  BOOST_TEST_GT(stats.faults, 0u);
+  BOOST_TEST_GT(stats.dirty_evictions, 0u);
+  BOOST_TEST_EQ(v.back().x, 999u);
+  BOOST_TEST_THROWS(v.at(1000u), less::out_of_range);
+  BOOST_TEST_THROWS(v.set(1000u, point{}), less::out_of_range);
+
+  v.flush();
+  v.clear();
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(v.resident(), 0u);
+
+  v.push_back(point{5u, 6u});
+  BOOST_TEST_EQ(v[0].y, 6u);
+}
+
+int main()
+{
+  push_back_and_scan();
+  random_access();
+
+  return boost::report_errors();
+}
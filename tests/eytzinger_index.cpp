@@ -0,0 +1,105 @@
+#include "lwt_helper.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+
+#include <less/eytzinger_index.hpp>
+
+static void ranks()
+{
+  // every tree shape up to a few levels, with duplicates and gaps
+  //
+  for (auto n = 0u; n < 260u; ++n) {
+    auto sorted = less::vector<int>();
+    for (auto i = 0u; i < n; ++i) {
+      sorted.push_back(static_cast<int>(2 * (i / 2 + i / 3)));
+    }
+
+    auto const index = less::eytzinger_index<int>(sorted);
+    BOOST_TEST_EQ(index.size(), n);
+
+    auto queries = less::vector<int>();
+    for (auto x = -2; x <= (sorted.empty() ? 0 : sorted.back()) + 2; ++x) {
+      queries.push_back(x);
+    }
+    auto const batch = index.lower_bound(queries);
+
+    for (auto i = 0u; i < queries.size(); ++i) {
+      auto const x  = queries[i];
+      auto const lb = static_cast<unsigned>(
+          std::lower_bound(sorted.begin(), sorted.end(), x) - sorted.begin());
+      auto const ub = static_cast<unsigned>(
+          std::upper_bound(sorted.begin(), sorted.end(), x) - sorted.begin());
+
+      BOOST_TEST_ASSERT_EQ(index.lower_bound(x), lb);
+      BOOST_TEST_ASSERT_EQ(index.upper_bound(x), ub);
+      BOOST_TEST_ASSERT_EQ(batch[i], lb);
+      BOOST_TEST_ASSERT_EQ(index.contains(x), lb != ub);
+    }
+  }
+}
+
+static void large()
+{
+  auto rng = std::mt19937_64(1234);
+
+  auto sorted = less::vector<std::uint64_t>(less::default_init, 100'000u);
+  for (auto& x : sorted) {
+    x = rng() % 1'000'000u;
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  auto index = less::eytzinger_index<std::uint64_t>(sorted);
+
+  // an odd count, so the last batch is partial
+  //
+  auto queries = less::vector<std::uint64_t>(less::default_init, 10'007u);
+  for (auto& q : queries) {
+    q = rng() % 1'100'000u;
+  }
+
+  auto ranks = less::vector<less::unsigned_long_type>(less::default_init,
+                                                      queries.size());
+  index.lower_bound(queries.data(), queries.size(), ranks.data());
+  for (auto i = 0u; i < queries.size(); ++i) {
+    auto const expected = static_cast<less::unsigned_long_type>(
+        std::lower_bound(sorted.begin(), sorted.end(), queries[i]) -
+        sorted.begin());
+    BOOST_TEST_ASSERT_EQ(ranks[i], expected);
+    BOOST_TEST_ASSERT_EQ(index.lower_bound(queries[i]), expected);
+  }
+
+  auto moved = std::move(index);
+  BOOST_TEST(index.empty());
+  BOOST_TEST_EQ(moved.size(), sorted.size());
+  BOOST_TEST(moved.contains(sorted[500]));
+}
+
+static void custom_order()
+{
+  auto sorted = less::vector<std::string>{"pear", "kiwi", "fig", "apple"};
+  auto index =
+      less::eytzinger_index<std::string, std::greater<>>(sorted);
+
+  BOOST_TEST_EQ(index.lower_bound("kiwi"), 1u);
+  BOOST_TEST_EQ(index.lower_bound("grape"), 2u);
+  BOOST_TEST_EQ(index.lower_bound("a"), 4u);
+  BOOST_TEST(index.contains("fig"));
+  BOOST_TEST(!index.contains("plum"));
+
+  auto const empty = less::eytzinger_index<int>();
+  BOOST_TEST_EQ(empty.lower_bound(3), 0u);
+  BOOST_TEST(!empty.contains(3));
+}
+
+int main()
+{
+  ranks();
+  large();
+  custom_order();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,315 @@
+#include "lwt_helper.hpp"
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <less/flat_hash_map.hpp>
+
+static void basics()
+{
+  auto m = less::flat_hash_map<int, std::string>();
+  BOOST_TEST(m.empty());
+  BOOST_TEST(m.begin() == m.end());
+  BOOST_TEST(m.find(1) == m.end());
+  BOOST_TEST_EQ(m.erase(1), 0u);
+
+  auto r = m.try_emplace(1, "one");
+  BOOST_TEST(r.second);
+  BOOST_TEST_EQ(r.first->first, 1);
+  BOOST_TEST_EQ(r.first->second, "one");
+
+  r = m.try_emplace(1, "uno");
+  BOOST_TEST(!r.second);
+  BOOST_TEST_EQ(r.first->second, "one");
+
+  m.insert({2, "two"});
+  m[3] = "three";
+  BOOST_TEST_EQ(m.size(), 3u);
+  BOOST_TEST_EQ(m.capacity(), 16u);
+  BOOST_TEST_EQ(m.at(2), "two");
+  BOOST_TEST_THROWS(m.at(4), less::out_of_range);
+  BOOST_TEST(m.contains(3));
+  BOOST_TEST_EQ(m.count(4), 0u);
+
+  m.insert_or_assign(1, "uno");
+  BOOST_TEST_EQ(m[1], "uno");
+
+  auto n = 0;
+  for (auto const& kv : m) {
+    n += kv.first;
+  }
+  BOOST_TEST_EQ(n, 6);
+
+  auto copy = m;
+  BOOST_TEST(copy == m);
+  copy[4] = "four";
+  BOOST_TEST(copy != m);
+
+  auto moved = std::move(copy);
+  BOOST_TEST(copy.empty());
+  BOOST_TEST_EQ(moved.size(), 4u);
+
+  BOOST_TEST_EQ(m.erase(2), 1u);
+  BOOST_TEST(!m.contains(2));
+  BOOST_TEST_EQ(m.size(), 2u);
+
+  m.clear();
+  BOOST_TEST(m.empty());
+  BOOST_TEST(m.begin() == m.end());
+  BOOST_TEST_EQ(m.capacity(), 16u);
+}
+
+static void against_std()
+{
+  auto rng = std::mt19937(1234);
+
+  auto m   = less::flat_hash_map<unsigned, unsigned>();
+  auto ref = std::unordered_map<unsigned, unsigned>();
+
+  // inserts and erases mixed so tombstones pile up and get cleaned out
+  //
+  for (auto i = 0u; i < 200'000u; ++i) {
+    auto const k = rng() % 20'000u;
+    if (rng() % 3u == 0) {
+      BOOST_TEST_ASSERT_EQ(m.erase(k), ref.erase(k));
+    }
+    else {
+      m[k] += i;
+      ref[k] += i;
+    }
+  }
+
+  BOOST_TEST_EQ(m.size(), ref.size());
+  for (auto const& kv : ref) {
+    auto it = m.find(kv.first);
+    BOOST_TEST_ASSERT(it != m.end());
+    BOOST_TEST_ASSERT_EQ(it->second, kv.second);
+  }
+
+  auto seen = 0u;
+  for (auto it = m.begin(); it != m.end(); ++it) {
+    BOOST_TEST_ASSERT(ref.count(it->first) == 1u);
+    ++seen;
+  }
+  BOOST_TEST_EQ(seen, ref.size());
+
+  // erase while iterating
+  //
+  for (auto it = m.begin(); it != m.end();) {
+    if (it->first % 2 == 0) {
+      it = m.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+  for (auto const& kv : m) {
+    BOOST_TEST_ASSERT(kv.first % 2 == 1);
+  }
+}
+
+static void bulk()
+{
+  auto m = less::flat_hash_map<int, int>(less::with_capacity, 1000u);
+  auto const capacity = m.capacity();
+  BOOST_TEST_GE(capacity, 1000u);
+  for (auto i = 0; i < 1000; ++i) {
+    m[i] = i;
+  }
+  BOOST_TEST_EQ(m.capacity(), capacity);
+
+  auto pairs = less::vector<std::pair<int, int>>();
+  for (auto i = 0; i < 5000; ++i) {
+    pairs.emplace_back(i % 3000, i);
+  }
+
+  auto b = less::flat_hash_map<int, int>(pairs.begin(), pairs.end());
+  BOOST_TEST_EQ(b.size(), 3000u);
+  BOOST_TEST_EQ(b.at(10), 10);
+
+  auto keys   = less::vector<std::string>{"a", "b", "a", "c"};
+  auto values = less::vector<int>{1, 2, 3, 4};
+  auto p = less::flat_hash_map<std::string, int>(std::move(keys),
+                                                 std::move(values));
+  BOOST_TEST_EQ(p.size(), 3u);
+  BOOST_TEST_EQ(p.at("a"), 1);
+
+  BOOST_TEST_THROWS((less::flat_hash_map<int, int>(less::vector<int>{1, 2, 3},
+                                                   less::vector<int>{1, 2})),
+                    less::out_of_range);
+  BOOST_TEST_THROWS((less::flat_hash_map<int, int>(less::vector<int>{1},
+                                                   less::vector<int>{1, 2})),
+                    less::out_of_range);
+}
+
+// a hasher with state, which has to be passed in
+//
+struct seeded_hash {
+  std::size_t seed = 0;
+
+  auto operator()(int x) const noexcept -> std::size_t
+  {
+    return std::hash<int>()(x) ^ seed;
+  }
+};
+
+static void stateful_hash()
+{
+  using map_type = less::flat_hash_map<int, int, seeded_hash>;
+
+  auto const hash = seeded_hash{0x9e3779b9u};
+
+  auto a = map_type(hash);
+  a[1] = 1;
+  BOOST_TEST_EQ(a.hash_function().seed, hash.seed);
+
+  auto b = map_type(less::with_capacity, 100u, hash);
+  BOOST_TEST_EQ(b.hash_function().seed, hash.seed);
+
+  auto pairs = less::vector<std::pair<int, int>>{{1, 10}, {2, 20}};
+  auto c     = map_type(pairs.begin(), pairs.end(), hash);
+  BOOST_TEST_EQ(c.hash_function().seed, hash.seed);
+  BOOST_TEST_EQ(c.at(2), 20);
+
+  auto d = map_type({{3, 30}, {4, 40}}, hash);
+  BOOST_TEST_EQ(d.hash_function().seed, hash.seed);
+  BOOST_TEST_EQ(d.at(3), 30);
+
+  auto e = map_type(less::vector<int>{5, 6}, less::vector<int>{50, 60}, hash,
+                    std::equal_to<int>());
+  BOOST_TEST_EQ(e.hash_function().seed, hash.seed);
+  BOOST_TEST_EQ(e.at(6), 60);
+
+  auto f = std::move(e);
+  BOOST_TEST_EQ(f.hash_function().seed, hash.seed);
+  BOOST_TEST_EQ(f.at(5), 50);
+}
+
+struct string_hash {
+  using is_transparent = void;
+
+  auto operator()(std::string_view s) const noexcept -> std::size_t
+  {
+    return std::hash<std::string_view>()(s);
+  }
+};
+
+static void heterogeneous()
+{
+  auto m = less::flat_hash_map<std::string, int, string_hash, std::equal_to<>>();
+  m.try_emplace("apple", 1);
+  m.try_emplace("banana", 2);
+
+  auto const key = std::string_view("banana");
+  BOOST_TEST(m.contains(key));
+  BOOST_TEST_EQ(m.find(key)->second, 2);
+  BOOST_TEST_EQ(m.at("apple"), 1);
+  BOOST_TEST_EQ(m.count(std::string_view("cherry")), 0u);
+  BOOST_TEST_EQ(m.erase(key), 1u);
+  BOOST_TEST_EQ(m.size(), 1u);
+}
+
+// a key whose copies can throw, so rehashing takes the copying path
+//
+struct throwing_key {
+  static inline int copies_left = -1;
+
+  int value;
+
+  throwing_key(int v)
+      : value(v)
+  {
+  }
+
+  throwing_key(throwing_key const& other)
+      : value(other.value)
+  {
+    if (copies_left == 0) { throw 1; }
+    if (copies_left > 0) { --copies_left; }
+  }
+
+  bool operator==(throwing_key const& other) const
+  {
+    return value == other.value;
+  }
+};
+
+struct throwing_key_hash {
+  auto operator()(throwing_key const& k) const noexcept -> std::size_t
+  {
+    return static_cast<std::size_t>(k.value);
+  }
+};
+
+static void rehash_exceptions()
+{
+  auto m = less::flat_hash_map<throwing_key, std::string, throwing_key_hash>();
+  for (auto i = 0; i < 14; ++i) {
+    m.try_emplace(throwing_key(i), std::string(40, 'x'));
+  }
+
+  // the 15th insert needs a bigger table, and copying into it fails halfway
+  //
+  throwing_key::copies_left = 5;
+  BOOST_TEST_THROWS(m.try_emplace(throwing_key(14), "y"), int);
+  throwing_key::copies_left = -1;
+
+  BOOST_TEST_EQ(m.size(), 14u);
+  for (auto i = 0; i < 14; ++i) {
+    BOOST_TEST_EQ(m.at(throwing_key(i)), std::string(40, 'x'));
+  }
+}
+
+// a hasher that fails after a set number of calls
+//
+struct throwing_hash {
+  static inline int calls_left = -1;
+
+  auto operator()(int x) const -> std::size_t
+  {
+    if (calls_left == 0) { throw 1; }
+    if (calls_left > 0) { --calls_left; }
+    return std::hash<int>()(x);
+  }
+};
+
+static void throwing_hasher()
+{
+  // keys and values that move without throwing, so rehashing moves them
+  //
+  auto m = less::flat_hash_map<int, std::string, throwing_hash>();
+  for (auto i = 0; i < 14; ++i) {
+    m.try_emplace(i, std::string(40, 'a' + i));
+  }
+
+  // the 15th insert rehashes, and the hasher fails partway through
+  //
+  throwing_hash::calls_left = 5;
+  BOOST_TEST_THROWS(m.try_emplace(14, "y"), int);
+  throwing_hash::calls_left = -1;
+
+  BOOST_TEST_EQ(m.size(), 14u);
+  for (auto i = 0; i < 14; ++i) {
+    BOOST_TEST_EQ(m.at(i), std::string(40, 'a' + i));
+  }
+
+  m.try_emplace(14, "y");
+  BOOST_TEST_EQ(m.size(), 15u);
+  BOOST_TEST_EQ(m.at(14), "y");
+}
+
+int main()
+{
+  basics();
+  against_std();
+  bulk();
+  stateful_hash();
+  heterogeneous();
+  rehash_exceptions();
+  throwing_hasher();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,175 @@
+#include "lwt_helper.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <less/flat_map.hpp>
+
+static void basics()
+{
+  auto m = less::flat_map<int, std::string>();
+
+  auto r = m.emplace(3, "three");
+  BOOST_TEST(r.second);
+  BOOST_TEST_EQ(r.first->first, 3);
+  BOOST_TEST_EQ(r.first->second, "three");
+
+  m.insert({1, "one"});
+  m[2] = "two";
+  BOOST_TEST_EQ(m.size(), 3u);
+  BOOST_TEST(m.keys() == (less::vector<int>{1, 2, 3}));
+  BOOST_TEST(m.values() ==
+             (less::vector<std::string>{"one", "two", "three"}));
+
+  r = m.emplace(3, "drei");
+  BOOST_TEST(!r.second);
+  BOOST_TEST_EQ(r.first.value(), "three");
+
+  auto a = m.insert_or_assign(3, "drei");
+  BOOST_TEST(!a.second);
+  BOOST_TEST_EQ(m.at(3), "drei");
+  BOOST_TEST_THROWS(m.at(4), less::out_of_range);
+
+  auto it = m.find(2);
+  BOOST_TEST(it != m.end());
+  it->second += "!";
+  BOOST_TEST_EQ(m.at(2), "two!");
+  BOOST_TEST(m.find(7) == m.end());
+  BOOST_TEST(!m.contains(0));
+
+  auto keys = 0;
+  for (auto const& kv : m) {
+    keys += kv.first;
+  }
+  BOOST_TEST_EQ(keys, 6);
+
+  auto const& cm = m;
+  BOOST_TEST_EQ(cm.lower_bound(2).key(), 2);
+  BOOST_TEST(cm.upper_bound(3) == cm.end());
+  BOOST_TEST_EQ(cm.end() - cm.begin(), 3);
+
+  it = m.erase(m.find(1));
+  BOOST_TEST_EQ(it.key(), 2);
+  BOOST_TEST_EQ(m.erase(3), 1u);
+  BOOST_TEST_EQ(m.size(), 1u);
+}
+
+static void batches()
+{
+  auto rng = std::mt19937(1234);
+
+  auto m   = less::flat_map<unsigned, unsigned>();
+  auto ref = std::map<unsigned, unsigned>();
+  for (auto round = 0u; round < 20u; ++round) {
+    auto batch = less::vector<std::pair<unsigned, unsigned>>();
+    for (auto i = 0u; i < 500u; ++i) {
+      batch.emplace_back(rng() % 10'000u, round * 1000u + i);
+    }
+
+    m.insert(batch.begin(), batch.end());
+    ref.insert(batch.begin(), batch.end());
+    BOOST_TEST_ASSERT_EQ(m.size(), ref.size());
+
+    auto it = m.begin();
+    for (auto const& kv : ref) {
+      BOOST_TEST_ASSERT_EQ(it->first, kv.first);
+      BOOST_TEST_ASSERT_EQ(it->second, kv.second);
+      ++it;
+    }
+  }
+
+  // built straight from parallel vectors
+  //
+  auto b = less::flat_map<unsigned, std::string>(
+      less::vector<unsigned>{3u, 1u, 2u, 1u},
+      less::vector<std::string>{"c", "a", "b", "x"});
+  BOOST_TEST(b.keys() == (less::vector<unsigned>{1u, 2u, 3u}));
+  BOOST_TEST(b.values() == (less::vector<std::string>{"a", "b", "c"}));
+  BOOST_TEST(b == (less::flat_map<unsigned, std::string>{
+                      {2u, "b"}, {1u, "a"}, {3u, "c"}}));
+
+  BOOST_TEST_THROWS((less::flat_map<unsigned, std::string>(
+                        less::vector<unsigned>{3u, 1u, 2u},
+                        less::vector<std::string>{"c", "a"})),
+                    less::out_of_range);
+  BOOST_TEST_THROWS((less::flat_multimap<unsigned, std::string>(
+                        less::vector<unsigned>{3u},
+                        less::vector<std::string>{"c", "a"})),
+                    less::out_of_range);
+}
+
+static void multimap()
+{
+  auto m = less::flat_multimap<std::string, int>();
+  m.emplace("b", 0);
+  m.emplace("a", 1);
+  m.emplace("b", 2);
+  m.insert({{"b", 3}, {"c", 4}, {"a", 5}});
+
+  BOOST_TEST_EQ(m.size(), 6u);
+  BOOST_TEST_EQ(m.count("b"), 3u);
+  BOOST_TEST(m.values() == (less::vector<int>{1, 5, 0, 2, 3, 4}));
+
+  auto range = m.equal_range("b");
+  BOOST_TEST_EQ(range.second - range.first, 3);
+  BOOST_TEST_EQ((*range.first).second, 0);
+
+  BOOST_TEST_EQ(m.erase("b"), 3u);
+  BOOST_TEST(m.values() == (less::vector<int>{1, 5, 4}));
+}
+
+static void std_algorithms()
+{
+  using map_type = less::flat_map<int, int>;
+  using traits   = std::iterator_traits<map_type::iterator>;
+  static_assert(std::is_same_v<traits::iterator_category,
+                               std::random_access_iterator_tag>);
+  static_assert(std::is_same_v<traits::difference_type, std::ptrdiff_t>);
+
+  auto m = map_type();
+  for (auto i = 0; i < 100; ++i) {
+    m.emplace(2 * i, i);
+  }
+
+  BOOST_TEST_EQ(std::distance(m.begin(), m.end()), 100);
+
+  auto const it = std::lower_bound(
+      m.begin(), m.end(), 51,
+      [](map_type::iterator::reference kv, int k) { return kv.first < k; });
+  BOOST_TEST_EQ(it.key(), 52);
+  BOOST_TEST_EQ(it.value(), 26);
+
+  auto const found = std::find_if(m.cbegin(), m.cend(), [](auto const& kv) {
+    return kv.second == 70;
+  });
+  BOOST_TEST_EQ(found - m.cbegin(), 70);
+
+  BOOST_TEST_EQ(std::count_if(m.begin(), m.end(),
+                              [](auto const& kv) { return kv.first % 4 == 0; }),
+                50);
+
+  std::for_each(m.begin(), m.end(), [](auto kv) { kv.second *= 10; });
+  BOOST_TEST_EQ(m.at(198), 990);
+
+  auto const first = m.begin();
+  auto const last  = m.end();
+  BOOST_TEST(last > first);
+  BOOST_TEST(first <= first);
+  BOOST_TEST(last >= first);
+  BOOST_TEST((3 + first) == std::next(first, 3));
+  BOOST_TEST(std::prev(last).key() == 198);
+}
+
+int main()
+{
+  basics();
+  batches();
+  multimap();
+  std_algorithms();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,138 @@
+#include "lwt_helper.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+
+#include <less/flat_set.hpp>
+
+static void lookups()
+{
+  // every size up to a few hundred, so the search sees all the ways the range
+  // can halve
+  //
+  for (auto n = 0; n < 300; ++n) {
+    auto keys = less::vector<int>();
+    for (auto i = 0; i < n; ++i) {
+      keys.push_back(2 * i);
+    }
+
+    auto const s = less::flat_set<int>(keys);
+    for (auto k = -1; k <= 2 * n; ++k) {
+      BOOST_TEST_ASSERT_EQ(s.lower_bound(k),
+                           std::lower_bound(s.begin(), s.end(), k));
+      BOOST_TEST_ASSERT_EQ(s.upper_bound(k),
+                           std::upper_bound(s.begin(), s.end(), k));
+      BOOST_TEST_ASSERT_EQ(s.contains(k), (k >= 0 && k % 2 == 0 && k < 2 * n));
+    }
+  }
+
+  auto s = less::flat_set<std::string, std::greater<>>{"b", "a", "c", "a"};
+  BOOST_TEST_EQ(s.size(), 3u);
+  BOOST_TEST_EQ(*s.begin(), "c");
+  BOOST_TEST_EQ(s.count("a"), 1u);
+  BOOST_TEST(s.find("d") == s.end());
+  BOOST_TEST_EQ(s.find("b") - s.begin(), 1);
+}
+
+static void inserts()
+{
+  auto s = less::flat_set<int>();
+
+  auto r = s.insert(5);
+  BOOST_TEST(r.second);
+  BOOST_TEST_EQ(*r.first, 5);
+
+  s.insert(1);
+  s.insert(9);
+  r = s.insert(5);
+  BOOST_TEST(!r.second);
+  BOOST_TEST_EQ(r.first - s.begin(), 1);
+  BOOST_TEST(s.keys() == (less::vector<int>{1, 5, 9}));
+
+  // a batch with duplicates, both of existing keys and among itself
+  //
+  s.insert({7, 0, 9, 3, 7, 12, 1});
+  BOOST_TEST(s.keys() == (less::vector<int>{0, 1, 3, 5, 7, 9, 12}));
+
+  BOOST_TEST_EQ(s.erase(5), 1u);
+  BOOST_TEST_EQ(s.erase(5), 0u);
+  BOOST_TEST_EQ(*s.erase(s.begin()), 1);
+  BOOST_TEST(s.keys() == (less::vector<int>{1, 3, 7, 9, 12}));
+
+  auto keys = s.extract();
+  BOOST_TEST(s.empty());
+  BOOST_TEST_EQ(keys.size(), 5u);
+}
+
+static void batches()
+{
+  auto rng = std::mt19937(1234);
+
+  auto s   = less::flat_set<unsigned>();
+  auto ref = std::set<unsigned>();
+  for (auto round = 0; round < 20; ++round) {
+    auto batch = less::vector<unsigned>();
+    for (auto i = 0; i < 500; ++i) {
+      batch.push_back(rng() % 10'000u);
+    }
+
+    s.insert(batch.begin(), batch.end());
+    ref.insert(batch.begin(), batch.end());
+    BOOST_TEST_ASSERT_EQ(s.size(), ref.size());
+    BOOST_TEST_ASSERT(std::equal(s.begin(), s.end(), ref.begin()));
+  }
+}
+
+struct entry {
+  int key;
+  int order;
+};
+
+struct by_key {
+  bool operator()(entry const& a, entry const& b) const
+  {
+    return a.key < b.key;
+  }
+};
+
+static void multiset()
+{
+  auto s = less::flat_multiset<entry, by_key>();
+  s.insert(entry{2, 0});
+  s.insert(entry{1, 1});
+  s.insert(entry{2, 2});
+
+  // batched duplicates land behind the existing ones, in insertion order
+  //
+  auto batch = less::vector<entry>{{2, 3}, {0, 4}, {2, 5}, {1, 6}};
+  s.insert(batch.begin(), batch.end());
+
+  BOOST_TEST_EQ(s.size(), 7u);
+  BOOST_TEST_EQ(s.count(entry{2, 0}), 4u);
+
+  auto const expected = less::vector<int>{4, 1, 6, 0, 2, 3, 5};
+  for (auto i = 0u; i < s.size(); ++i) {
+    BOOST_TEST_EQ(s.begin()[i].order, expected[i]);
+  }
+
+  BOOST_TEST_EQ(s.erase(entry{2, 0}), 4u);
+  BOOST_TEST_EQ(s.size(), 3u);
+
+  auto m = less::flat_multiset<int>(less::vector<int>{3, 1, 3, 2, 1});
+  BOOST_TEST(m.keys() == (less::vector<int>{1, 1, 2, 3, 3}));
+  BOOST_TEST(m == less::flat_multiset<int>({1, 3, 2, 3, 1}));
+  BOOST_TEST(m != less::flat_multiset<int>());
+}
+
+int main()
+{
+  lookups();
+  inserts();
+  batches();
+  multiset();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,147 @@
+#include "lwt_helper.hpp"
+
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <less/frozen_vector.hpp>
+
+static void freeze_in_place()
+{
+  // spare capacity holds the count, so the buffer doesn't move
+  //
+  auto v = less::vector<int>(less::with_capacity, 64u);
+  for (auto i = 0; i < 32; ++i) {
+    v.push_back(i);
+  }
+
+  auto const p = v.data();
+  auto       f = v.freeze();
+
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(v.capacity(), 0u);
+  BOOST_TEST_EQ(f.data(), p);
+  BOOST_TEST_EQ(f.size(), 32u);
+  BOOST_TEST_EQ(f.use_count(), 1u);
+  BOOST_TEST_EQ(f[5], 5);
+  BOOST_TEST_EQ(f.front(), 0);
+  BOOST_TEST_EQ(f.back(), 31);
+  BOOST_TEST_EQ(f.end() - f.begin(), 32);
+  BOOST_TEST_THROWS(f.at(32), less::out_of_range);
+
+  // sole owner: the same buffer, capacity and all, comes back
+  //
+  auto w = f.thaw();
+  BOOST_TEST(f.empty());
+  BOOST_TEST_EQ(f.use_count(), 0u);
+  BOOST_TEST_EQ(w.data(), p);
+  BOOST_TEST_EQ(w.size(), 32u);
+  BOOST_TEST_EQ(w.capacity(), 64u);
+  BOOST_TEST_EQ(w[31], 31);
+
+  w.push_back(32);
+  BOOST_TEST_EQ(w.back(), 32);
+}
+
+static void freeze_full()
+{
+  // no room left, so the elements move once into a larger buffer
+  //
+  auto v = less::vector<std::string>();
+  v.reserve(3u);
+  v.push_back("a fairly long string that won't fit the small buffer");
+  v.push_back("b");
+  v.push_back("c");
+
+  auto f = v.freeze();
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(f.size(), 3u);
+  BOOST_TEST_EQ(f[0], "a fairly long string that won't fit the small buffer");
+  BOOST_TEST_EQ(f[2], "c");
+
+  auto g = f.thaw();
+  BOOST_TEST_EQ(g.size(), 3u);
+  BOOST_TEST_GE(g.capacity(), 3u);
+  BOOST_TEST_EQ(g[1], "b");
+
+  auto e = less::vector<int>().freeze();
+  BOOST_TEST(e.empty());
+  BOOST_TEST_EQ(e.use_count(), 0u);
+  BOOST_TEST(e.thaw().empty());
+}
+
+static void sharing()
+{
+  auto f = less::vector<std::string>(100u, std::string(40, 'x')).freeze();
+
+  auto g = f;
+  BOOST_TEST_EQ(g.data(), f.data());
+  BOOST_TEST_EQ(f.use_count(), 2u);
+  BOOST_TEST(g == f);
+
+  auto h = less::frozen_vector<std::string>();
+  h      = g;
+  BOOST_TEST_EQ(f.use_count(), 3u);
+
+  auto m = std::move(h);
+  BOOST_TEST(h.empty());
+  BOOST_TEST_EQ(f.use_count(), 3u);
+
+  // shared, so thawing copies and drops only this reference
+  //
+  auto v = g.thaw();
+  BOOST_TEST(g.empty());
+  BOOST_TEST_EQ(f.use_count(), 2u);
+  BOOST_TEST_NE(v.data(), f.data());
+  BOOST_TEST_EQ(v.size(), 100u);
+
+  v[0] = "changed";
+  BOOST_TEST_EQ(f[0], std::string(40, 'x'));
+  BOOST_TEST(less::vector<std::string>(f.begin(), f.end()) != v);
+
+  m = less::frozen_vector<std::string>();
+  BOOST_TEST_EQ(f.use_count(), 1u);
+}
+
+static void fan_out()
+{
+  auto const n = 1u << 16;
+
+  auto v = less::vector<unsigned>(less::default_init, n);
+  for (auto i = 0u; i < n; ++i) {
+    v[i] = i;
+  }
+
+  auto f = v.freeze();
+
+  auto sums    = less::vector<unsigned long long>(8u);
+  auto threads = less::vector<std::thread>();
+  threads.reserve(8u);
+  for (auto t = 0u; t < 8u; ++t) {
+    threads.emplace_back([&sums, t, copy = f]() {
+      auto local = copy;
+      for (auto x : local) {
+        sums[t] += x;
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (auto s : sums) {
+    BOOST_TEST_EQ(s, (unsigned long long)n * (n - 1) / 2);
+  }
+  BOOST_TEST_EQ(f.use_count(), 1u);
+}
+
+int main()
+{
+  freeze_in_place();
+  freeze_full();
+  sharing();
+  fan_out();
+
+  return boost::report_errors();
+}
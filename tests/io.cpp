@@ -0,0 +1,146 @@
+#include "lwt_helper.hpp"
+
+// small enough that a test file spans a few parallel chunks
+//
+#define LESS_PARALLEL_READ_GRAIN (1u << 12)
+
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+
+#include <less/thread_pool.hpp>
+#include <less/io.hpp>
+
+struct temp_file {
+  char path[32] = "/tmp/less_io_XXXXXX";
+  int  fd       = -1;
+
+  temp_file()
+  {
+    fd = mkstemp(path);
+  }
+
+  ~temp_file()
+  {
+    close(fd);
+    unlink(path);
+  }
+};
+
+static auto pattern(less::unsigned_long_type size) -> less::vector<char>
+{
+  auto v = less::vector<char>(less::default_init, size);
+  for (auto i = 0u; i < size; ++i) {
+    v[i] = static_cast<char>('a' + i % 26);
+  }
+  return v;
+}
+
+static void write_all(int fd, less::vector<char> const& v)
+{
+  auto p = v.data();
+  auto n = v.size();
+  while (n > 0) {
+    auto const r = write(fd, p, n);
+    if (r <= 0) { return; }
+    p += r;
+    n -= static_cast<less::unsigned_long_type>(r);
+  }
+}
+
+static void regular_file()
+{
+  for (auto const size : {0u, 1u, 511u, 512u, 4096u, 100'000u, 1u << 20}) {
+    auto       tmp      = temp_file();
+    auto const expected = pattern(size);
+    write_all(tmp.fd, expected);
+
+    auto const v = less::read_file(tmp.path);
+    BOOST_TEST_EQ(v.size(), size);
+    BOOST_TEST(v == expected);
+  }
+}
+
+static void file_offset()
+{
+  auto       tmp      = temp_file();
+  auto const expected = pattern(50'000);
+  write_all(tmp.fd, expected);
+
+  // reads start at the current offset and leave it at the end
+  //
+  lseek(tmp.fd, 1000, SEEK_SET);
+
+  auto v = less::vector<char>{'x', 'y'};
+  less::read_all(tmp.fd, v);
+  BOOST_TEST_EQ(v.size(), 2u + 49'000u);
+  BOOST_TEST_EQ(v[0], 'x');
+  BOOST_TEST_EQ(v[2], expected[1000]);
+  BOOST_TEST_EQ(v.back(), expected.back());
+  BOOST_TEST_EQ(lseek(tmp.fd, 0, SEEK_CUR), 50'000);
+
+  auto const rest = less::read_all(tmp.fd);
+  BOOST_TEST(rest.empty());
+}
+
+static void pipe_input()
+{
+  int fds[2];
+  BOOST_TEST_ASSERT_EQ(pipe(fds), 0);
+
+  auto const expected = pattern(300'000);
+
+  auto writer = std::thread([&] {
+    write_all(fds[1], expected);
+    close(fds[1]);
+  });
+
+  auto const v = less::read_all<unsigned char>(fds[0]);
+  writer.join();
+  close(fds[0]);
+
+  BOOST_TEST_EQ(v.size(), expected.size());
+  BOOST_TEST_EQ(std::memcmp(v.data(), expected.data(), v.size()), 0);
+}
+
+static void procfs()
+{
+  // procfs files report a size of zero but still have contents
+  //
+  auto const v = less::read_file("/proc/self/status");
+  BOOST_TEST_GT(v.size(), 0u);
+  BOOST_TEST_EQ(std::memcmp(v.data(), "Name:", 5), 0);
+}
+
+static void errors()
+{
+  BOOST_TEST_THROWS(less::read_file("/nonexistent/less/io"),
+                    less::system_error);
+
+  // reading a directory fails with EISDIR and leaves the vector alone
+  //
+  auto const fd = open("/tmp", O_RDONLY | O_DIRECTORY);
+  auto       v  = less::vector<char>{'a', 'b', 'c'};
+  try {
+    less::read_all(fd, v);
+    BOOST_TEST(false);
+  }
+  catch (less::system_error const& e) {
+    BOOST_TEST_EQ(e.code, EISDIR);
+  }
+  close(fd);
+  BOOST_TEST_EQ(v.size(), 3u);
+  BOOST_TEST_EQ(v[2], 'c');
+}
+
+int main()
+{
+  regular_file();
+  file_offset();
+  pipe_input();
+  procfs();
+  errors();
+
+  return boost::report_errors();
+}
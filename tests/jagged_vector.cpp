@@ -0,0 +1,178 @@
+#include "lwt_helper.hpp"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <less/jagged_vector.hpp>
+
+template <class T>
+static auto row_of(less::jagged_vector<T> const& v, less::unsigned_long_type i)
+    -> less::vector<T>
+{
+  auto const r = v[i];
+  return less::vector<T>(r.begin(), r.end());
+}
+
+static void rows()
+{
+  auto v = less::jagged_vector<std::uint32_t>();
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(v.offsets().size(), 1u);
+
+  v.push_back_row({1u, 2u, 3u});
+  v.push_back_row();
+  auto const extra = less::vector<std::uint32_t>{4u, 5u};
+  v.push_back_row(extra);
+  v.push_back(6u);
+
+  BOOST_TEST_EQ(v.rows(), 3u);
+  BOOST_TEST_EQ(v.value_count(), 6u);
+  BOOST_TEST(row_of(v, 0) == (less::vector<std::uint32_t>{1u, 2u, 3u}));
+  BOOST_TEST(v[1].empty());
+  BOOST_TEST(row_of(v, 2) == (less::vector<std::uint32_t>{4u, 5u, 6u}));
+  BOOST_TEST(v.offsets() == (less::vector<less::unsigned_long_type>{
+                                0u, 3u, 3u, 6u}));
+  BOOST_TEST_EQ(v.back().back(), 6u);
+  BOOST_TEST_THROWS(v.at(3), less::out_of_range);
+
+  // rows are mutable in place
+  //
+  for (auto& x : v[0]) {
+    x *= 10;
+  }
+  BOOST_TEST_EQ(v[0][2], 30u);
+
+  // a row of the vector itself, copied before the values can move
+  //
+  for (auto i = 0; i < 10; ++i) {
+    v.push_back_row(v[0]);
+  }
+  BOOST_TEST_EQ(v.rows(), 13u);
+  BOOST_TEST(row_of(v, 12) == row_of(v, 0));
+
+  v.clear();
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(v.value_count(), 0u);
+}
+
+static void build()
+{
+  auto pairs = less::vector<std::pair<std::uint32_t, std::string>>{
+      {2u, "c0"}, {0u, "a0"}, {2u, "c1"}, {0u, "a1"}, {3u, "d0"}};
+
+  auto v = less::jagged_vector<std::string>::build(5u, pairs.begin(),
+                                                    pairs.end());
+  BOOST_TEST_EQ(v.rows(), 5u);
+  BOOST_TEST(row_of(v, 0) == (less::vector<std::string>{"a0", "a1"}));
+  BOOST_TEST(v[1].empty());
+  BOOST_TEST(row_of(v, 2) == (less::vector<std::string>{"c0", "c1"}));
+  BOOST_TEST(row_of(v, 3) == (less::vector<std::string>{"d0"}));
+  BOOST_TEST(v[4].empty());
+
+  auto bad = less::vector<std::pair<int, int>>{{0, 1}, {7, 2}};
+  BOOST_TEST_THROWS(
+      less::jagged_vector<int>::build(2u, bad.begin(), bad.end()),
+      less::out_of_range);
+
+  // an edge list turned into adjacency lists
+  //
+  auto rng   = std::mt19937(1234);
+  auto edges = less::vector<std::pair<std::uint32_t, std::uint32_t>>();
+  for (auto i = 0u; i < 10'000u; ++i) {
+    edges.emplace_back(rng() % 500u, i);
+  }
+
+  auto g = less::jagged_vector<std::uint32_t>::build(500u, edges.begin(),
+                                                     edges.end());
+  BOOST_TEST_EQ(g.value_count(), 10'000u);
+
+  auto expected = less::jagged_vector<std::uint32_t>();
+  for (auto r = 0u; r < 500u; ++r) {
+    expected.push_back_row();
+    for (auto const& e : edges) {
+      if (e.first == r) { expected.push_back(e.second); }
+    }
+  }
+  BOOST_TEST(g == expected);
+}
+
+static void edits()
+{
+  auto v = less::jagged_vector<int>();
+  for (auto r = 0; r < 5; ++r) {
+    v.push_back_row();
+    for (auto i = 0; i < 6; ++i) {
+      v.push_back(r * 10 + i);
+    }
+  }
+
+  BOOST_TEST_EQ(v.erase_row_if(1, [](int x) { return x % 2 == 1; }), 3u);
+  v.truncate_row(3, 2);
+  v.clear_row(0);
+  BOOST_TEST_EQ(v.slack(), 13u);
+  BOOST_TEST_EQ(v.value_count(), 17u);
+
+  BOOST_TEST(v[0].empty());
+  BOOST_TEST(row_of(v, 1) == (less::vector<int>{10, 12, 14}));
+  BOOST_TEST(row_of(v, 3) == (less::vector<int>{30, 31}));
+
+  // edits to the last row don't leave slack
+  //
+  v.truncate_row(4, 3);
+  v.push_back(99);
+  v.push_back_row({7, 8});
+  BOOST_TEST_EQ(v.slack(), 13u);
+  BOOST_TEST(row_of(v, 4) == (less::vector<int>{40, 41, 42, 99}));
+
+  auto const before = v;
+  v.compact();
+  BOOST_TEST_EQ(v.slack(), 0u);
+  BOOST_TEST_EQ(v.values().size(), v.value_count());
+  BOOST_TEST(v == before);
+  BOOST_TEST(v.offsets() == (less::vector<less::unsigned_long_type>{
+                                0u, 0u, 3u, 9u, 11u, 15u, 17u}));
+
+  v.pop_back_row();
+  BOOST_TEST_EQ(v.rows(), 5u);
+  BOOST_TEST_EQ(v.values().size(), 15u);
+
+  // popping hands the new last row's slack back, so values removed from it
+  // don't reappear on the next append
+  //
+  auto w = less::jagged_vector<int>();
+  w.push_back_row({1, 2, 3});
+  w.push_back_row({4});
+  w.truncate_row(0, 1);
+  BOOST_TEST_EQ(w.slack(), 2u);
+  w.pop_back_row();
+  BOOST_TEST_EQ(w.slack(), 0u);
+  w.push_back(9);
+  BOOST_TEST(row_of(w, 0) == (less::vector<int>{1, 9}));
+  BOOST_TEST_EQ(w.slack(), 0u);
+  BOOST_TEST_EQ(w.values().size(), 2u);
+
+  w.push_back_row({5, 6});
+  w.push_back_row({7});
+  w.clear_row(1);
+  w.pop_back_row();
+  w.push_back(8);
+  BOOST_TEST(row_of(w, 0) == (less::vector<int>{1, 9}));
+  BOOST_TEST(row_of(w, 1) == (less::vector<int>{8}));
+  BOOST_TEST_EQ(w.value_count(), 3u);
+
+  w.pop_back_row();
+  w.pop_back_row();
+  BOOST_TEST(w.empty());
+  BOOST_TEST(w.values().empty());
+}
+
+int main()
+{
+  rows();
+  build();
+  edits();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,255 @@
+#include "lwt_helper.hpp"
+
+#include <cstdlib>
+#include <utility>
+#include <unistd.h>
+
+#include <less/mapped_vector.hpp>
+
+struct point {
+  int    x;
+  double y;
+};
+
+struct temp_path {
+  char path[32] = "/tmp/less_mapped_XXXXXX";
+
+  temp_path()
+  {
+    auto const fd = mkstemp(path);
+    close(fd);
+    unlink(path);
+  }
+
+  ~temp_path()
+  {
+    unlink(path);
+  }
+};
+
+static void create()
+{
+  auto tmp = temp_path();
+
+  auto v = less::mapped_vector<int>(tmp.path);
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(v.size(), 0u);
+  BOOST_TEST_GT(v.capacity(), 0u);
+  BOOST_TEST_NE(v.data(), nullptr);
+  BOOST_TEST(v.begin() == v.end());
+}
+
+static void push_back_and_reopen()
+{
+  auto tmp = temp_path();
+
+  auto const size = 100'000u;
+  {
+    auto v = less::mapped_vector<unsigned>(tmp.path);
+    for (auto i = 0u; i < size; ++i) {
+      v.push_back(i);
+    }
+
+    BOOST_TEST_EQ(v.size(), size);
+    BOOST_TEST_GE(v.capacity(), size);
+    BOOST_TEST_EQ(v.front(), 0u);
+    BOOST_TEST_EQ(v.back(), size - 1);
+
+    // growing while pushing one of our own elements
+    //
+    while (v.size() < v.capacity()) {
+      v.push_back(v.back() + 1);
+    }
+    v.push_back(v[0]);
+    BOOST_TEST_EQ(v.back(), 0u);
+    v.pop_back();
+
+    v.resize(size);
+    v.flush();
+  }
+
+  auto v = less::mapped_vector<unsigned>(tmp.path);
+  BOOST_TEST_ASSERT_EQ(v.size(), size);
+  for (auto i = 0u; i < size; ++i) {
+    BOOST_TEST_ASSERT_EQ(v[i], i);
+  }
+  BOOST_TEST_EQ(v.at(size - 1), size - 1);
+  BOOST_TEST_THROWS(v.at(size), less::out_of_range);
+}
+
+static void resize_and_reserve()
+{
+  auto tmp = temp_path();
+
+  auto v = less::mapped_vector<point>(tmp.path);
+
+  v.reserve(1000);
+  BOOST_TEST_EQ(v.capacity(), 1000u);
+  BOOST_TEST(v.empty());
+
+  v.resize(10, point{1, 2.0});
+  BOOST_TEST_EQ(v.size(), 10u);
+  for (auto const& p : v) {
+    BOOST_TEST_ASSERT_EQ(p.x, 1);
+    BOOST_TEST_ASSERT_EQ(p.y, 2.0);
+  }
+
+  v.resize(5);
+  v.resize(8);
+  BOOST_TEST_EQ(v[4].x, 1);
+  BOOST_TEST_EQ(v[5].x, 0);
+  BOOST_TEST_EQ(v[7].y, 0.0);
+
+  v.resize(less::default_init, 5000);
+  BOOST_TEST_EQ(v.size(), 5000u);
+  BOOST_TEST_GE(v.capacity(), 5000u);
+  BOOST_TEST_EQ(v[4999].x, 0);
+
+  auto& p = v.emplace_back(point{7, 8.0});
+  BOOST_TEST_EQ(p.x, 7);
+  BOOST_TEST_EQ(v.size(), 5001u);
+
+  v.shrink_to_fit();
+  BOOST_TEST_EQ(v.capacity(), 5001u);
+  BOOST_TEST_EQ(v.back().x, 7);
+
+  v.clear();
+  BOOST_TEST(v.empty());
+  v.shrink_to_fit();
+  BOOST_TEST_EQ(v.capacity(), 0u);
+
+  v.push_back(point{3, 4.0});
+  BOOST_TEST_EQ(v.size(), 1u);
+  BOOST_TEST_EQ(v[0].x, 3);
+}
+
+static void move_and_swap()
+{
+  auto tmp1 = temp_path();
+  auto tmp2 = temp_path();
+
+  auto v1 = less::mapped_vector<int>(tmp1.path);
+  v1.push_back(1);
+
+  auto v2 = less::mapped_vector<int>(tmp2.path);
+  v2.push_back(2);
+  v2.push_back(3);
+
+  v1.swap(v2);
+  BOOST_TEST_EQ(v1.size(), 2u);
+  BOOST_TEST_EQ(v2.size(), 1u);
+  BOOST_TEST_EQ(v2[0], 1);
+
+  auto v3 = std::move(v1);
+  BOOST_TEST_EQ(v3.size(), 2u);
+  BOOST_TEST_EQ(v1.size(), 0u);
+  BOOST_TEST_EQ(v1.data(), nullptr);
+
+  v3 = std::move(v2);
+  BOOST_TEST_EQ(v3.size(), 1u);
+  BOOST_TEST_EQ(v3[0], 1);
+}
+
+static void format_mismatch()
+{
+  auto tmp = temp_path();
+  {
+    auto v = less::mapped_vector<int>(tmp.path);
+    v.push_back(1);
+  }
+
+  BOOST_TEST_THROWS(less::mapped_vector<double>(tmp.path), less::format_error);
+
+  auto v = less::mapped_vector<unsigned>(tmp.path);
+  BOOST_TEST_EQ(v.size(), 1u);
+
+  BOOST_TEST_THROWS(less::mapped_vector<int>("/nonexistent/dir/file"),
+                    less::system_error);
+}
+
+static void memfd_snapshots()
+{
+  auto v = less::mapped_vector<unsigned>(less::memfd);
+  BOOST_TEST(v.empty());
+
+  v.resize(less::default_init, 100000u);
+  for (auto i = 0u; i < v.size(); ++i) {
+    v[i] = i;
+  }
+
+  auto s1 = v.snapshot();
+  BOOST_TEST_EQ(s1.size(), 100000u);
+  BOOST_TEST_NE(s1.data(), v.data());
+  BOOST_TEST_EQ(s1[77777], 77777u);
+
+  // later writes, growth included, don't reach the snapshot
+  //
+  v[5]     = 0xdeadbeef;
+  v[99999] = 1u;
+  for (auto i = 0u; i < 50000u; ++i) {
+    v.push_back(i);
+  }
+
+  BOOST_TEST_EQ(s1.size(), 100000u);
+  BOOST_TEST_EQ(s1[5], 5u);
+  BOOST_TEST_EQ(s1.back(), 99999u);
+  BOOST_TEST_THROWS(s1.at(100000u), less::out_of_range);
+
+  // s1 is alive, so this one moves the vector to a new file
+  //
+  auto s2 = v.snapshot();
+  v[5]    = 6u;
+  BOOST_TEST_EQ(s2.size(), 150000u);
+  BOOST_TEST_EQ(s2[5], 0xdeadbeefu);
+  BOOST_TEST_EQ(s2[149999], 49999u);
+  BOOST_TEST_EQ(s1[5], 5u);
+
+  s1 = decltype(s1)();
+  BOOST_TEST(s1.empty());
+
+  // with s2 gone only the modified pages go back to the file
+  //
+  s2 = decltype(s2)();
+  v[100] = 7u;
+
+  auto s3 = v.snapshot();
+  BOOST_TEST_EQ(s3.size(), 150000u);
+  BOOST_TEST_EQ(s3[5], 6u);
+  BOOST_TEST_EQ(s3[100], 7u);
+  BOOST_TEST_EQ(s3[99999], 1u);
+  BOOST_TEST_EQ(s3[100000], 0u);
+
+  auto ok = true;
+  for (auto i = 0u; i < 150000u; ++i) {
+    ok = ok && (s3[i] == v[i]);
+  }
+  BOOST_TEST(ok);
+
+  // shrinking leaves the file alone while snapshots may map it
+  //
+  v.resize(10u);
+  v.shrink_to_fit();
+  BOOST_TEST_EQ(s3[149999], 49999u);
+
+  // snapshots outlive the vector
+  //
+  auto moved = less::mapped_vector<unsigned>(std::move(v));
+  moved      = less::mapped_vector<unsigned>(less::memfd);
+  BOOST_TEST_EQ(s3[123456], 23456u);
+
+  auto tmp = temp_path();
+  auto f   = less::mapped_vector<int>(tmp.path);
+  BOOST_TEST_THROWS(f.snapshot(), less::system_error);
+}
+
+int main()
+{
+  create();
+  push_back_and_reopen();
+  resize_and_reserve();
+  move_and_swap();
+  format_mismatch();
+  memfd_snapshots();
+
+  return boost::report_errors();
+}
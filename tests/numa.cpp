@@ -0,0 +1,146 @@
+#include "lwt_helper.hpp"
+
+#include <less/numa.hpp>
+
+static auto first_node() -> less::unsigned_long_type
+{
+  auto const nodes = less::numa::allowed_nodes();
+  for (auto node = 0u; node < less::numa::max_nodes; ++node) {
+    if (nodes.test(node)) { return node; }
+  }
+  return 0;
+}
+
+static auto total_pages(less::numa::page_distribution const& dist)
+    -> less::unsigned_long_type
+{
+  auto n = dist.not_present + dist.failed;
+  for (auto const pages : dist.pages_per_node) {
+    n += pages;
+  }
+  return n;
+}
+
+static constexpr less::unsigned_long_type const size = 1u << 20;
+
+static void allowed_nodes()
+{
+  auto const nodes = less::numa::allowed_nodes();
+  BOOST_TEST_GE(nodes.count(), 1u);
+  BOOST_TEST_EQ(less::numa::node_count(), nodes.count());
+  BOOST_TEST(nodes.test(first_node()));
+
+  auto mask = less::numa::node_mask();
+  BOOST_TEST(mask.empty());
+  mask.set(70);
+  BOOST_TEST(mask.test(70));
+  BOOST_TEST_NOT(mask.test(6));
+  BOOST_TEST_EQ(mask.count(), 1u);
+
+  mask.set(less::numa::max_nodes - 1);
+  BOOST_TEST_EQ(mask.count(), 2u);
+  BOOST_TEST_THROWS(mask.set(less::numa::max_nodes), less::out_of_range);
+  BOOST_TEST_THROWS((void)mask.test(less::numa::max_nodes),
+                    less::out_of_range);
+  BOOST_TEST_THROWS(less::numa::policy::bind(less::numa::max_nodes),
+                    less::out_of_range);
+}
+
+static void empty_distribution()
+{
+  auto v    = less::vector<int>();
+  auto dist = less::numa::distribution(v);
+  BOOST_TEST(dist.pages_per_node.empty());
+  BOOST_TEST_EQ(dist.not_present, 0u);
+
+  less::numa::apply(v, less::numa::policy::interleave());
+}
+
+static void untouched_pages()
+{
+  auto v    = less::vector<int>(less::default_init, size);
+  auto dist = less::numa::distribution(v);
+
+  // the allocator may have written its bookkeeping into the first and last
+  // pages
+  //
+  auto const pages = total_pages(dist);
+  BOOST_TEST_GE(pages, size * sizeof(int) / 4096);
+  BOOST_TEST_GE(dist.not_present + 2, pages);
+}
+
+static void bind()
+{
+  auto const node = first_node();
+
+  auto v = less::vector<int>(less::with_capacity, size);
+  less::numa::apply(v, less::numa::policy::bind(node));
+  v.resize(size, 1);
+
+  auto const dist = less::numa::distribution(v);
+  BOOST_TEST_EQ(dist.not_present, 0u);
+  BOOST_TEST_EQ(dist.failed, 0u);
+  BOOST_TEST_ASSERT_GT(dist.pages_per_node.size(), node);
+  BOOST_TEST_EQ(dist.pages_per_node[node], total_pages(dist));
+}
+
+static void interleave()
+{
+  auto const nodes = less::numa::allowed_nodes();
+
+  auto v = less::vector<int>(less::with_capacity, size);
+  less::numa::apply(v, less::numa::policy::interleave(nodes));
+  v.resize(size, 1);
+
+  auto const dist = less::numa::distribution(v);
+  BOOST_TEST_EQ(dist.not_present, 0u);
+  BOOST_TEST_EQ(dist.failed, 0u);
+
+  // round-robin placement leaves every allowed node with a share of the pages
+  //
+  auto const share = total_pages(dist) / nodes.count();
+  for (auto node = 0u; node < dist.pages_per_node.size(); ++node) {
+    if (!nodes.test(node)) {
+      BOOST_TEST_EQ(dist.pages_per_node[node], 0u);
+      continue;
+    }
+    BOOST_TEST_GE(dist.pages_per_node[node] + 1, share);
+  }
+
+  // migrating back to a single node moves the pages that already exist
+  //
+  auto const node = first_node();
+  less::numa::apply(v, less::numa::policy::bind(node));
+
+  auto const moved = less::numa::distribution(v);
+  BOOST_TEST_EQ(moved.pages_per_node[node], total_pages(moved));
+}
+
+static void scoped_policy()
+{
+  auto const node = first_node();
+  {
+    auto guard = less::numa::scoped_policy(less::numa::policy::preferred(node));
+
+    auto v = less::vector<int>(size, 1);
+
+    auto const dist = less::numa::distribution(v);
+    BOOST_TEST_EQ(dist.not_present, 0u);
+    BOOST_TEST_EQ(dist.pages_per_node[node], total_pages(dist));
+  }
+
+  auto v = less::vector<int>(size, 1);
+  BOOST_TEST_EQ(less::numa::distribution(v).not_present, 0u);
+}
+
+int main()
+{
+  allowed_nodes();
+  empty_distribution();
+  untouched_pages();
+  bind();
+  interleave();
+  scoped_policy();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,223 @@
+#include "lwt_helper.hpp"
+
+// a few workers even on small machines and chunks small enough that the
+// sizes below are split many ways
+//
+#define LESS_THREAD_POOL_SIZE 4
+#define LESS_PARALLEL_MIN_GRAIN 64u
+#define LESS_PARALLEL_SORT_MIN_GRAIN 256u
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include <less/parallel.hpp>
+
+static void pool()
+{
+  auto& pool = less::default_thread_pool();
+  BOOST_TEST_EQ(pool.size(), 4u);
+
+  // tasks posted from within tasks go to the worker's own deque and get
+  // stolen from there
+  //
+  auto done = std::atomic<int>{0};
+  {
+    auto p = less::thread_pool(3);
+    for (auto i = 0; i < 20; ++i) {
+      p.post([&] {
+        for (auto j = 0; j < 50; ++j) {
+          p.post([&] { ++done; });
+        }
+        ++done;
+      });
+    }
+  }
+  BOOST_TEST_EQ(done.load(), 20 * 51);
+
+  // deques grow past their initial size
+  //
+  done = 0;
+  {
+    auto p = less::thread_pool(2);
+    p.post([&] {
+      for (auto j = 0; j < 5000; ++j) {
+        p.post([&] { ++done; });
+      }
+    });
+  }
+  BOOST_TEST_EQ(done.load(), 5000);
+}
+
+static void for_each()
+{
+  auto v = less::vector<int>(10'000u, 1);
+  less::parallel_for(v, [](int& x) { x *= 3; });
+  BOOST_TEST(std::all_of(v.begin(), v.end(), [](int x) { return x == 3; }));
+
+  auto hits = less::vector<std::atomic<int>>(less::unsigned_long_type{5000});
+  less::parallel_for(100u, 5000u, [&](less::unsigned_long_type i) {
+    hits[i].fetch_add(1);
+  });
+  for (auto i = 0u; i < hits.size(); ++i) {
+    BOOST_TEST_ASSERT_EQ(hits[i].load(), i < 100 ? 0 : 1);
+  }
+
+  // an explicit grain of one element
+  //
+  auto threads = less::vector<std::atomic<int>>(less::unsigned_long_type{8});
+  less::parallel_for(0u, 8u, 1u, [&](less::unsigned_long_type i) {
+    threads[i] = 1;
+  });
+  for (auto const& t : threads) {
+    BOOST_TEST_EQ(t.load(), 1);
+  }
+
+  less::parallel_for(5u, 5u, [](less::unsigned_long_type) { throw 1; });
+
+  // exceptions reach the caller
+  //
+  BOOST_TEST_THROWS(less::parallel_for(0u, 10'000u,
+                                       [](less::unsigned_long_type i) {
+                                         if (i == 7777) { throw 7; }
+                                       }),
+                    int);
+}
+
+static void transform_reduce()
+{
+  auto v = less::vector<int>();
+  for (auto i = 0; i < 20'000; ++i) {
+    v.push_back(i);
+  }
+
+  auto const squares =
+      less::parallel_transform(v, [](int x) { return 1ll * x * x; });
+  BOOST_TEST_EQ(squares.size(), v.size());
+  for (auto i = 0u; i < v.size(); ++i) {
+    BOOST_TEST_ASSERT_EQ(squares[i], 1ll * i * i);
+  }
+
+  auto const strings =
+      less::parallel_transform(v, [](int x) { return std::to_string(x); });
+  BOOST_TEST_EQ(strings[12345], "12345");
+
+  BOOST_TEST_EQ(less::parallel_reduce(v, 0ll, [](long long acc, long long x) {
+                  return acc + x;
+                }),
+                19'999ll * 20'000 / 2);
+  BOOST_TEST_EQ(less::parallel_reduce(v, -1, [](int a, int b) {
+                  return a < b ? b : a;
+                }),
+                19'999);
+  BOOST_TEST_EQ(less::parallel_reduce(squares, 0ll),
+                19'999ll * 20'000 * 39'999 / 6);
+  BOOST_TEST_EQ(less::parallel_reduce(less::vector<int>(), 5), 5);
+
+  // partial results are combined in order
+  //
+  auto const letters = less::parallel_transform(
+      v, [](int x) { return std::string(1, static_cast<char>('a' + x % 26)); });
+  auto const joined =
+      less::parallel_reduce(letters, std::string(), std::plus<>());
+  BOOST_TEST_EQ(joined.size(), v.size());
+  for (auto i = 0u; i < joined.size(); ++i) {
+    BOOST_TEST_ASSERT_EQ(joined[i], static_cast<char>('a' + i % 26));
+  }
+
+  // the element and result types differ, and the transform isn't applied
+  // to partial results
+  //
+  auto const twos = less::vector<int>(less::unsigned_long_type{100'000}, 2);
+  BOOST_TEST_EQ(less::parallel_transform_reduce(
+                    twos, 0ll, std::plus<>(),
+                    [](int x) { return 1ll * x * x; }),
+                400'000ll);
+
+  BOOST_TEST_EQ(less::parallel_transform_reduce(
+                    strings, less::unsigned_long_type{0}, std::plus<>(),
+                    [](std::string const& s) { return s.size(); }),
+                10u * 1 + 90u * 2 + 900u * 3 + 9'000u * 4 + 10'000u * 5);
+  // `init` is folded in once, not once per chunk
+  //
+  BOOST_TEST_EQ(less::parallel_transform_reduce(
+                    twos, 5ll, std::plus<>(),
+                    [](int x) { return 1ll * x * x; }),
+                400'005ll);
+  BOOST_TEST_EQ(less::parallel_reduce(v, 1'000'000ll,
+                                      [](long long a, long long b) {
+                                        return a + b;
+                                      }),
+                1'000'000ll + 19'999ll * 20'000 / 2);
+
+  // a result type that can only be moved
+  //
+  auto const total = less::parallel_transform_reduce(
+      twos, std::make_unique<long long>(3),
+      [](std::unique_ptr<long long> a, std::unique_ptr<long long> b) {
+        *a += *b;
+        return a;
+      },
+      [](int x) { return std::make_unique<long long>(x); });
+  BOOST_TEST_EQ(*total, 200'003ll);
+
+  // partial results built before a throw are destroyed
+  //
+  BOOST_TEST_THROWS(less::parallel_transform_reduce(
+                        v, std::string(), std::plus<>(),
+                        [](int x) {
+                          if (x == 15'000) { throw 1; }
+                          return std::string(40, 'x');
+                        }),
+                    int);
+
+  BOOST_TEST_EQ(less::parallel_transform_reduce(
+                    less::vector<std::string>(), 7, std::plus<>(),
+                    [](std::string const& s) { return int(s.size()); }),
+                7);
+}
+
+static void sort()
+{
+  auto rng = std::mt19937(1234);
+
+  for (auto n : {0u, 1u, 100u, 1000u, 4097u, 100'000u, 250'001u}) {
+    auto v = less::vector<unsigned>(less::default_init, n);
+    for (auto& x : v) {
+      x = rng() % 1000;
+    }
+
+    auto expected = v;
+    std::sort(expected.begin(), expected.end());
+
+    less::parallel_sort(v);
+    BOOST_TEST(v == expected);
+
+    less::parallel_sort(v, std::greater<>());
+    std::reverse(expected.begin(), expected.end());
+    BOOST_TEST(v == expected);
+  }
+
+  auto s = less::vector<std::string>();
+  for (auto i = 0u; i < 30'000; ++i) {
+    s.push_back("a long enough prefix to allocate " + std::to_string(rng()));
+  }
+  auto expected = s;
+  std::sort(expected.begin(), expected.end());
+
+  less::parallel_sort(s.data(), s.data() + s.size());
+  BOOST_TEST(s == expected);
+}
+
+int main()
+{
+  pool();
+  for_each();
+  transform_reduce();
+  sort();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,263 @@
+#include "lwt_helper.hpp"
+
+// keep chunks small so the tests below actually exercise the thread pool
+//
+#define LESS_PARALLEL_THRESHOLD 256
+
+#include <atomic>
+#include <iterator>
+#include <less/thread_pool.hpp>
+
+static std::atomic<int> live{0};
+static std::atomic<int> countdown{-1};
+
+struct counted {
+  int x_ = 0;
+
+  counted()
+  {
+    this->tick();
+  }
+
+  counted(int x)
+      : x_(x)
+  {
+    this->tick();
+  }
+
+  counted(counted const& rhs)
+      : x_(rhs.x_)
+  {
+    this->tick();
+  }
+
+  ~counted()
+  {
+    --live;
+  }
+
+  auto operator=(counted const& rhs) -> counted& = default;
+
+ private:
+  void tick()
+  {
+    if (countdown.fetch_sub(1) == 0) { throw 42; }
+    ++live;
+  }
+};
+
+static constexpr unsigned const size = 100'000;
+
+static void fill_construct()
+{
+  {
+    auto v = less::vector<int>(size, 1337);
+    BOOST_TEST_EQ(v.size(), size);
+    for (auto const x : v) {
+      BOOST_TEST_ASSERT_EQ(x, 1337);
+    }
+  }
+
+  {
+    auto v = less::vector<int>(size);
+    BOOST_TEST_EQ(v.size(), size);
+    for (auto const x : v) {
+      BOOST_TEST_ASSERT_EQ(x, 0);
+    }
+  }
+}
+
+static void copy_construct()
+{
+  auto v = less::vector<int>(less::with_capacity, size);
+  for (auto i = 0u; i < size; ++i) {
+    v.push_back(static_cast<int>(i));
+  }
+
+  auto v2 = v;
+  BOOST_TEST_EQ(v2.size(), size);
+  BOOST_TEST(v2 == v);
+
+  auto v3 = less::vector<int>(v.begin(), v.end());
+  BOOST_TEST(v3 == v);
+}
+
+static void nested_copy_construct()
+{
+  auto inner = less::vector<int>(size / 10, 7);
+  auto outer = less::vector<less::vector<int>>(64, inner);
+
+  auto copy = outer;
+  BOOST_TEST_EQ(copy.size(), 64u);
+  for (auto const& v : copy) {
+    BOOST_TEST_ASSERT(v == inner);
+  }
+}
+
+static void assign()
+{
+  auto v = less::vector<int>();
+
+  v.assign(size, 1);
+  BOOST_TEST_EQ(v.size(), size);
+  BOOST_TEST_EQ(v[size - 1], 1);
+
+  v.assign(size / 2, 2);
+  BOOST_TEST_EQ(v.size(), size / 2);
+  for (auto const x : v) {
+    BOOST_TEST_ASSERT_EQ(x, 2);
+  }
+
+  v.reserve(size);
+  v.assign(size, 3);
+  BOOST_TEST_EQ(v.size(), size);
+  for (auto const x : v) {
+    BOOST_TEST_ASSERT_EQ(x, 3);
+  }
+
+  auto src = less::vector<int>(less::with_capacity, 2 * size);
+  for (auto i = 0u; i < 2 * size; ++i) {
+    src.push_back(static_cast<int>(i));
+  }
+
+  v.assign(src.begin(), src.end());
+  BOOST_TEST(v == src);
+
+  v.assign(src.begin() + size / 4, src.begin() + size);
+  BOOST_TEST_EQ(v.size(), size - size / 4);
+  BOOST_TEST_EQ(v[0], static_cast<int>(size / 4));
+  BOOST_TEST_EQ(v.back(), static_cast<int>(size - 1));
+}
+
+static void resize()
+{
+  auto v = less::vector<int>();
+
+  v.resize(size);
+  BOOST_TEST_EQ(v.size(), size);
+  for (auto const x : v) {
+    BOOST_TEST_ASSERT_EQ(x, 0);
+  }
+
+  v.resize(2 * size, 5);
+  BOOST_TEST_EQ(v.size(), 2 * size);
+  BOOST_TEST_EQ(v[size - 1], 0);
+  for (auto i = size; i < 2 * size; ++i) {
+    BOOST_TEST_ASSERT_EQ(v[i], 5);
+  }
+
+  v.resize(size / 2);
+  v.resize(size, 6);
+  BOOST_TEST_EQ(v.size(), size);
+  BOOST_TEST_EQ(v[size / 2 - 1], 0);
+  BOOST_TEST_EQ(v[size / 2], 6);
+}
+
+static void construct_throws()
+{
+  live      = 0;
+  countdown = size / 2;
+
+  BOOST_TEST_THROWS((less::vector<counted>(size, counted(1))), int);
+  BOOST_TEST_EQ(live.load(), 0);
+
+  countdown = -1;
+
+  auto v = less::vector<counted>(size);
+  BOOST_TEST_EQ(live.load(), static_cast<int>(size));
+
+  countdown = size - 1;
+  BOOST_TEST_THROWS((less::vector<counted>(v)), int);
+  BOOST_TEST_EQ(live.load(), static_cast<int>(size));
+
+  countdown = -1;
+}
+
+static void resize_throws()
+{
+  live      = 0;
+  countdown = -1;
+
+  {
+    auto v = less::vector<counted>(size / 2, counted(3));
+    BOOST_TEST_EQ(live.load(), static_cast<int>(size / 2));
+
+    auto const p = v.data();
+
+    countdown = size / 4;
+    BOOST_TEST_THROWS(v.resize(size), int);
+    BOOST_TEST_EQ(v.size(), size / 2);
+    BOOST_TEST_EQ(v.data(), p);
+    BOOST_TEST_EQ(live.load(), static_cast<int>(size / 2));
+
+    v.reserve(size);
+    countdown = size / 4;
+    BOOST_TEST_THROWS(v.resize(size, counted(4)), int);
+    BOOST_TEST_EQ(v.size(), size / 2);
+    BOOST_TEST_EQ(live.load(), static_cast<int>(size / 2));
+
+    for (auto const& x : v) {
+      BOOST_TEST_ASSERT_EQ(x.x_, 3);
+    }
+
+    countdown = -1;
+  }
+
+  BOOST_TEST_EQ(live.load(), 0);
+}
+
+static void assign_throws()
+{
+  live      = 0;
+  countdown = -1;
+
+  {
+    auto v = less::vector<counted>(size / 2, counted(1));
+    v.reserve(size);
+
+    // the first `size / 2` copies overwrite existing elements via assignment
+    // so this fails while constructing the new tail
+    //
+    countdown = size / 4;
+    BOOST_TEST_THROWS(v.assign(size, counted(2)), int);
+    BOOST_TEST_EQ(v.size(), size / 2);
+    BOOST_TEST_EQ(live.load(), static_cast<int>(size / 2));
+
+    for (auto const& x : v) {
+      BOOST_TEST_ASSERT_EQ(x.x_, 2);
+    }
+
+    countdown = -1;
+  }
+
+  BOOST_TEST_EQ(live.load(), 0);
+}
+
+static void thread_pool()
+{
+  auto done = std::atomic<int>{0};
+  {
+    auto pool = less::thread_pool(4);
+    BOOST_TEST_EQ(pool.size(), 4u);
+
+    for (auto i = 0; i < 100; ++i) {
+      pool.post([&] { ++done; });
+    }
+  }
+  BOOST_TEST_EQ(done.load(), 100);
+}
+
+int main()
+{
+  fill_construct();
+  copy_construct();
+  nested_copy_construct();
+  assign();
+  resize();
+  construct_throws();
+  resize_throws();
+  assign_throws();
+  thread_pool();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,145 @@
+#include "lwt_helper.hpp"
+
+#include <string>
+#include <utility>
+
+#include <less/persistent_vector.hpp>
+
+static auto iota(unsigned n) -> less::persistent_vector<unsigned>
+{
+  auto t = less::persistent_vector<unsigned>().transient();
+  for (auto i = 0u; i < n; ++i) {
+    t.push_back(i);
+  }
+  return t.persistent();
+}
+
+static bool holds_range(less::persistent_vector<unsigned> const& v,
+                        unsigned first, unsigned last)
+{
+  if (v.size() != last - first) { return false; }
+
+  for (auto i = 0u; i < v.size(); ++i) {
+    if (v[i] != first + i) { return false; }
+  }
+
+  auto next = first;
+  auto ok   = true;
+  v.for_each([&](unsigned x) { ok = ok && (x == next++); });
+  return ok && next == last;
+}
+
+static void push_back()
+{
+  auto const empty = less::persistent_vector<std::string>();
+  BOOST_TEST(empty.empty());
+
+  auto const one = empty.push_back("one");
+  auto const two = one.push_back("two");
+  BOOST_TEST(empty.empty());
+  BOOST_TEST_EQ(one.size(), 1u);
+  BOOST_TEST_EQ(two.size(), 2u);
+  BOOST_TEST_EQ(one.back(), "one");
+  BOOST_TEST_EQ(two.back(), "two");
+  BOOST_TEST_THROWS(two.at(2), less::out_of_range);
+
+  // every version stays intact across several tree levels
+  //
+  auto versions = less::vector<less::persistent_vector<unsigned>>();
+  versions.push_back(less::persistent_vector<unsigned>());
+  for (auto i = 0u; i < 40000u; ++i) {
+    auto next = versions.back().push_back(i);
+    versions.push_back(less::persistent_vector<unsigned>());
+    versions.back() = std::move(next);
+  }
+
+  auto ok = true;
+  for (auto n : {0u, 1u, 31u, 32u, 33u, 1024u, 1056u, 1057u, 32800u, 40000u}) {
+    ok = ok && holds_range(versions[n], 0u, n);
+  }
+  BOOST_TEST(ok);
+}
+
+static void set()
+{
+  auto const v = iota(5000u);
+  auto const w = v.set(10u, 7u).set(4999u, 8u).set(2000u, 9u);
+
+  BOOST_TEST_EQ(w[10], 7u);
+  BOOST_TEST_EQ(w[4999], 8u);
+  BOOST_TEST_EQ(w[2000], 9u);
+  BOOST_TEST_EQ(w[11], 11u);
+  BOOST_TEST(holds_range(v, 0u, 5000u));
+  BOOST_TEST_THROWS(v.set(5000u, 1u), less::out_of_range);
+
+  auto t = w.transient();
+  for (auto i = 0u; i < t.size(); ++i) {
+    t.set(i, i * 2);
+  }
+  auto const doubled = t.persistent();
+  BOOST_TEST(t.empty());
+  BOOST_TEST_EQ(doubled[2000], 4000u);
+  BOOST_TEST_EQ(w[2000], 9u);
+}
+
+static void slicing()
+{
+  auto const n = 50000u;
+  auto const v = iota(n);
+
+  auto ok = true;
+  for (auto first : {0u, 1u, 31u, 32u, 33u, 1000u, 1024u, 33000u, 49990u}) {
+    for (auto last : {first, first + 1, first + 40, first + 1100, n - 5, n}) {
+      if (last < first || last > n) { continue; }
+      ok = ok && holds_range(v.slice(first, last), first, last);
+    }
+  }
+  BOOST_TEST(ok);
+  BOOST_TEST(holds_range(v, 0u, n));
+
+  // relaxed trees keep growing, changing and slicing correctly
+  //
+  auto d = v.drop(77u);
+  BOOST_TEST(holds_range(d, 77u, n));
+  for (auto i = n; i < n + 3000u; ++i) {
+    d = d.push_back(i);
+  }
+  BOOST_TEST(holds_range(d, 77u, n + 3000u));
+
+  d = d.set(0u, 1u).set(0u, 77u);
+  BOOST_TEST(holds_range(d.drop(5000u), 5077u, n + 3000u));
+  BOOST_TEST(holds_range(d.drop(5000u).take(100u), 5077u, 5177u));
+  BOOST_TEST(holds_range(d.slice(40000u, 52000u), 40077u, 52077u));
+
+  auto t = d.drop(1u).transient();
+  t.push_back(n + 3000u);
+  BOOST_TEST(holds_range(t.persistent(), 78u, n + 3001u));
+
+  BOOST_TEST(v.take(0u).empty());
+  BOOST_TEST(v.drop(n).empty());
+  BOOST_TEST(v.slice(10u, 5u).empty());
+}
+
+static void from_vector()
+{
+  auto src = less::vector<std::string>();
+  for (auto i = 0; i < 100; ++i) {
+    src.push_back(std::to_string(i));
+  }
+
+  auto const v = less::persistent_vector<std::string>(src);
+  BOOST_TEST_EQ(v.size(), 100u);
+  BOOST_TEST_EQ(v[42], "42");
+  BOOST_TEST(v.to_vector() == src);
+  BOOST_TEST_EQ(v.slice(10u, 20u).front(), "10");
+}
+
+int main()
+{
+  push_back();
+  set();
+  slicing();
+  from_vector();
+
+  return boost::report_errors();
+}
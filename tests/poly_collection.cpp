@@ -0,0 +1,199 @@
+#include "lwt_helper.hpp"
+
+#include <string>
+
+#include <less/poly_collection.hpp>
+
+struct shape {
+  virtual ~shape() = default;
+
+  virtual auto area() const -> double = 0;
+  virtual auto name() const -> std::string = 0;
+};
+
+struct square final : shape {
+  double side;
+
+  explicit square(double s)
+      : side(s)
+  {
+  }
+
+  auto area() const -> double override
+  {
+    return side * side;
+  }
+
+  auto name() const -> std::string override
+  {
+    return "square";
+  }
+};
+
+struct rectangle final : shape {
+  double w;
+  double h;
+
+  rectangle(double w_, double h_)
+      : w(w_)
+      , h(h_)
+  {
+  }
+
+  auto area() const -> double override
+  {
+    return w * h;
+  }
+
+  auto name() const -> std::string override
+  {
+    return "rectangle";
+  }
+};
+
+// a second base in front of `shape`, so its subobject isn't at offset 0
+//
+struct tagged {
+  std::string tag = "tag";
+
+  virtual ~tagged() = default;
+};
+
+struct labelled final : tagged, shape {
+  std::string label;
+
+  explicit labelled(std::string l)
+      : label(std::move(l))
+  {
+  }
+
+  auto area() const -> double override
+  {
+    return static_cast<double>(label.size());
+  }
+
+  auto name() const -> std::string override
+  {
+    return label;
+  }
+};
+
+static void segments()
+{
+  auto c = less::poly_collection<shape>();
+  BOOST_TEST(c.empty());
+  BOOST_TEST_EQ(c.segment_count(), 0u);
+
+  c.insert(square(2));
+  c.emplace<rectangle>(2.0, 3.0);
+  c.insert(square(3));
+  c.emplace<labelled>("hello");
+  auto& sq = c.emplace<square>(1.0);
+  BOOST_TEST_EQ(sq.side, 1.0);
+
+  BOOST_TEST_EQ(c.size(), 5u);
+  BOOST_TEST_EQ(c.segment_count(), 3u);
+  BOOST_TEST_EQ(c.size<square>(), 3u);
+  BOOST_TEST_EQ(c.size<rectangle>(), 1u);
+  BOOST_TEST_EQ(c.size<labelled>(), 1u);
+
+  // same-type elements are contiguous in their own vector
+  //
+  auto& squares = c.segment<square>();
+  BOOST_TEST_EQ(squares.size(), 3u);
+  BOOST_TEST_EQ(squares[1].side, 3.0);
+  BOOST_TEST_EQ(&squares[1] - &squares[0], 1);
+
+  c.reserve<rectangle>(100u);
+  BOOST_TEST_GE(c.segment<rectangle>().capacity(), 100u);
+
+  c.clear();
+  BOOST_TEST(c.empty());
+  BOOST_TEST_EQ(c.segment_count(), 3u);
+}
+
+static void visiting()
+{
+  auto c = less::poly_collection<shape>();
+  for (auto i = 1; i <= 100; ++i) {
+    c.emplace<square>(static_cast<double>(i % 4));
+    if (i % 2 == 0) { c.emplace<rectangle>(1.0, static_cast<double>(i)); }
+    if (i % 10 == 0) { c.emplace<labelled>(std::string(i / 10, 'x')); }
+  }
+
+  auto expected = 0.0;
+  for (auto i = 1; i <= 100; ++i) {
+    expected += (i % 4) * (i % 4);
+    if (i % 2 == 0) { expected += i; }
+    if (i % 10 == 0) { expected += i / 10; }
+  }
+
+  auto total = 0.0;
+  auto count = 0;
+  c.for_each([&](shape& s) {
+    total += s.area();
+    ++count;
+  });
+  BOOST_TEST_EQ(total, expected);
+  BOOST_TEST_EQ(count, 160);
+
+  // segments go in the order their types first appeared
+  //
+  auto names = std::string();
+  auto const& cc = c;
+  cc.for_each([&](shape const& s) {
+    if (names.empty() || names.back() != s.name().front()) {
+      names += s.name().front();
+    }
+  });
+  BOOST_TEST_EQ(names, "srx");
+
+  // restored types for two segments, `shape&` for the rest
+  //
+  auto squares = 0;
+  auto rects   = 0;
+  auto others  = 0;
+  total        = 0.0;
+
+  struct visitor {
+    int&    squares;
+    int&    rects;
+    int&    others;
+    double& total;
+
+    void operator()(square& s) const
+    {
+      ++squares;
+      total += s.area();
+    }
+
+    void operator()(rectangle& r) const
+    {
+      ++rects;
+      total += r.w * r.h;
+    }
+
+    void operator()(shape& s) const
+    {
+      ++others;
+      total += s.area();
+    }
+  };
+
+  c.for_each<square, rectangle>(visitor{squares, rects, others, total});
+  BOOST_TEST_EQ(squares, 100);
+  BOOST_TEST_EQ(rects, 50);
+  BOOST_TEST_EQ(others, 10);
+  BOOST_TEST_EQ(total, expected);
+
+  auto moved = std::move(c);
+  BOOST_TEST_EQ(moved.size(), 160u);
+}
+
+int main()
+{
+  segments();
+  visiting();
+
+  return boost::report_errors();
+}
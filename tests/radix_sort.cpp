@@ -0,0 +1,161 @@
+#include "lwt_helper.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+
+#include <less/radix_sort.hpp>
+
+template <class T>
+static void sort_keys(less::vector<T> v)
+{
+  auto expected = v;
+  std::sort(expected.begin(), expected.end());
+
+  less::radix_sort(v);
+  BOOST_TEST(v == expected);
+}
+
+static void integers()
+{
+  auto rng = std::mt19937_64(1234);
+
+  auto u64 = less::vector<std::uint64_t>();
+  auto i64 = less::vector<std::int64_t>();
+  auto u32 = less::vector<std::uint32_t>();
+  auto i32 = less::vector<std::int32_t>();
+  auto u16 = less::vector<std::uint16_t>();
+  auto i8  = less::vector<std::int8_t>();
+  for (auto i = 0; i < 20'000; ++i) {
+    auto const x = rng();
+    u64.push_back(x);
+    i64.push_back(static_cast<std::int64_t>(x));
+    u32.push_back(static_cast<std::uint32_t>(x));
+    i32.push_back(static_cast<std::int32_t>(x));
+    u16.push_back(static_cast<std::uint16_t>(x));
+    i8.push_back(static_cast<std::int8_t>(x));
+  }
+
+  i64.push_back(std::numeric_limits<std::int64_t>::min());
+  i64.push_back(std::numeric_limits<std::int64_t>::max());
+  i32.push_back(std::numeric_limits<std::int32_t>::min());
+  i32.push_back(0);
+
+  sort_keys(u64);
+  sort_keys(i64);
+  sort_keys(u32);
+  sort_keys(i32);
+  sort_keys(u16);
+  sort_keys(i8);
+
+  // only the low digit varies, so every other pass is skipped and the result
+  // ends up in the scratch buffer
+  //
+  auto small = less::vector<std::uint64_t>();
+  for (auto i = 0; i < 1000; ++i) {
+    small.push_back(rng() % 1000u + (std::uint64_t{1} << 40));
+  }
+  sort_keys(small);
+
+  sort_keys(less::vector<std::uint64_t>(500u, std::uint64_t{42}));
+  sort_keys(less::vector<int>());
+  sort_keys(less::vector<int>{7});
+}
+
+static void floating_point()
+{
+  auto rng  = std::mt19937(1234);
+  auto dist = std::uniform_real_distribution<double>(-1e6, 1e6);
+
+  auto d = less::vector<double>();
+  auto f = less::vector<float>();
+  for (auto i = 0; i < 10'000; ++i) {
+    auto const x = dist(rng);
+    d.push_back(x);
+    f.push_back(static_cast<float>(x));
+  }
+
+  auto const inf = std::numeric_limits<double>::infinity();
+  d.push_back(inf);
+  d.push_back(-inf);
+  d.push_back(0.0);
+  d.push_back(std::numeric_limits<double>::denorm_min());
+  d.push_back(-std::numeric_limits<double>::denorm_min());
+
+  sort_keys(d);
+  sort_keys(f);
+
+  // -0.0 orders before 0.0
+  //
+  auto z = less::vector<double>{0.0, -0.0, 1.0, -1.0};
+  less::radix_sort(z);
+  BOOST_TEST_EQ(z[0], -1.0);
+  BOOST_TEST(std::signbit(z[1]));
+  BOOST_TEST(!std::signbit(z[2]));
+  BOOST_TEST_EQ(z[3], 1.0);
+}
+
+struct record {
+  std::int32_t  key;
+  std::uint32_t order;
+  std::string   payload;
+};
+
+static void records()
+{
+  auto rng = std::mt19937(1234);
+
+  auto v = less::vector<record>();
+  for (auto i = 0u; i < 5000u; ++i) {
+    auto const k = static_cast<std::int32_t>(rng() % 200u) - 100;
+    v.push_back(record{k, i, std::to_string(k)});
+  }
+
+  less::radix_sort(v, [](record const& r) { return r.key; });
+
+  // stable: equal keys keep their insertion order
+  //
+  for (auto i = 1u; i < v.size(); ++i) {
+    BOOST_TEST_ASSERT(v[i - 1].key < v[i].key ||
+                      (v[i - 1].key == v[i].key &&
+                       v[i - 1].order < v[i].order));
+  }
+  for (auto const& r : v) {
+    BOOST_TEST_EQ(r.payload, std::to_string(r.key));
+  }
+
+  // pointer ranges copy the result back when it lands in the scratch buffer
+  //
+  auto keys = less::vector<std::uint64_t>();
+  for (auto i = 0; i < 3000; ++i) {
+    keys.push_back(rng() % 5000u);
+  }
+  auto expected = keys;
+  std::sort(expected.begin(), expected.end());
+
+  auto const p = keys.data();
+  less::radix_sort(keys.data(), keys.data() + keys.size());
+  BOOST_TEST_EQ(keys.data(), p);
+  BOOST_TEST(keys == expected);
+
+  auto pairs = less::vector<std::uint64_t>{0x0000'0003'0000'0001u,
+                                           0x0000'0001'0000'0002u,
+                                           0x0000'0002'0000'0001u};
+  less::radix_sort(pairs.data(), pairs.data() + pairs.size(),
+                   [](std::uint64_t x) { return std::uint32_t(x); });
+  BOOST_TEST_EQ(pairs[0], 0x0000'0003'0000'0001u);
+  BOOST_TEST_EQ(pairs[1], 0x0000'0002'0000'0001u);
+  BOOST_TEST_EQ(pairs[2], 0x0000'0001'0000'0002u);
+}
+
+int main()
+{
+  integers();
+  floating_point();
+  records();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,140 @@
+#include "lwt_helper.hpp"
+
+#include <atomic>
+#include <thread>
+
+#include <less/rcu_vector.hpp>
+
+static void basics()
+{
+  auto v = less::rcu_vector<int>();
+  BOOST_TEST(v.read().empty());
+
+  v.store(less::vector<int>(10u, 7));
+  {
+    auto const s = v.read();
+    BOOST_TEST_EQ(s.size(), 10u);
+    BOOST_TEST_EQ(s[3], 7);
+    BOOST_TEST_EQ(s.front(), 7);
+    BOOST_TEST_EQ(s.end() - s.begin(), 10);
+    BOOST_TEST_THROWS(s.at(10), less::out_of_range);
+  }
+
+  v.update([](less::vector<int>& elems) { elems.push_back(8); });
+  BOOST_TEST_EQ(v.read().back(), 8);
+  BOOST_TEST_EQ(v.read().size(), 11u);
+
+  // a failed update publishes nothing
+  //
+  BOOST_TEST_THROWS(v.update([](less::vector<int>& elems) {
+    elems.clear();
+    throw 1;
+  }),
+                    int);
+  BOOST_TEST_EQ(v.read().size(), 11u);
+
+  auto w = less::rcu_vector<int>(less::vector<int>(3u, 1));
+  BOOST_TEST_EQ(w.read().size(), 3u);
+}
+
+static void deferred_free()
+{
+  auto v = less::rcu_vector<int>(less::vector<int>(5u, 1));
+
+  // nobody reads, so replaced versions go away right away
+  //
+  v.store(less::vector<int>(5u, 2));
+  BOOST_TEST_EQ(v.pending(), 0u);
+
+  {
+    auto old = v.read();
+
+    v.store(less::vector<int>(5u, 3));
+    v.update([](less::vector<int>& elems) { elems[0] = 4; });
+
+    // the snapshot is unaffected and pins what it sees
+    //
+    BOOST_TEST_EQ(old[0], 2);
+    BOOST_TEST_EQ(old.size(), 5u);
+    BOOST_TEST_EQ(v.pending(), 2u);
+    BOOST_TEST_EQ(v.read()[0], 4);
+
+    // moving it keeps it pinned
+    //
+    auto moved = std::move(old);
+    v.reclaim();
+    BOOST_TEST_EQ(v.pending(), 2u);
+    BOOST_TEST_EQ(moved[1], 2);
+  }
+
+  v.reclaim();
+  BOOST_TEST_EQ(v.pending(), 0u);
+
+  // more snapshots than reader slots on one thread would spin forever, but up
+  // to the limit they all coexist
+  //
+  auto snaps = less::vector<less::rcu_vector<int>::snapshot>();
+  for (auto i = 0u; i < less::rcu_vector<int>::max_readers; ++i) {
+    snaps.push_back(v.read());
+  }
+  BOOST_TEST_EQ(snaps.back()[0], 4);
+}
+
+static void concurrent_readers()
+{
+  // every published version holds `n` copies of `n` so a reader can tell if
+  // it ever sees a torn or freed buffer
+  //
+  auto v = less::rcu_vector<unsigned>(less::vector<unsigned>(less::unsigned_long_type{1}, 1u));
+
+  auto done    = std::atomic<bool>{false};
+  auto readers = less::vector<std::thread>();
+  for (auto t = 0u; t < 8; ++t) {
+    readers.emplace_back([&] {
+      auto last = 0u;
+      while (!done.load()) {
+        auto const s = v.read();
+        auto const n = s.size();
+        BOOST_TEST_ASSERT_EQ(n, s[0]);
+        BOOST_TEST_GE(n, last);
+        for (auto x : s) {
+          BOOST_TEST_ASSERT_EQ(x, n);
+        }
+        last = n;
+      }
+    });
+  }
+
+  for (auto n = 2u; n < 500; ++n) {
+    if (n % 2 == 0) {
+      v.store(less::vector<unsigned>(less::unsigned_long_type{n}, n));
+    }
+    else {
+      v.update([n](less::vector<unsigned>& elems) {
+        for (auto& x : elems) {
+          x = n;
+        }
+        elems.push_back(n);
+      });
+    }
+    std::this_thread::yield();
+  }
+
+  done.store(true);
+  for (auto& t : readers) {
+    t.join();
+  }
+
+  v.reclaim();
+  BOOST_TEST_EQ(v.pending(), 0u);
+  BOOST_TEST_EQ(v.read().size(), 499u);
+}
+
+int main()
+{
+  basics();
+  deferred_free();
+  concurrent_readers();
+
+  return boost::report_errors();
+}
@@ -467,6 +467,52 @@ static void shrink_throws_in_functor()
   }
 }
 
+static int live = 0;
+
+struct tracked {
+  tracked()
+  {
+    ++live;
+  }
+
+  tracked(tracked const&)
+  {
+    ++live;
+  }
+
+  ~tracked()
+  {
+    --live;
+  }
+};
+
+static void shrink_returns_fewer()
+{
+  auto v = less::vector<tracked>(100u);
+  BOOST_TEST_EQ(live, 100);
+
+  v.resize_and_overwrite(50u, [](auto*, auto n) { return n / 2; });
+  BOOST_TEST_EQ(v.size(), 25u);
+  BOOST_TEST_EQ(live, 25);
+}
+
+static void grow_no_realloc_returns_fewer()
+{
+  {
+    auto v = less::vector<tracked>(10u);
+    v.reserve(64u);
+    BOOST_TEST_EQ(live, 10);
+
+    auto const data = v.data();
+
+    v.resize_and_overwrite(20u, [](auto*, auto n) { return n - 5; });
+    BOOST_TEST_EQ(v.data(), data);
+    BOOST_TEST_EQ(v.size(), 15u);
+    BOOST_TEST_EQ(live, 15);
+  }
+  BOOST_TEST_EQ(live, 0);
+}
+
 int main()
 {
   empty();
@@ -483,5 +529,7 @@ int main()
   shrink();
   shrink_raii();
   shrink_throws_in_functor();
+  shrink_returns_fewer();
+  grow_no_realloc_returns_fewer();
   return boost::report_errors();
 }
@@ -0,0 +1,217 @@
+#include "lwt_helper.hpp"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <less/ring.hpp>
+
+static void spsc_basics()
+{
+  auto r = less::spsc_ring<int>(5);
+  BOOST_TEST_EQ(r.capacity(), 8u);
+  BOOST_TEST(r.empty());
+
+  auto x = 0;
+  BOOST_TEST_NOT(r.try_pop(x));
+
+  for (auto i = 0; i < 8; ++i) {
+    BOOST_TEST(r.try_push(i));
+  }
+  BOOST_TEST_NOT(r.try_push(8));
+  BOOST_TEST_EQ(r.size(), 8u);
+
+  BOOST_TEST(r.try_pop(x));
+  BOOST_TEST_EQ(x, 0);
+
+  // batches wrap around the end of the storage
+  //
+  int out[8] = {};
+  BOOST_TEST_EQ(r.pop_n(out, 5), 5u);
+  BOOST_TEST_EQ(out[0], 1);
+  BOOST_TEST_EQ(out[4], 5);
+
+  int in[8] = {10, 11, 12, 13, 14, 15, 16, 17};
+  BOOST_TEST_EQ(r.push_n(in, 8), 6u);
+  BOOST_TEST_EQ(r.size(), 8u);
+  BOOST_TEST_EQ(r.push_n(in, 1), 0u);
+
+  BOOST_TEST_EQ(r.pop_n(out, 8), 8u);
+  int const expected[8] = {6, 7, 10, 11, 12, 13, 14, 15};
+  for (auto i = 0; i < 8; ++i) {
+    BOOST_TEST_EQ(out[i], expected[i]);
+  }
+  BOOST_TEST(r.empty());
+  BOOST_TEST_EQ(r.pop_n(out, 8), 0u);
+}
+
+static void non_trivial()
+{
+  auto const s = std::string("a string too long for the small buffer");
+  {
+    auto r = less::spsc_ring<std::string>(4);
+    BOOST_TEST(r.try_push(s));
+    BOOST_TEST(r.try_emplace(3u, 'x'));
+
+    std::string in[3] = {"a", "b", "c"};
+    BOOST_TEST_EQ(r.push_n(in, 3), 2u);
+
+    auto out = std::string();
+    BOOST_TEST(r.try_pop(out));
+    BOOST_TEST_EQ(out, s);
+
+    std::string outs[2];
+    BOOST_TEST_EQ(r.pop_n(outs, 2), 2u);
+    BOOST_TEST_EQ(outs[0], "xxx");
+    BOOST_TEST_EQ(outs[1], "a");
+
+    // whatever is left gets destroyed with the ring
+    //
+    BOOST_TEST(r.try_push(s));
+  }
+  {
+    auto r = less::mpmc_ring<std::unique_ptr<int>>(2);
+    BOOST_TEST(r.try_push(std::make_unique<int>(1)));
+    BOOST_TEST(r.try_emplace(new int(2)));
+    BOOST_TEST_NOT(r.try_push(std::make_unique<int>(3)));
+
+    auto p = std::unique_ptr<int>();
+    BOOST_TEST(r.try_pop(p));
+    BOOST_TEST_EQ(*p, 1);
+    BOOST_TEST(r.try_push(std::make_unique<int>(3)));
+  }
+}
+
+static void mpmc_basics()
+{
+  auto r = less::mpmc_ring<int>(8);
+  BOOST_TEST_EQ(r.capacity(), 8u);
+
+  int in[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  BOOST_TEST_EQ(r.push_n(in, 10), 8u);
+  BOOST_TEST_NOT(r.try_push(8));
+  BOOST_TEST_EQ(r.size(), 8u);
+
+  int out[10] = {};
+  BOOST_TEST_EQ(r.pop_n(out, 3), 3u);
+  BOOST_TEST_EQ(out[2], 2);
+  BOOST_TEST_EQ(r.push_n(in, 10), 3u);
+  BOOST_TEST_EQ(r.pop_n(out, 10), 8u);
+  BOOST_TEST_EQ(out[0], 3);
+  BOOST_TEST_EQ(out[4], 7);
+  BOOST_TEST_EQ(out[5], 0);
+  BOOST_TEST_EQ(out[7], 2);
+  BOOST_TEST(r.empty());
+
+  auto x = 0;
+  BOOST_TEST_NOT(r.try_pop(x));
+}
+
+static void spsc_threads()
+{
+  constexpr auto const n = 50000u;
+
+  auto r = less::spsc_ring<unsigned>(64);
+
+  auto producer = std::thread([&] {
+    unsigned batch[7];
+    for (auto i = 0u; i < n;) {
+      if (i % 3 == 0) {
+        if (r.try_push(i)) { ++i; }
+        continue;
+      }
+
+      auto const count = (n - i < 7 ? n - i : 7);
+      for (auto j = 0u; j < count; ++j) {
+        batch[j] = i + j;
+      }
+      i += r.push_n(batch, count);
+    }
+  });
+
+  auto next = 0u;
+  unsigned batch[5];
+  while (next < n) {
+    auto const got = r.pop_n(batch, 5);
+    for (auto j = 0u; j < got; ++j) {
+      BOOST_TEST_ASSERT_EQ(batch[j], next++);
+    }
+    if (got == 0) { std::this_thread::yield(); }
+  }
+  producer.join();
+  BOOST_TEST(r.empty());
+}
+
+static void mpmc_threads()
+{
+  constexpr auto const num_producers = 4u;
+  constexpr auto const num_consumers = 4u;
+  constexpr auto const per_producer  = 10000u;
+
+  auto r = less::mpmc_ring<unsigned>(128);
+
+  auto seen = less::vector<std::atomic<unsigned char>>(
+      less::unsigned_long_type{num_producers * per_producer});
+  for (auto& s : seen) {
+    s.store(0);
+  }
+
+  auto consumed = std::atomic<unsigned>{0};
+  auto threads  = less::vector<std::thread>();
+
+  for (auto t = 0u; t < num_producers; ++t) {
+    threads.emplace_back([&, t] {
+      auto const first = t * per_producer;
+      unsigned   batch[4];
+      for (auto i = 0u; i < per_producer;) {
+        auto const count = (per_producer - i < 4 ? per_producer - i : 4);
+        for (auto j = 0u; j < count; ++j) {
+          batch[j] = first + i + j;
+        }
+        auto const pushed = r.push_n(batch, count);
+        i += pushed;
+        if (pushed == 0) { std::this_thread::yield(); }
+      }
+    });
+  }
+
+  for (auto t = 0u; t < num_consumers; ++t) {
+    threads.emplace_back([&, t] {
+      unsigned batch[3];
+      while (consumed.load() < num_producers * per_producer) {
+        auto got = less::unsigned_long_type{0};
+        if (t % 2 == 0) {
+          got = r.pop_n(batch, 3);
+        }
+        else {
+          got = r.try_pop(batch[0]) ? 1u : 0u;
+        }
+        for (auto j = 0u; j < got; ++j) {
+          seen[batch[j]].fetch_add(1);
+        }
+        consumed.fetch_add(static_cast<unsigned>(got));
+        if (got == 0) { std::this_thread::yield(); }
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  BOOST_TEST(r.empty());
+  for (auto const& s : seen) {
+    BOOST_TEST_ASSERT_EQ(s.load(), 1);
+  }
+}
+
+int main()
+{
+  spsc_basics();
+  non_trivial();
+  mpmc_basics();
+  spsc_threads();
+  mpmc_threads();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,157 @@
+#include "lwt_helper.hpp"
+
+#include <cstring>
+#include <utility>
+
+#include <less/serialize.hpp>
+
+struct record {
+  unsigned id;
+  float    weight;
+  double   score;
+};
+
+static auto to_bytes = [](auto const& v) {
+  auto buf = less::vector<unsigned char>();
+  less::serialize(v, [&](void const* p, less::unsigned_long_type n) {
+    auto const bytes = static_cast<unsigned char const*>(p);
+    buf.insert(buf.end(), bytes, bytes + n);
+  });
+  return buf;
+};
+
+static void round_trip()
+{
+  auto v = less::vector<unsigned>();
+  for (auto i = 0u; i < 1000; ++i) {
+    v.push_back(i * 7);
+  }
+
+  auto const buf = to_bytes(v);
+  BOOST_TEST_EQ(buf.size(), less::serialized_size<unsigned>(v.size()));
+
+  auto const view = less::vector_view<unsigned>(buf.data(), buf.size());
+  BOOST_TEST_EQ(view.size(), v.size());
+  BOOST_TEST_NOT(view.empty());
+
+  // the view points into the buffer, nothing was copied
+  //
+  BOOST_TEST_EQ(static_cast<void const*>(view.data()),
+                static_cast<void const*>(buf.data() + 64));
+
+  for (auto i = 0u; i < v.size(); ++i) {
+    BOOST_TEST_ASSERT_EQ(view[i], v[i]);
+  }
+  BOOST_TEST_EQ(view.front(), 0u);
+  BOOST_TEST_EQ(view.back(), 999u * 7);
+  BOOST_TEST_EQ(view.end() - view.begin(), 1000);
+  BOOST_TEST_THROWS(view.at(1000), less::out_of_range);
+
+  auto copy = less::vector<unsigned>(view.begin(), view.end());
+  BOOST_TEST(copy == v);
+}
+
+static void records()
+{
+  auto v = less::vector<record>();
+  for (auto i = 0u; i < 37; ++i) {
+    v.push_back(record{i, i * 0.5f, i * 0.25});
+  }
+
+  auto const buf  = to_bytes(v);
+  auto const view = less::vector_view<record>(buf.data(), buf.size());
+  BOOST_TEST_EQ(view.size(), 37u);
+  for (auto i = 0u; i < view.size(); ++i) {
+    BOOST_TEST_ASSERT_EQ(view[i].id, i);
+    BOOST_TEST_ASSERT_EQ(view[i].weight, i * 0.5f);
+    BOOST_TEST_ASSERT_EQ(view[i].score, i * 0.25);
+  }
+}
+
+static void empty()
+{
+  auto const buf  = to_bytes(less::vector<int>());
+  auto const view = less::vector_view<int>(buf.data(), buf.size());
+  BOOST_TEST(view.empty());
+  BOOST_TEST(view.begin() == view.end());
+
+  auto const def = less::vector_view<int>();
+  BOOST_TEST(def.empty());
+  BOOST_TEST_EQ(def.data(), nullptr);
+}
+
+static void validation()
+{
+  auto v = less::vector<int>(100u, 3);
+
+  auto buf = to_bytes(v);
+
+  using view = less::vector_view<int>;
+
+  // truncated header and payload
+  //
+  BOOST_TEST_THROWS(view(buf.data(), 10), less::format_error);
+  BOOST_TEST_THROWS(view(buf.data(), buf.size() - 1), less::format_error);
+
+  // element type of a different size or alignment
+  //
+  BOOST_TEST_THROWS(less::vector_view<double>(buf.data(), buf.size()),
+                    less::format_error);
+  BOOST_TEST_THROWS(less::vector_view<char[4]>(buf.data(), buf.size()),
+                    less::format_error);
+
+  // a flipped payload bit only shows up in the checksum
+  //
+  buf[200] ^= 1;
+  BOOST_TEST_THROWS(view(buf.data(), buf.size()), less::format_error);
+
+  auto const unchecked = view(less::skip_checksum, buf.data(), buf.size());
+  BOOST_TEST_EQ(unchecked.size(), 100u);
+  buf[200] ^= 1;
+
+  // bad magic
+  //
+  buf[0] = 'x';
+  BOOST_TEST_THROWS(view(less::skip_checksum, buf.data(), buf.size()),
+                    less::format_error);
+  buf[0] = 'l';
+
+  // foreign byte order
+  //
+  std::swap(buf[12], buf[15]);
+  std::swap(buf[13], buf[14]);
+  BOOST_TEST_THROWS(view(less::skip_checksum, buf.data(), buf.size()),
+                    less::format_error);
+  std::swap(buf[12], buf[15]);
+  std::swap(buf[13], buf[14]);
+
+  BOOST_TEST_EQ(view(buf.data(), buf.size()).size(), 100u);
+}
+
+static void checksum()
+{
+  // every length up to a few blocks and every byte position contributes
+  //
+  unsigned char bytes[100] = {};
+  for (auto n = 0u; n < sizeof(bytes); ++n) {
+    auto const h = less::detail::checksum(bytes, n + 1);
+    BOOST_TEST_NE(h, less::detail::checksum(bytes, n));
+
+    for (auto i = 0u; i <= n; ++i) {
+      bytes[i] = 1;
+      BOOST_TEST_NE(h, less::detail::checksum(bytes, n + 1));
+      bytes[i] = 0;
+    }
+  }
+}
+
+int main()
+{
+  round_trip();
+  records();
+  empty();
+  validation();
+  checksum();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,128 @@
+#include "lwt_helper.hpp"
+
+// small enough that collecting the test data spans several chunks
+//
+#define LESS_PARALLEL_THRESHOLD 1024
+
+#include <string>
+#include <thread>
+
+#include <less/thread_pool.hpp>
+#include <less/sharded_vector.hpp>
+
+static void single_thread()
+{
+  auto v = less::sharded_vector<int>();
+  BOOST_TEST(v.empty());
+  BOOST_TEST(v.collect().empty());
+
+  v.push_back(1);
+  v.emplace_back(2);
+  v.local().push_back(3);
+
+  // one thread, one shard
+  //
+  BOOST_TEST_EQ(v.shard_count(), 1u);
+  BOOST_TEST_EQ(&v.local(), &v.shard_at(0));
+  BOOST_TEST_EQ(v.size(), 3u);
+
+  auto const out = v.collect();
+  BOOST_TEST_EQ(out.size(), 3u);
+  BOOST_TEST_EQ(out[0], 1);
+  BOOST_TEST_EQ(out[2], 3);
+
+  // the shard is drained but keeps its capacity
+  //
+  BOOST_TEST(v.empty());
+  BOOST_TEST_GE(v.local().capacity(), 3u);
+
+  // a second instance gets its own shard
+  //
+  auto w = less::sharded_vector<int>();
+  w.push_back(4);
+  v.push_back(5);
+  w.push_back(6);
+  BOOST_TEST_EQ(v.size(), 1u);
+  BOOST_TEST_EQ(w.size(), 2u);
+}
+
+static void many_instances()
+{
+  // a thread alternating between instances, within the cache and past it
+  //
+  for (auto const count : {2u, 3u * LESS_SHARDED_VECTOR_CACHE_SIZE}) {
+    auto vs = less::vector<less::sharded_vector<int>*>();
+    for (auto i = 0u; i < count; ++i) {
+      vs.push_back(new less::sharded_vector<int>());
+    }
+
+    for (auto round = 0; round < 100; ++round) {
+      for (auto i = 0u; i < count; ++i) {
+        vs[i]->push_back(static_cast<int>(i) * 1000 + round);
+      }
+    }
+
+    for (auto i = 0u; i < count; ++i) {
+      BOOST_TEST_EQ(vs[i]->shard_count(), 1u);
+      auto const out = vs[i]->collect();
+      BOOST_TEST_EQ(out.size(), 100u);
+      BOOST_TEST_EQ(out[99], static_cast<int>(i) * 1000 + 99);
+      delete vs[i];
+    }
+  }
+}
+
+template <class T, class Make>
+static void many_threads(Make make)
+{
+  constexpr auto const num_threads = 6u;
+  constexpr auto const per_thread  = 5000u;
+
+  auto v = less::sharded_vector<T>();
+
+  for (auto round = 0u; round < 2; ++round) {
+    auto threads = less::vector<std::thread>();
+    for (auto t = 0u; t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        for (auto i = 0u; i < per_thread; ++i) {
+          v.push_back(make(t * per_thread + i));
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    // a new thread may take over the shard of an exited one with the same id
+    //
+    BOOST_TEST_GE(v.shard_count(), 1u);
+    BOOST_TEST_LE(v.shard_count(), num_threads * (round + 1));
+    BOOST_TEST_EQ(v.size(), num_threads * per_thread);
+
+    // shards are concatenated in order, each keeping its own order
+    //
+    auto expected = less::vector<T>();
+    for (auto s = 0u; s < v.shard_count(); ++s) {
+      for (auto const& x : v.shard_at(s)) {
+        expected.push_back(x);
+      }
+    }
+
+    auto const out = v.collect();
+    BOOST_TEST(out == expected);
+    BOOST_TEST(v.empty());
+  }
+}
+
+int main()
+{
+  single_thread();
+  many_instances();
+  many_threads<unsigned>([](unsigned i) { return i * 3; });
+  many_threads<std::string>([](unsigned i) {
+    return std::string("a string longer than the small buffer ") +
+           std::to_string(i);
+  });
+
+  return boost::report_errors();
+}
@@ -0,0 +1,112 @@
+#include "lwt_helper.hpp"
+
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include <less/slot_map.hpp>
+
+static void basics()
+{
+  auto m = less::slot_map<std::string>();
+  BOOST_TEST(m.empty());
+
+  auto a = m.insert("a");
+  auto b = m.emplace(3u, 'b');
+  auto c = m.insert(std::string("c"));
+  BOOST_TEST_EQ(m.size(), 3u);
+  BOOST_TEST_EQ(m[a], "a");
+  BOOST_TEST_EQ(m.at(b), "bbb");
+  BOOST_TEST_EQ(*m.get(c), "c");
+
+  // the last value moves into the hole; handles still find everything
+  //
+  BOOST_TEST(m.erase(a));
+  BOOST_TEST_EQ(m.size(), 2u);
+  BOOST_TEST_EQ(m.data()[0], "c");
+  BOOST_TEST_EQ(m[c], "c");
+  BOOST_TEST_EQ(m[b], "bbb");
+
+  BOOST_TEST(!m.contains(a));
+  BOOST_TEST(!m.erase(a));
+  BOOST_TEST(m.get(a) == nullptr);
+  BOOST_TEST_THROWS(m.at(a), less::out_of_range);
+  BOOST_TEST(!m.contains(less::slot_map<std::string>::handle()));
+
+  // the freed slot is reused under a new generation
+  //
+  auto d = m.insert("d");
+  BOOST_TEST_EQ(d.index, a.index);
+  BOOST_TEST_NE(d.generation, a.generation);
+  BOOST_TEST(d != a);
+  BOOST_TEST(!m.contains(a));
+  BOOST_TEST_EQ(m[d], "d");
+
+  for (auto i = 0u; i < m.size(); ++i) {
+    BOOST_TEST_EQ(m[m.handle_at(i)], m.data()[i]);
+  }
+
+  auto n = 0u;
+  for (auto& s : m) {
+    n += static_cast<unsigned>(s.size());
+  }
+  BOOST_TEST_EQ(n, 5u);
+
+  m.clear();
+  BOOST_TEST(m.empty());
+  BOOST_TEST(!m.contains(b));
+  BOOST_TEST(!m.contains(c));
+  BOOST_TEST(!m.contains(d));
+
+  auto e = m.insert("e");
+  BOOST_TEST_EQ(m[e], "e");
+  BOOST_TEST_EQ(m.size(), 1u);
+}
+
+static void churn()
+{
+  using handle = less::slot_map<int>::handle;
+
+  auto rng = std::mt19937(1234);
+
+  auto m     = less::slot_map<int>();
+  auto live  = less::vector<handle>();
+  auto dead  = less::vector<handle>();
+  auto value = std::unordered_map<unsigned long long, int>();
+
+  auto key = [](handle h) {
+    return (static_cast<unsigned long long>(h.index) << 32) | h.generation;
+  };
+
+  for (auto i = 0; i < 50'000; ++i) {
+    if (live.empty() || rng() % 3u != 0) {
+      auto const h = m.insert(i);
+      live.push_back(h);
+      value[key(h)] = i;
+    }
+    else {
+      auto const pos = rng() % live.size();
+      auto const h   = live[pos];
+      BOOST_TEST_ASSERT(m.erase(h));
+      live[pos] = live.back();
+      live.pop_back();
+      dead.push_back(h);
+    }
+  }
+
+  BOOST_TEST_EQ(m.size(), live.size());
+  for (auto h : live) {
+    BOOST_TEST_ASSERT_EQ(m[h], value[key(h)]);
+  }
+  for (auto h : dead) {
+    BOOST_TEST_ASSERT(!m.contains(h));
+  }
+}
+
+int main()
+{
+  basics();
+  churn();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,94 @@
+#include "lwt_helper.hpp"
+
+#define LESS_SPARSE_SET_PAGE_SIZE 64u
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+
+#include <less/sparse_set.hpp>
+
+static void basics()
+{
+  auto s = less::sparse_set<>();
+  BOOST_TEST(s.empty());
+  BOOST_TEST(!s.contains(0));
+  BOOST_TEST(!s.contains(1'000'000));
+  BOOST_TEST(!s.erase(7));
+
+  BOOST_TEST(s.insert(7));
+  BOOST_TEST(s.insert(0));
+  BOOST_TEST(s.insert(1'000'000));
+  BOOST_TEST(!s.insert(7));
+  BOOST_TEST_EQ(s.size(), 3u);
+  BOOST_TEST(s.contains(7));
+  BOOST_TEST(s.contains(1'000'000));
+  BOOST_TEST(!s.contains(8));
+
+  // members stay packed: the last one fills the hole
+  //
+  BOOST_TEST(s.erase(7));
+  BOOST_TEST(!s.contains(7));
+  BOOST_TEST_EQ(s.size(), 2u);
+  BOOST_TEST_EQ(s.data()[0], 1'000'000u);
+  BOOST_TEST_EQ(s.data()[1], 0u);
+
+  s.clear();
+  BOOST_TEST(s.empty());
+  BOOST_TEST(!s.contains(0));
+  BOOST_TEST(!s.contains(1'000'000));
+
+  // stale entries from before the clear don't resurrect anything
+  //
+  BOOST_TEST(s.insert(5));
+  BOOST_TEST(!s.contains(0));
+  BOOST_TEST(s.insert(0));
+  BOOST_TEST_EQ(s.size(), 2u);
+
+  s.reset();
+  BOOST_TEST(s.empty());
+  BOOST_TEST(!s.contains(5));
+  BOOST_TEST(s.insert(5));
+}
+
+static void against_std()
+{
+  auto rng = std::mt19937(1234);
+
+  auto s   = less::sparse_set<std::uint16_t>();
+  auto ref = std::set<std::uint16_t>();
+  for (auto i = 0; i < 100'000; ++i) {
+    auto const id = static_cast<std::uint16_t>(rng() % 3000u);
+    switch (rng() % 4u) {
+      case 0:
+        BOOST_TEST_ASSERT_EQ(s.erase(id), ref.erase(id) == 1);
+        break;
+
+      case 1:
+        BOOST_TEST_ASSERT_EQ(s.contains(id), ref.count(id) == 1);
+        break;
+
+      default:
+        BOOST_TEST_ASSERT_EQ(s.insert(id), ref.insert(id).second);
+    }
+
+    if (i % 25'000 == 24'999) {
+      s.clear();
+      ref.clear();
+    }
+  }
+
+  auto members = less::vector<std::uint16_t>(s.begin(), s.end());
+  std::sort(members.begin(), members.end());
+  BOOST_TEST_EQ(members.size(), ref.size());
+  BOOST_TEST(std::equal(members.begin(), members.end(), ref.begin()));
+}
+
+int main()
+{
+  basics();
+  against_std();
+
+  return boost::report_errors();
+}
@@ -0,0 +1,175 @@
+#include "lwt_helper.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <less/string_vector.hpp>
+
+static void basics()
+{
+  auto v = less::string_vector();
+  BOOST_TEST(v.empty());
+  BOOST_TEST(v.begin() == v.end());
+
+  v.push_back("hello");
+  v.push_back("");
+  v.push_back(std::string("a string long enough to not fit inline"));
+  BOOST_TEST_EQ(v.size(), 3u);
+  BOOST_TEST_EQ(v.char_count(), 43u);
+  BOOST_TEST_EQ(v[0], "hello");
+  BOOST_TEST(v[1].empty());
+  BOOST_TEST_EQ(v.back(), "a string long enough to not fit inline");
+  BOOST_TEST_THROWS(v.at(3), less::out_of_range);
+
+  // a view into the arena itself, appended while the arena may move
+  //
+  for (auto i = 0; i < 20; ++i) {
+    v.push_back(v[0].substr(1, 3));
+  }
+  BOOST_TEST_EQ(v.back(), "ell");
+
+  auto joined = std::string();
+  for (auto s : v) {
+    joined += s;
+  }
+  BOOST_TEST_EQ(joined.size(), v.char_count());
+  BOOST_TEST_EQ(v.end() - v.begin(), 23);
+  BOOST_TEST_EQ(v.begin()[2], v[2]);
+
+  // standard algorithms relying on the random access tag
+  //
+  BOOST_TEST(v.end() > v.begin());
+  BOOST_TEST(v.begin() <= v.begin());
+  BOOST_TEST(v.end() >= v.begin());
+  BOOST_TEST((2 + v.begin()) == std::next(v.begin(), 2));
+  BOOST_TEST_EQ(std::distance(v.begin(), v.end()), 23);
+  BOOST_TEST_EQ(std::count(v.begin(), v.end(), "ell"), 20);
+  BOOST_TEST(std::is_sorted(v.begin() + 3, v.end()));
+  BOOST_TEST_EQ(*std::lower_bound(v.begin() + 3, v.end(), "ell"), "ell");
+
+  v.pop_back();
+  BOOST_TEST_EQ(v.size(), 22u);
+  BOOST_TEST_EQ(v.char_count(), 43u + 19u * 3u);
+
+  v.clear();
+  BOOST_TEST(v.empty());
+  BOOST_TEST_EQ(v.char_count(), 0u);
+}
+
+static void interning()
+{
+  auto v = less::string_vector{"b", "a", "b"};
+  BOOST_TEST_EQ(v.find("b"), 0u);
+  BOOST_TEST_EQ(v.find("c"), less::string_vector::npos);
+
+  BOOST_TEST_EQ(v.intern("a"), 1u);
+  BOOST_TEST_EQ(v.intern("c"), 3u);
+  BOOST_TEST_EQ(v.intern("c"), 3u);
+  BOOST_TEST_EQ(v.size(), 4u);
+
+  // the index follows plain appends and grows with them
+  //
+  auto rng = std::mt19937(1234);
+  auto ids = less::vector<less::unsigned_long_type>();
+  for (auto i = 0; i < 20'000; ++i) {
+    auto const s = "key-" + std::to_string(rng() % 5000u);
+    if (i % 2 == 0) {
+      ids.push_back(v.intern(s));
+      BOOST_TEST_ASSERT_EQ(v[ids.back()], s);
+    }
+    else {
+      v.push_back(s);
+    }
+  }
+
+  // after a sort the index is rebuilt on demand
+  //
+  v.sort();
+  auto const i = v.find("key-42");
+  BOOST_TEST_NE(i, less::string_vector::npos);
+  BOOST_TEST_EQ(v[i], "key-42");
+  BOOST_TEST(i == 0 || v[i - 1] != "key-42");
+}
+
+static void sort_unique()
+{
+  auto rng  = std::mt19937(1234);
+  auto v    = less::string_vector();
+  auto refs = less::vector<std::string>();
+  for (auto i = 0; i < 5000; ++i) {
+    auto s = std::string(rng() % 12u, 'a');
+    for (auto& c : s) {
+      c = static_cast<char>('a' + rng() % 3u);
+    }
+    v.push_back(s);
+    refs.push_back(s);
+  }
+
+  v.sort();
+  std::sort(refs.begin(), refs.end());
+  BOOST_TEST(std::equal(v.begin(), v.end(), refs.begin(), refs.end()));
+
+  auto const removed = v.unique();
+  refs.erase(std::unique(refs.begin(), refs.end()), refs.end());
+  BOOST_TEST_EQ(removed, 5000u - refs.size());
+  BOOST_TEST(std::equal(v.begin(), v.end(), refs.begin(), refs.end()));
+
+  auto chars = 0u;
+  for (auto const& s : refs) {
+    chars += static_cast<unsigned>(s.size());
+  }
+  BOOST_TEST_EQ(v.char_count(), chars);
+
+  v.sort(std::greater<>());
+  BOOST_TEST(std::is_sorted(v.begin(), v.end(), std::greater<>()));
+
+  auto w = less::string_vector{"x", "x", "y", "x"};
+  BOOST_TEST_EQ(w.unique(), 1u);
+  BOOST_TEST(w == (less::string_vector{"x", "y", "x"}));
+}
+
+static void growth()
+{
+  // the arena grows geometrically, including when appending views into it
+  //
+  auto v           = less::string_vector();
+  auto reallocs    = 0;
+  auto capacity    = v.chars().capacity();
+  auto doubles     = true;
+  auto const check = [&] {
+    auto const c = v.chars().capacity();
+    if (c != capacity) {
+      ++reallocs;
+      doubles  = doubles && (capacity == 0 || c >= 2 * capacity);
+      capacity = c;
+    }
+  };
+
+  for (auto i = 0; i < 20'000; ++i) {
+    v.push_back("abcdefgh");
+    check();
+    if (i % 3 == 0) {
+      v.push_back(v[v.size() / 2]);
+      check();
+    }
+  }
+
+  BOOST_TEST(doubles);
+  BOOST_TEST_LE(reallocs, 20);
+  BOOST_TEST_EQ(v.char_count(), 8u * (20'000u + 6'667u));
+  BOOST_TEST_EQ(v.back(), "abcdefgh");
+}
+
+int main()
+{
+  basics();
+  interning();
+  sort_unique();
+  growth();
+
+  return boost::report_errors();
+}